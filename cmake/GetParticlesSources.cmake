@@ -1,9 +1,25 @@
 function(Particles_get_modules Particles_root_dir module_files)
     set(Particles_modules
+        ${Particles_root_dir}include/particles/attractor_octree.cppm
+        ${Particles_root_dir}include/particles/colliders.cppm
+        ${Particles_root_dir}include/particles/depth_sorter.cppm
+        ${Particles_root_dir}include/particles/distance_field.cppm
         ${Particles_root_dir}include/particles/effect.cppm
+        ${Particles_root_dir}include/particles/effect_trace.cppm
+        ${Particles_root_dir}include/particles/fingerprint.cppm
+        ${Particles_root_dir}include/particles/frame_recorder.cppm
+        ${Particles_root_dir}include/particles/frustum.cppm
+        ${Particles_root_dir}include/particles/parallel.cppm
+        ${Particles_root_dir}include/particles/particle_culler.cppm
         ${Particles_root_dir}include/particles/particle_generators.cppm
         ${Particles_root_dir}include/particles/particle_updaters.cppm
         ${Particles_root_dir}include/particles/particles.cppm
+        ${Particles_root_dir}include/particles/radix_sort.cppm
+        ${Particles_root_dir}include/particles/random.cppm
+        ${Particles_root_dir}include/particles/snapshot.cppm
+        ${Particles_root_dir}include/particles/spatial_grid.cppm
+        ${Particles_root_dir}include/particles/vector_grid.cppm
+        ${Particles_root_dir}include/particles/vertex_formats.cppm
     )
 
     SET(${module_files} ${Particles_modules} PARENT_SCOPE)
@@ -11,9 +27,24 @@ endfunction()
 
 function(Particles_get_source_files Particles_root_dir source_files)
     set(Particles_source_files
+        ${Particles_root_dir}src/particles/attractor_octree.cpp
+        ${Particles_root_dir}src/particles/colliders.cpp
+        ${Particles_root_dir}src/particles/depth_sorter.cpp
+        ${Particles_root_dir}src/particles/distance_field.cpp
+        ${Particles_root_dir}src/particles/effect_trace.cpp
+        ${Particles_root_dir}src/particles/fingerprint.cpp
+        ${Particles_root_dir}src/particles/frame_recorder.cpp
+        ${Particles_root_dir}src/particles/frustum.cpp
+        ${Particles_root_dir}src/particles/parallel.cpp
+        ${Particles_root_dir}src/particles/particle_culler.cpp
         ${Particles_root_dir}src/particles/particle_generators.cpp
         ${Particles_root_dir}src/particles/particle_updaters.cpp
         ${Particles_root_dir}src/particles/particles.cpp
+        ${Particles_root_dir}src/particles/radix_sort.cpp
+        ${Particles_root_dir}src/particles/snapshot.cpp
+        ${Particles_root_dir}src/particles/spatial_grid.cpp
+        ${Particles_root_dir}src/particles/vector_grid.cpp
+        ${Particles_root_dir}src/particles/vertex_formats.cpp
     )
 
     SET(${source_files} ${Particles_source_files} PARENT_SCOPE)
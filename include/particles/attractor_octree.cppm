@@ -0,0 +1,66 @@
+module;
+
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+export module Particles.AttractorOctree;
+
+export namespace PARTICLES
+{
+
+// Barnes-Hut approximation of the summed pull of many attractors. The attractors are put in
+// an octree and each node keeps the centre of its attractors, weighted by strength, and their
+// summed strength. A node that looks small from a particle, its size over its distance below
+// the opening angle, is treated as one attractor at that centre. Each '.w' is a strength.
+class AttractorOctree
+{
+public:
+  auto Build(std::span<const glm::vec4> attractors) noexcept -> void;
+
+  [[nodiscard]] auto GetNumNodes() const noexcept -> size_t;
+
+  // Zero opening angle gives the exact sum, larger angles are faster and less accurate.
+  [[nodiscard]] auto GetAcceleration(const glm::vec4& position, float openingAngle) const noexcept
+      -> glm::vec4;
+
+  // The exact O(M) sum, for checking the approximation.
+  [[nodiscard]] static auto GetExactAcceleration(const glm::vec4& position,
+                                                 std::span<const glm::vec4> attractors) noexcept
+      -> glm::vec4;
+
+private:
+  struct Node
+  {
+    glm::vec4 centre; // '.w' is the summed strength of the node's attractors
+    float size;
+    uint32_t firstChild;
+    uint32_t numChildren;
+    uint32_t firstAttractor;
+    uint32_t numAttractors;
+  };
+  std::vector<Node> m_nodes;
+  std::vector<glm::vec4> m_attractors; // ordered so each node's attractors are contiguous
+
+  static constexpr auto MAX_LEAF_SIZE = 8U;
+  static constexpr auto MAX_DEPTH     = 16U;
+  auto BuildNode(uint32_t nodeIndex,
+                 uint32_t firstAttractor,
+                 uint32_t numAttractors,
+                 const glm::vec4& boxCentre,
+                 float halfSize,
+                 uint32_t depth) noexcept -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto AttractorOctree::GetNumNodes() const noexcept -> size_t
+{
+  return m_nodes.size();
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,276 @@
+module;
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+export module Particles.Colliders;
+
+export namespace PARTICLES
+{
+
+// Solid below the plane through 'point', 'normal' pointing out of the solid.
+struct PlaneCollider
+{
+  glm::vec4 point;
+  glm::vec4 normal;
+};
+
+struct SphereCollider
+{
+  glm::vec4 centre;
+  float radius;
+};
+
+// The columns of 'orientation' are the box's axes.
+struct BoxCollider
+{
+  glm::vec4 centre;
+  glm::vec4 halfExtents;
+  glm::mat3 orientation{1.0F};
+};
+
+// The points within 'radius' of the segment from 'start' to 'end'.
+struct CapsuleCollider
+{
+  glm::vec4 start;
+  glm::vec4 end;
+  float radius;
+};
+
+// A set of solid shapes. Each shape is transformed, when added, into what its signed distance
+// needs, and kept in a flat array per component, so the distance to a shape is a few lines of
+// arithmetic without branches. The bounded shapes - spheres, boxes and capsules - are also put
+// in a coarse grid of cells, each listing the shapes that overlap it, so a position is only
+// checked against the planes and the few shapes in its cell.
+class ColliderSet
+{
+public:
+  auto AddPlane(const PlaneCollider& plane) noexcept -> void;
+  auto AddSphere(const SphereCollider& sphere) noexcept -> void;
+  auto AddBox(const BoxCollider& box) noexcept -> void;
+  auto AddCapsule(const CapsuleCollider& capsule) noexcept -> void;
+  auto Clear() noexcept -> void;
+
+  [[nodiscard]] auto GetNumColliders() const noexcept -> size_t;
+
+  // Appends the indices of the positions inside any shape to 'insideIds', counting from
+  // 'firstId'. Done for many positions at once so the loop is all in one place.
+  auto FindInside(std::span<const glm::vec4> positions,
+                  size_t firstId,
+                  std::vector<size_t>& insideIds) const noexcept -> void;
+
+  struct Contact
+  {
+    float distance; // negative, how deep the position is
+    glm::vec4 normal;
+  };
+  // The shape a position is deepest inside. Only for positions that are inside.
+  [[nodiscard]] auto GetContact(const glm::vec4& position) const noexcept -> Contact;
+
+private:
+  struct Planes
+  {
+    std::vector<float> normalX;
+    std::vector<float> normalY;
+    std::vector<float> normalZ;
+    std::vector<float> offset;
+  };
+  struct Spheres
+  {
+    std::vector<float> centreX;
+    std::vector<float> centreY;
+    std::vector<float> centreZ;
+    std::vector<float> radius;
+  };
+  struct Boxes
+  {
+    std::vector<float> centreX;
+    std::vector<float> centreY;
+    std::vector<float> centreZ;
+    std::vector<float> halfExtentX;
+    std::vector<float> halfExtentY;
+    std::vector<float> halfExtentZ;
+    // Rows of the world to box rotation, so the box's axes.
+    std::vector<float> axisXx;
+    std::vector<float> axisXy;
+    std::vector<float> axisXz;
+    std::vector<float> axisYx;
+    std::vector<float> axisYy;
+    std::vector<float> axisYz;
+    std::vector<float> axisZx;
+    std::vector<float> axisZy;
+    std::vector<float> axisZz;
+  };
+  struct Capsules
+  {
+    std::vector<float> startX;
+    std::vector<float> startY;
+    std::vector<float> startZ;
+    std::vector<float> axisX; // end - start
+    std::vector<float> axisY;
+    std::vector<float> axisZ;
+    std::vector<float> invAxisLengthSq;
+    std::vector<float> radius;
+  };
+  Planes m_planes;
+  Spheres m_spheres;
+  Boxes m_boxes;
+  Capsules m_capsules;
+
+  struct Bounds
+  {
+    glm::vec4 min;
+    glm::vec4 max;
+  };
+  std::vector<Bounds> m_sphereBounds;
+  std::vector<Bounds> m_boxBounds;
+  std::vector<Bounds> m_capsuleBounds;
+
+  // The broad phase, rebuilt whenever a bounded shape is added. Each cell has a list of
+  // spheres, then boxes, then capsules, in 'm_cellShapes' from 'm_cellStarts[3 * cell]'.
+  enum ShapeList : uint8_t
+  {
+    SPHERES,
+    BOXES,
+    CAPSULES,
+    NUM_SHAPE_LISTS,
+  };
+  static constexpr auto MAX_GRID_RESOLUTION = 32U;
+  static constexpr auto NO_CELL             = ~0U;
+  Bounds m_gridBounds{};
+  glm::vec4 m_cellsPerUnit{0.0F};
+  uint32_t m_gridResolution = 0U;
+  std::vector<uint32_t> m_cellStarts;
+  std::vector<uint32_t> m_cellShapes;
+  auto BuildGrid() noexcept -> void;
+  [[nodiscard]] auto GetCell(const glm::vec4& position) const noexcept -> uint32_t;
+  [[nodiscard]] auto GetCellShapes(uint32_t cell, ShapeList shapeList) const noexcept
+      -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto GetPlaneDistance(size_t i, float x, float y, float z) const noexcept
+      -> float;
+  [[nodiscard]] auto GetSphereDistance(size_t i, float x, float y, float z) const noexcept
+      -> float;
+  [[nodiscard]] auto GetBoxDistance(size_t i, float x, float y, float z) const noexcept -> float;
+  [[nodiscard]] auto GetCapsuleDistance(size_t i, float x, float y, float z) const noexcept
+      -> float;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto ColliderSet::GetNumColliders() const noexcept -> size_t
+{
+  return m_planes.offset.size() + m_spheres.radius.size() + m_boxes.centreX.size() +
+         m_capsules.radius.size();
+}
+
+inline auto ColliderSet::GetPlaneDistance(const size_t i,
+                                          const float x,
+                                          const float y,
+                                          const float z) const noexcept -> float
+{
+  return (x * m_planes.normalX[i]) + (y * m_planes.normalY[i]) + (z * m_planes.normalZ[i]) -
+         m_planes.offset[i];
+}
+
+inline auto ColliderSet::GetSphereDistance(const size_t i,
+                                           const float x,
+                                           const float y,
+                                           const float z) const noexcept -> float
+{
+  const auto dx = x - m_spheres.centreX[i];
+  const auto dy = y - m_spheres.centreY[i];
+  const auto dz = z - m_spheres.centreZ[i];
+
+  return std::sqrt((dx * dx) + (dy * dy) + (dz * dz)) - m_spheres.radius[i];
+}
+
+inline auto ColliderSet::GetBoxDistance(const size_t i,
+                                        const float x,
+                                        const float y,
+                                        const float z) const noexcept -> float
+{
+  const auto dx = x - m_boxes.centreX[i];
+  const auto dy = y - m_boxes.centreY[i];
+  const auto dz = z - m_boxes.centreZ[i];
+
+  // How far outside each pair of faces the point is, in the box's frame.
+  const auto qx = std::abs((dx * m_boxes.axisXx[i]) + (dy * m_boxes.axisXy[i]) +
+                           (dz * m_boxes.axisXz[i])) -
+                  m_boxes.halfExtentX[i];
+  const auto qy = std::abs((dx * m_boxes.axisYx[i]) + (dy * m_boxes.axisYy[i]) +
+                           (dz * m_boxes.axisYz[i])) -
+                  m_boxes.halfExtentY[i];
+  const auto qz = std::abs((dx * m_boxes.axisZx[i]) + (dy * m_boxes.axisZy[i]) +
+                           (dz * m_boxes.axisZz[i])) -
+                  m_boxes.halfExtentZ[i];
+
+  const auto ox = std::max(qx, 0.0F);
+  const auto oy = std::max(qy, 0.0F);
+  const auto oz = std::max(qz, 0.0F);
+
+  return std::sqrt((ox * ox) + (oy * oy) + (oz * oz)) +
+         std::min(std::max(qx, std::max(qy, qz)), 0.0F);
+}
+
+inline auto ColliderSet::GetCapsuleDistance(const size_t i,
+                                            const float x,
+                                            const float y,
+                                            const float z) const noexcept -> float
+{
+  const auto dx = x - m_capsules.startX[i];
+  const auto dy = y - m_capsules.startY[i];
+  const auto dz = z - m_capsules.startZ[i];
+
+  const auto t = std::clamp(((dx * m_capsules.axisX[i]) + (dy * m_capsules.axisY[i]) +
+                             (dz * m_capsules.axisZ[i])) *
+                                m_capsules.invAxisLengthSq[i],
+                            0.0F,
+                            1.0F);
+
+  const auto ex = dx - (t * m_capsules.axisX[i]);
+  const auto ey = dy - (t * m_capsules.axisY[i]);
+  const auto ez = dz - (t * m_capsules.axisZ[i]);
+
+  return std::sqrt((ex * ex) + (ey * ey) + (ez * ez)) - m_capsules.radius[i];
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+inline auto ColliderSet::GetCell(const glm::vec4& position) const noexcept -> uint32_t
+{
+  const auto gridPosition = (position - m_gridBounds.min) * m_cellsPerUnit;
+  const auto resolution   = static_cast<float>(m_gridResolution);
+  if ((not(gridPosition.x >= 0.0F)) or (gridPosition.x >= resolution) or
+      (not(gridPosition.y >= 0.0F)) or (gridPosition.y >= resolution) or
+      (not(gridPosition.z >= 0.0F)) or (gridPosition.z >= resolution))
+  {
+    return NO_CELL;
+  }
+
+  return static_cast<uint32_t>(gridPosition.x) +
+         (m_gridResolution * (static_cast<uint32_t>(gridPosition.y) +
+                              (m_gridResolution * static_cast<uint32_t>(gridPosition.z))));
+}
+
+inline auto ColliderSet::GetCellShapes(const uint32_t cell,
+                                       const ShapeList shapeList) const noexcept
+    -> std::span<const uint32_t>
+{
+  const auto list = (NUM_SHAPE_LISTS * static_cast<size_t>(cell)) + shapeList;
+  return std::span{m_cellShapes}.subspan(m_cellStarts[list],
+                                         m_cellStarts[list + 1] - m_cellStarts[list]);
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
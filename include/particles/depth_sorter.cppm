@@ -0,0 +1,152 @@
+module;
+
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+export module Particles.DepthSorter;
+
+import Particles.Parallel;
+import Particles.Particles;
+import Particles.RadixSort;
+
+export namespace PARTICLES
+{
+
+enum class DepthSortMode : uint8_t
+{
+  FULL,     // radix sort from scratch every frame
+  ADAPTIVE, // start from the last frame's order and only sort what has moved out of place
+};
+
+// Orders the alive particles back to front along the view direction, for alpha blending. The
+// result is a list of particle indices, which can be used directly as an index buffer over the
+// vertices from 'ParticleSystem::WriteVertices', or given to it to write the vertices in order.
+// Sorting just the visible particles from a 'ParticleCuller' leaves the rest out.
+//
+// In adaptive mode, last frame's order is the starting point. Particles a few places out are
+// insertion sorted. Those far out of place, because they were emitted or swapped into a killed
+// particle's place, are taken out, sorted on their own and merged back in. That is linear
+// while the order changes little from frame to frame, and a full sort is used when a sample of
+// last frame's order, or the sort itself, shows too much has changed. In a dense cloud of moving
+// particles that is most frames, as they overtake each other by many places. With a thread pool
+// each thread insertion sorts its own share of the order, and the shares and the particles taken
+// out are then merged on the calling thread.
+class DepthSorter
+{
+public:
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+  auto SetMode(DepthSortMode mode) noexcept -> void;
+
+  auto Sort(const ParticleData& particleData,
+            const glm::vec4& viewPosition,
+            const glm::vec4& viewDirection) noexcept -> std::span<const uint32_t>;
+  // Sorts just the alive particles in 'ids'.
+  auto Sort(const ParticleData& particleData,
+            std::span<const uint32_t> ids,
+            const glm::vec4& viewPosition,
+            const glm::vec4& viewDirection) noexcept -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto GetOrder() const noexcept -> std::span<const uint32_t>;
+  // How many particles the last adaptive sort took out and merged back, or all of them if it
+  // sorted from scratch.
+  [[nodiscard]] auto GetNumSortedLast() const noexcept -> size_t;
+
+private:
+  // How far a particle can be from its place in last frame's order and still be insertion
+  // sorted, rather than taken out and merged back.
+  static constexpr auto MAX_SHIFT = 32U;
+  // Beyond a mean of this many places moved by insertion, or one in this many particles taken
+  // out, sorting from scratch is quicker.
+  static constexpr auto MAX_MEAN_SHIFT           = 8U;
+  static constexpr auto MAX_OUT_OF_PLACE_DIVISOR = 8U;
+  // Neighbours in last frame's order checked to tell whether it is worth starting from.
+  static constexpr auto NUM_SAMPLED_PAIRS = 1024U;
+  // Below this making the keys is quicker on one thread than shared out.
+  static constexpr auto MIN_PARALLEL_SIZE = 16384U;
+
+  DepthSortMode m_mode = DepthSortMode::ADAPTIVE;
+  std::shared_ptr<Parallel> m_parallel;
+  RadixSort m_radixSort;
+  std::vector<uint32_t> m_order;
+  bool m_isOrderOfAllAlive = true; // rather than of a list of particles
+  std::vector<uint32_t> m_keys;    // per particle sorting them all from scratch, else per place
+  std::vector<uint8_t> m_isListed; // per particle, while carrying last frame's order over
+  size_t m_numSortedLast = 0U;
+
+  struct KeyedIndex
+  {
+    uint32_t key;
+    uint32_t index;
+  };
+  std::vector<KeyedIndex> m_inPlace;
+  std::vector<KeyedIndex> m_outOfPlace;
+  // A thread's share of last frame's order in the adaptive sort.
+  struct AdaptiveChunk
+  {
+    std::vector<KeyedIndex> inPlace;
+    std::vector<KeyedIndex> outOfPlace;
+    bool isNearlySorted = true;
+  };
+  std::vector<AdaptiveChunk> m_chunks;
+
+  // 'ids' are the particles to sort, or all the alive ones if there are none.
+  using OptionalIds = std::optional<std::span<const uint32_t>>;
+
+  auto SortIds(const ParticleData& particleData,
+               const OptionalIds& ids,
+               const glm::vec4& viewPosition,
+               const glm::vec4& viewDirection) noexcept -> void;
+  auto SortFull(const ParticleData& particleData,
+                const OptionalIds& ids,
+                const glm::vec4& viewPosition,
+                const glm::vec4& viewDirection) noexcept -> void;
+  [[nodiscard]] auto SortAdaptive(const ParticleData& particleData,
+                                  const OptionalIds& ids,
+                                  const glm::vec4& viewPosition,
+                                  const glm::vec4& viewDirection) noexcept -> bool;
+  // Insertion sorts the places [begin, end) of last frame's order, and takes out the particles
+  // too far out of place. False if there are too many of either to be worth it.
+  [[nodiscard]] auto SortChunk(size_t begin, size_t end, AdaptiveChunk& chunk) const noexcept
+      -> bool;
+  auto CarryOverOrder(size_t numAlive, const OptionalIds& ids) noexcept -> void;
+  [[nodiscard]] auto IsNearlySorted(const ParticleData& particleData,
+                                    const glm::vec4& viewPosition,
+                                    const glm::vec4& viewDirection) const noexcept -> bool;
+  // Fills 'm_keys' with the keys of the particles 'ids[i]', or of every alive particle.
+  auto MakeKeys(const ParticleData& particleData,
+                const OptionalIds& ids,
+                const glm::vec4& viewPosition,
+                const glm::vec4& viewDirection) noexcept -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto DepthSorter::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  m_parallel = parallel;
+  m_radixSort.SetParallel(parallel);
+}
+
+inline auto DepthSorter::SetMode(const DepthSortMode mode) noexcept -> void
+{
+  m_mode = mode;
+}
+
+inline auto DepthSorter::GetOrder() const noexcept -> std::span<const uint32_t>
+{
+  return m_order;
+}
+
+inline auto DepthSorter::GetNumSortedLast() const noexcept -> size_t
+{
+  return m_numSortedLast;
+}
+
+} // namespace PARTICLES
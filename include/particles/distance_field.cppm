@@ -0,0 +1,42 @@
+module;
+
+#include <cstdint>
+#include <functional>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <string>
+
+export module Particles.DistanceField;
+
+import Particles.Parallel;
+import Particles.VectorGrid;
+
+export namespace PARTICLES
+{
+
+// Signed distance to the surface of a solid, negative inside. For shapes, like logos or text,
+// that the analytic colliders can't describe.
+using DistanceFunction = std::function<float(const glm::vec4& position)>;
+
+struct DistanceFieldSettings
+{
+  glm::vec4 boundsMin{-1.0F};
+  glm::vec4 boundsMax{+1.0F};
+  uint32_t resolution = 64U; // grid points along each axis, at least 2
+  // Where a bake is saved, and loaded from on later runs. Empty means always bake.
+  std::string cacheFilename;
+  // Saved with a bake, see 'VectorGrid::SetVersion'. Change it when the shape changes, so that
+  // the bake cached for the old one isn't used.
+  uint64_t shapeVersion = 0U;
+};
+
+// The distance function baked into a grid. Each value's '.w' is the distance and '.xyz' the
+// direction of increasing distance, out of the solid. The points are shared out between the
+// threads of 'parallel', if given, so 'distance' must be safe to call from several threads at
+// once. A cache file that can't be read, or has a different grid or shape version, is baked
+// again and overwritten. Throws 'std::invalid_argument' if the resolution is below 2.
+[[nodiscard]] auto MakeDistanceField(const DistanceFieldSettings& settings,
+                                     const DistanceFunction& distance,
+                                     const std::shared_ptr<Parallel>& parallel) -> VectorGrid;
+
+} // namespace PARTICLES
@@ -1,11 +1,19 @@
 module;
 
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <glm/vec4.hpp>
+#include <memory>
+#include <string_view>
 
 export module Particles.Effect;
 
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.ParticleUpdaters;
 import Particles.Particles;
+import Particles.Snapshot;
 
 export namespace PARTICLES::EFFECTS
 {
@@ -26,13 +34,46 @@ public:
   virtual auto SetTintMixAmount(float mixAmount) noexcept -> void        = 0;
   // Higher mix amount for more tint.
   virtual auto SetMaxNumAliveParticles(size_t maxNumAliveParticles) noexcept -> void = 0;
+  // Trade color accuracy for speed by not recoloring every particle every frame.
+  virtual auto SetColorUpdateSchedule(const UPDATERS::StaggerSchedule& schedule) noexcept
+      -> void = 0;
 
   virtual auto Update(double dt) noexcept -> void = 0;
+  // Culls the whole effect when it is out of view, see 'ParticleSystem::UpdateVisibility'.
+  virtual auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool = 0;
 
   [[nodiscard]] virtual auto GetSystem() const noexcept -> const PARTICLES::ParticleSystem& = 0;
 
   [[nodiscard]] auto GetNumAllParticles() const noexcept -> size_t;
   [[nodiscard]] auto GetNumAliveParticles() const noexcept -> size_t;
+
+  // See 'ParticleSystem::SetRandomSeed' and 'ParticleSystem::SetParallel'. Virtual so that an
+  // effect wrapping another can see them.
+  virtual auto SetRandomSeed(uint64_t seed) noexcept -> void;
+  virtual auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+
+  // Starts the effect over, as it is after running for 'warmUpTime' in steps of 'dt'. The state
+  // is restored from 'cache' if it has it for 'name', else made by running the effect and
+  // stored for next time. Returns whether it was restored.
+  auto Prewarm(const SnapshotCache& cache, std::string_view name, double warmUpTime, double dt)
+      -> bool;
+
+protected:
+  [[nodiscard]] virtual auto GetMutableSystem() noexcept -> PARTICLES::ParticleSystem& = 0;
+  // For effects that move their emitters on a clock of their own, to put it in step with a
+  // restored system.
+  virtual auto SetEffectTime(double time) noexcept -> void = 0;
+
+  // For effects that wrap another, which can't call the above on it directly.
+  [[nodiscard]] static auto GetMutableSystemOf(IEffect& effect) noexcept
+      -> PARTICLES::ParticleSystem&;
+  static auto SetEffectTimeOf(IEffect& effect, double time) noexcept -> void;
+
+  // For 'SetColorUpdateSchedule': swaps 'scheduledUpdater', which runs 'updater' in the system,
+  // for one that runs it on 'schedule'.
+  auto ScheduleUpdater(const std::shared_ptr<IParticleUpdater>& updater,
+                       const UPDATERS::StaggerSchedule& schedule,
+                       std::shared_ptr<IParticleUpdater>& scheduledUpdater) noexcept -> void;
 };
 
 } // namespace PARTICLES::EFFECTS
@@ -50,4 +91,65 @@ inline auto IEffect::GetNumAliveParticles() const noexcept -> size_t
   return GetSystem().GetNumAliveParticles();
 }
 
+inline auto IEffect::SetRandomSeed(const uint64_t seed) noexcept -> void
+{
+  GetMutableSystem().SetRandomSeed(seed);
+}
+
+inline auto IEffect::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  GetMutableSystem().SetParallel(parallel);
+}
+
+inline auto IEffect::GetMutableSystemOf(IEffect& effect) noexcept -> PARTICLES::ParticleSystem&
+{
+  return effect.GetMutableSystem();
+}
+
+inline auto IEffect::SetEffectTimeOf(IEffect& effect, const double time) noexcept -> void
+{
+  effect.SetEffectTime(time);
+}
+
+inline auto IEffect::ScheduleUpdater(const std::shared_ptr<IParticleUpdater>& updater,
+                                     const UPDATERS::StaggerSchedule& schedule,
+                                     std::shared_ptr<IParticleUpdater>& scheduledUpdater) noexcept
+    -> void
+{
+  auto newUpdater = updater;
+  if (schedule.period > 1U)
+  {
+    newUpdater = std::make_shared<UPDATERS::StaggeredUpdater>(updater, schedule);
+  }
+
+  GetMutableSystem().ReplaceUpdater(scheduledUpdater, newUpdater);
+  scheduledUpdater = newUpdater;
+}
+
+inline auto IEffect::Prewarm(const SnapshotCache& cache,
+                             const std::string_view name,
+                             const double warmUpTime,
+                             const double dt) -> bool
+{
+  // A snapshot from a different warm up time is stale, and made again.
+  auto& system = GetMutableSystem();
+  if (cache.Restore(system, name) and (std::abs(system.GetSimulationTime() - warmUpTime) < dt))
+  {
+    SetEffectTime(system.GetSimulationTime());
+    return true;
+  }
+
+  // Restoring no particles at time zero starts the system over.
+  system.Restore(ParticleData::Streams{}, 0U, 0.0);
+  SetEffectTime(0.0);
+  const auto numSteps = static_cast<uint64_t>(std::ceil(warmUpTime / dt));
+  for (auto step = uint64_t{0U}; step < numSteps; ++step)
+  {
+    Update(dt);
+  }
+  cache.Store(system, name);
+
+  return false;
+}
+
 } // namespace PARTICLES::EFFECTS
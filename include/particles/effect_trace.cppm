@@ -0,0 +1,165 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+export module Particles.EffectTrace;
+
+import Particles.Effect;
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.ParticleUpdaters;
+import Particles.Particles;
+
+namespace PARTICLES::EFFECTS
+{
+
+// Says which call a trace record is.
+enum class TracedCall : uint8_t;
+
+} // namespace PARTICLES::EFFECTS
+
+export namespace PARTICLES::EFFECTS
+{
+
+// Effect traces keep every call made on an effect, in order, so that a run can be played again
+// call for call - to reproduce a slow frame under a profiler, say. The file is a header naming
+// the effect, its particle count and starting random seed, then a record per call: a byte
+// saying which call, then its arguments as they are in memory. 'Prewarm' is traced as the
+// updates it runs, so one restored from a snapshot can't be replayed.
+struct EffectTraceInfo
+{
+  std::string effectName; // for the replay to make the same effect
+  size_t numParticles;
+  uint64_t randomSeed;
+};
+
+// Passes every call on to the wrapped effect and appends it to the trace. The records go
+// through the file's buffer, so tracing costs a few bytes of copying per call.
+class TracedEffect : public IEffect
+{
+public:
+  // Seeds the effect. It should be new, made as 'info' says. Throws
+  // 'std::runtime_error' if the file can't be made.
+  TracedEffect(std::shared_ptr<IEffect> effect,
+               const EffectTraceInfo& info,
+               const std::filesystem::path& filename);
+  ~TracedEffect() noexcept override;
+
+  auto Reset() noexcept -> void override;
+
+  auto SetTintColor(const glm::vec4& tintColor) noexcept -> void override;
+  auto SetTintMixAmount(float mixAmount) noexcept -> void override;
+  auto SetMaxNumAliveParticles(size_t maxNumAliveParticles) noexcept -> void override;
+  auto SetColorUpdateSchedule(const UPDATERS::StaggerSchedule& schedule) noexcept
+      -> void override;
+  auto SetRandomSeed(uint64_t seed) noexcept -> void override;
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void override;
+
+  auto Update(double dt) noexcept -> void override;
+  auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool override;
+
+  [[nodiscard]] auto GetSystem() const noexcept -> const ParticleSystem& override;
+
+  // Writes out the rest of the trace. Later calls are passed on but not traced. Throws
+  // 'std::runtime_error' if anything could not be written.
+  auto Close() -> void;
+
+  [[nodiscard]] auto GetNumTracedCalls() const noexcept -> uint64_t;
+
+protected:
+  [[nodiscard]] auto GetMutableSystem() noexcept -> ParticleSystem& override;
+  auto SetEffectTime(double time) noexcept -> void override;
+
+private:
+  std::shared_ptr<IEffect> m_effect;
+  std::filesystem::path m_filename;
+  std::ofstream m_file;
+  uint64_t m_numTracedCalls = 0U;
+  bool m_closed             = false;
+
+  template<typename... Arguments>
+  auto Trace(TracedCall call, const Arguments&... arguments) noexcept -> void;
+};
+
+// Plays a trace back on an effect. The whole trace is read, and checked, up front, so playing
+// it does no I/O and can't fail.
+class EffectTracePlayer
+{
+public:
+  // Throws 'std::runtime_error' if the file can't be read or isn't a whole trace, and
+  // 'std::system_error' if a thread pool can't be made.
+  explicit EffectTracePlayer(const std::filesystem::path& filename);
+
+  [[nodiscard]] auto GetInfo() const noexcept -> const EffectTraceInfo&;
+  [[nodiscard]] auto GetNumCalls() const noexcept -> size_t;
+  [[nodiscard]] auto GetNumFrames() const noexcept -> size_t; // 'Update' calls
+
+  // Plays the calls up to and including the next 'Update', seeding the effect first when at
+  // the start. Returns false, having played the calls after the last 'Update', at the end.
+  auto PlayFrame(IEffect& effect) noexcept -> bool;
+  auto PlayAll(IEffect& effect) noexcept -> void;
+  // Back to the start, to play the trace on another new effect.
+  auto Rewind() noexcept -> void;
+
+private:
+  EffectTraceInfo m_info{};
+  std::vector<std::byte> m_calls;
+  size_t m_numCalls  = 0U;
+  size_t m_numFrames = 0U;
+  size_t m_position  = 0U; // in 'm_calls'
+  // One for each number of threads 'SetParallel' was traced with, made up front too.
+  std::vector<std::shared_ptr<Parallel>> m_pools;
+
+  // Plays the call at 'm_position' and moves past it. Returns whether it was 'Update'.
+  auto PlayCall(IEffect& effect) noexcept -> bool;
+  [[nodiscard]] auto FindPool(uint32_t numThreads) const noexcept -> std::shared_ptr<Parallel>;
+};
+
+} // namespace PARTICLES::EFFECTS
+
+namespace PARTICLES::EFFECTS
+{
+
+inline auto TracedEffect::GetSystem() const noexcept -> const ParticleSystem&
+{
+  return m_effect->GetSystem();
+}
+
+inline auto TracedEffect::GetNumTracedCalls() const noexcept -> uint64_t
+{
+  return m_numTracedCalls;
+}
+
+inline auto TracedEffect::GetMutableSystem() noexcept -> ParticleSystem&
+{
+  return GetMutableSystemOf(*m_effect);
+}
+
+inline auto EffectTracePlayer::GetInfo() const noexcept -> const EffectTraceInfo&
+{
+  return m_info;
+}
+
+inline auto EffectTracePlayer::GetNumCalls() const noexcept -> size_t
+{
+  return m_numCalls;
+}
+
+inline auto EffectTracePlayer::GetNumFrames() const noexcept -> size_t
+{
+  return m_numFrames;
+}
+
+inline auto EffectTracePlayer::Rewind() noexcept -> void
+{
+  m_position = 0U;
+}
+
+} // namespace PARTICLES::EFFECTS
@@ -0,0 +1,68 @@
+module;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <optional>
+
+export module Particles.Fingerprint;
+
+import Particles.Particles;
+
+export namespace PARTICLES
+{
+
+// For checking a faster or parallel version of part of the simulation against the one it
+// replaces: run both from the same seed, see 'ParticleSystem::SetRandomSeed', and compare them
+// frame by frame. Particles are matched by id, see 'ParticleData::GetIds', so versions that
+// keep the particles in a different order still compare equal.
+//
+// Runs are repeatable given the seed and the number of threads. Parallel loops split the
+// particles into the same chunks for the same number of threads, and anything summed over the
+// chunks is summed in chunk order.
+
+// A few numbers standing for a frame's particles, to keep for every frame of a long run.
+struct ParticleFingerprint
+{
+  size_t numAlive;
+  // Of every bit of every alive particle. Any change to a particle changes it, but not the
+  // order of the particles.
+  uint64_t checksum;
+  // Of each stream over the alive particles, to tell roughly how far apart two runs are.
+  std::array<glm::dvec4, ParticleData::NUM_STREAMS> means;
+};
+
+[[nodiscard]] auto TakeFingerprint(const ParticleData& particleData) noexcept
+    -> ParticleFingerprint;
+
+struct ParticleComparison
+{
+  size_t numCompared;      // particles alive in both
+  size_t numMissing;       // particles alive in only one
+  size_t numOutside;       // particles with a value further off than the tolerance
+  float maxDifference;     // relative to the reference value, where that is more than one
+  uint32_t maxDifferentId; // the particle that is furthest off
+  std::optional<uint32_t> firstOutsideId; // the lowest id, of the ones outside the tolerance
+
+  [[nodiscard]] auto IsWithinTolerance() const noexcept -> bool;
+};
+
+// Compares every value of every particle alive in both, matched by id. A value is within the
+// tolerance if it is no further than 'tolerance' from the reference value, or for values over
+// one, no further than 'tolerance' times it.
+[[nodiscard]] auto CompareParticles(const ParticleData& reference,
+                                    const ParticleData& other,
+                                    float tolerance) -> ParticleComparison;
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto ParticleComparison::IsWithinTolerance() const noexcept -> bool
+{
+  return (0U == numMissing) and (0U == numOutside);
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,176 @@
+module;
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec4.hpp>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+export module Particles.FrameRecorder;
+
+import Particles.Particles;
+import Particles.RadixSort;
+import Particles.VertexFormats;
+
+export namespace PARTICLES
+{
+
+// Frame recordings keep the alive particles of a run, frame by frame, for offline analysis and
+// for comparing runs. Each particle is its id, see 'ParticleData::GetIds', and a quantized
+// position and color, as in 'QuantizedPositionColorFormat'. A frame is stored as the change
+// from the last one, matching particles by id, except for key frames, which stand alone. The
+// changes are mostly small numbers, written in as few bytes as they need, and runs of zero
+// bytes are squeezed out. An index at the end of the file lets frames be read in any order.
+struct FrameRecorderSettings
+{
+  // Positions are quantized over these bounds, and clamped to them.
+  glm::vec4 boundsMin{-1.0F};
+  glm::vec4 boundsMax{+1.0F};
+  // Reading a frame decodes it from the key frame before it, at most this many frames.
+  uint32_t keyFrameInterval = 30U;
+  // Captured frames waiting to be written. When they are all waiting, new frames are dropped.
+  uint32_t numBufferedFrames = 4U;
+};
+
+// Writes frames on a thread of its own. Capturing only quantizes the particles into a free
+// buffer - the calling thread never waits on the file.
+class FrameRecorder
+{
+public:
+  // Throws 'std::runtime_error' if the file can't be made.
+  FrameRecorder(const std::filesystem::path& filename, const FrameRecorderSettings& settings);
+  FrameRecorder(const FrameRecorder&) = delete;
+  FrameRecorder(FrameRecorder&&)      = delete;
+  ~FrameRecorder() noexcept;
+  auto operator=(const FrameRecorder&) -> FrameRecorder& = delete;
+  auto operator=(FrameRecorder&&) -> FrameRecorder&      = delete;
+
+  // Returns false if the frame was dropped, as every buffer was still waiting to be written.
+  auto Capture(const ParticleData& particleData, double time) noexcept -> bool;
+  // Waits for the captured frames to be written and adds the index. Further captures are
+  // dropped. Throws 'std::runtime_error' if anything could not be written.
+  auto Close() -> void;
+
+  [[nodiscard]] auto GetNumWrittenFrames() const noexcept -> size_t; // once closed
+  [[nodiscard]] auto GetNumDroppedFrames() const noexcept -> size_t;
+  [[nodiscard]] auto GetNumWrittenBytes() const noexcept -> uint64_t; // once closed
+
+private:
+  struct CapturedFrame
+  {
+    double time;
+    size_t numParticles;
+    std::vector<uint32_t> ids;
+    std::vector<QuantizedPositionColorFormat::Vertex> vertices;
+  };
+
+  std::filesystem::path m_filename;
+  FrameRecorderSettings m_settings;
+  std::ofstream m_file;
+
+  // Buffer 'i % size' holds captured frame 'i'. The capturing thread fills the buffer after
+  // the last captured one, if it isn't waiting to be written, and the writer empties them in
+  // order.
+  std::vector<CapturedFrame> m_buffers;
+  std::mutex m_mutex;
+  std::condition_variable m_frameCaptured;
+  size_t m_numCaptured = 0U;
+  size_t m_numWritten  = 0U;
+  size_t m_numDropped  = 0U;
+  bool m_stopping      = false;
+  bool m_closed        = false;
+
+  // Only used by the writer thread until it is joined.
+  std::vector<uint64_t> m_frameOffsets;
+  uint64_t m_fileSize = 0U;
+  bool m_writeFailed  = false;
+  RadixSort m_radixSort;
+  std::vector<uint32_t> m_order;
+  std::vector<uint32_t> m_ids; // sorted
+  std::vector<QuantizedPositionColorFormat::Vertex> m_vertices;
+  std::vector<uint32_t> m_previousIds;
+  std::vector<QuantizedPositionColorFormat::Vertex> m_previousVertices;
+  std::vector<uint32_t> m_matches;
+  std::vector<uint8_t> m_encoded;
+  std::vector<uint8_t> m_compressed;
+
+  std::jthread m_writer; // last, so it starts after, and is joined before, the rest goes
+
+  auto WriterLoop() noexcept -> void;
+  auto WriteFrame(CapturedFrame& frame) noexcept -> void;
+};
+
+struct RecordedFrame
+{
+  double time;
+  std::vector<uint32_t> ids; // ascending
+  // Quantized over the recording's bounds, see 'FrameReader::GetSettings'.
+  std::vector<QuantizedPositionColorFormat::Vertex> vertices;
+};
+
+class FrameReader
+{
+public:
+  // Throws 'std::runtime_error' if the file can't be read or isn't a finished recording.
+  explicit FrameReader(const std::filesystem::path& filename);
+
+  [[nodiscard]] auto GetNumFrames() const noexcept -> size_t;
+  [[nodiscard]] auto GetSettings() const noexcept -> const FrameRecorderSettings&;
+
+  // Reading the frames in order decodes each once. Throws 'std::runtime_error' if the frame
+  // is past the end or can't be read. The frame is valid until the next read.
+  auto ReadFrame(size_t frame) -> const RecordedFrame&;
+
+private:
+  std::filesystem::path m_filename;
+  std::ifstream m_file;
+  FrameRecorderSettings m_settings{};
+  std::vector<uint64_t> m_frameOffsets;
+  uint64_t m_indexOffset = 0U;
+
+  std::optional<size_t> m_decodedFrame;
+  RecordedFrame m_frame{};
+  RecordedFrame m_previousFrame{};
+  std::vector<uint32_t> m_matches;
+  std::vector<uint8_t> m_compressed;
+  std::vector<uint8_t> m_encoded;
+
+  auto DecodeFrame(size_t frame) -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto FrameRecorder::GetNumWrittenFrames() const noexcept -> size_t
+{
+  return m_frameOffsets.size();
+}
+
+inline auto FrameRecorder::GetNumDroppedFrames() const noexcept -> size_t
+{
+  return m_numDropped;
+}
+
+inline auto FrameRecorder::GetNumWrittenBytes() const noexcept -> uint64_t
+{
+  return m_fileSize;
+}
+
+inline auto FrameReader::GetNumFrames() const noexcept -> size_t
+{
+  return m_frameOffsets.size();
+}
+
+inline auto FrameReader::GetSettings() const noexcept -> const FrameRecorderSettings&
+{
+  return m_settings;
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,86 @@
+module;
+
+#include <array>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+export module Particles.Frustum;
+
+export namespace PARTICLES
+{
+
+// A view frustum as six planes with their normals pointing inwards. For each plane, '.xyz'
+// is the unit normal and '.w' the signed distance term.
+class Frustum
+{
+public:
+  static constexpr auto NUM_PLANES = 6U;
+  using Planes                     = std::array<glm::vec4, NUM_PLANES>;
+
+  explicit Frustum(const Planes& planes) noexcept;
+
+  // Planes are extracted in world space from the combined projection * view matrix.
+  [[nodiscard]] static auto FromViewProjection(const glm::mat4& viewProjection) noexcept
+      -> Frustum;
+
+  [[nodiscard]] auto GetPlanes() const noexcept -> const Planes&;
+
+  [[nodiscard]] auto IsInside(const glm::vec4& point) const noexcept -> bool;
+  [[nodiscard]] auto IsBoxOutside(const glm::vec4& boxMin, const glm::vec4& boxMax) const noexcept
+      -> bool;
+
+private:
+  Planes m_planes;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline Frustum::Frustum(const Planes& planes) noexcept : m_planes{planes}
+{
+}
+
+inline auto Frustum::GetPlanes() const noexcept -> const Planes&
+{
+  return m_planes;
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+inline auto Frustum::IsInside(const glm::vec4& point) const noexcept -> bool
+{
+  for (const auto& plane : m_planes)
+  {
+    if (((plane.x * point.x) + (plane.y * point.y) + (plane.z * point.z) + plane.w) < 0.0F)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+inline auto Frustum::IsBoxOutside(const glm::vec4& boxMin, const glm::vec4& boxMax) const noexcept
+    -> bool
+{
+  for (const auto& plane : m_planes)
+  {
+    // The box corner furthest along the plane normal.
+    const auto x = plane.x < 0.0F ? boxMin.x : boxMax.x;
+    const auto y = plane.y < 0.0F ? boxMin.y : boxMax.y;
+    const auto z = plane.z < 0.0F ? boxMin.z : boxMax.z;
+
+    if (((plane.x * x) + (plane.y * y) + (plane.z * z) + plane.w) < 0.0F)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,81 @@
+module;
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+export module Particles.Parallel;
+
+export namespace PARTICLES
+{
+
+// A small fixed pool of worker threads for splitting loops over particles. The calling
+// thread does the first chunk itself, so one thread means everything runs inline.
+class Parallel
+{
+public:
+  // Zero threads means one per hardware thread.
+  explicit Parallel(uint32_t numThreads);
+  Parallel(const Parallel&) = delete;
+  Parallel(Parallel&&)      = delete;
+  ~Parallel() noexcept;
+  auto operator=(const Parallel&) -> Parallel& = delete;
+  auto operator=(Parallel&&) -> Parallel&      = delete;
+
+  [[nodiscard]] auto GetNumThreads() const noexcept -> uint32_t;
+
+  // Splits [0, numIterations) into one contiguous chunk per thread and waits for them all.
+  // The chunks only depend on the number of threads, so per chunk results can be combined in
+  // chunk order to get the same answer every run. Not reentrant.
+  using LoopFunc = std::function<void(uint32_t chunk, size_t begin, size_t end)>;
+  auto ForLoop(size_t numIterations, const LoopFunc& loopFunc) noexcept -> void;
+
+  struct ChunkRange
+  {
+    size_t begin;
+    size_t end;
+  };
+  [[nodiscard]] static auto GetChunkRange(uint32_t chunk,
+                                          uint32_t numChunks,
+                                          size_t numIterations) noexcept -> ChunkRange;
+
+private:
+  uint32_t m_numThreads;
+
+  std::mutex m_mutex;
+  std::condition_variable m_startLoop;
+  std::condition_variable m_loopDone;
+  const LoopFunc* m_loopFunc = nullptr;
+  size_t m_numIterations     = 0U;
+  uint64_t m_loopGeneration  = 0U;
+  uint32_t m_numBusyWorkers  = 0U;
+  bool m_stopping            = false;
+
+  std::vector<std::jthread> m_workers; // last, so they are joined before the rest goes
+
+  auto WorkerLoop(uint32_t chunk) noexcept -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto Parallel::GetNumThreads() const noexcept -> uint32_t
+{
+  return m_numThreads;
+}
+
+inline auto Parallel::GetChunkRange(const uint32_t chunk,
+                                    const uint32_t numChunks,
+                                    const size_t numIterations) noexcept -> ChunkRange
+{
+  return {.begin = (numIterations * chunk) / numChunks,
+          .end   = (numIterations * (chunk + 1)) / numChunks};
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,66 @@
+module;
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+export module Particles.ParticleCuller;
+
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.Particles;
+
+export namespace PARTICLES
+{
+
+// Per particle view culling. Lists the alive particles inside a view frustum, in index order,
+// so that 'DepthSorter::Sort' and 'ParticleSystem::WriteVertices' can take just those, and
+// the renderer only gets what is on screen. Unlike whole system culling, see
+// 'ParticleSystem::UpdateVisibility', this changes nothing in the simulation.
+class ParticleCuller
+{
+public:
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+  // Particles are taken as spheres of this radius, kept while any of them is inside, so that
+  // sprites don't pop at the edges of the screen.
+  auto SetRadius(float radius) noexcept -> void;
+
+  auto Cull(const ParticleData& particleData, const Frustum& viewFrustum) noexcept
+      -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto GetVisible() const noexcept -> std::span<const uint32_t>;
+
+private:
+  // Below this culling is quicker on one thread than shared out.
+  static constexpr auto MIN_PARALLEL_SIZE = 16384U;
+
+  std::shared_ptr<Parallel> m_parallel;
+  float m_radius = 0.0F;
+  std::vector<uint32_t> m_visible;
+  size_t m_numVisible = 0U;
+  std::vector<size_t> m_chunkNumVisible;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto ParticleCuller::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept
+    -> void
+{
+  m_parallel = parallel;
+}
+
+inline auto ParticleCuller::SetRadius(const float radius) noexcept -> void
+{
+  m_radius = radius;
+}
+
+inline auto ParticleCuller::GetVisible() const noexcept -> std::span<const uint32_t>
+{
+  return std::span{m_visible}.first(m_numVisible);
+}
+
+} // namespace PARTICLES
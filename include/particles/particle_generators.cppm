@@ -1,6 +1,7 @@
 module;
 
 #include <glm/vec4.hpp>
+#include <optional>
 
 export module Particles.ParticleGenerators;
 
@@ -106,6 +107,7 @@ public:
 
   auto Generate(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
       -> void override;
+  [[nodiscard]] auto GetMaxLifetime() const noexcept -> std::optional<float> override;
 
 private:
   float m_minTime;
@@ -131,4 +133,9 @@ inline auto RoundPositionGenerator::SetCentreAndRadius(const glm::vec4& center,
   m_yRadius = yRadius;
 }
 
+inline auto BasicTimeGenerator::GetMaxLifetime() const noexcept -> std::optional<float>
+{
+  return m_maxTime;
+}
+
 } // namespace PARTICLES::GENERATORS
@@ -1,59 +1,396 @@
 module;
 
+#include <cstdint>
+#include <future>
 #include <glm/common.hpp>
 #include <glm/vec4.hpp>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 export module Particles.ParticleUpdaters;
 
+import Particles.AttractorOctree;
+import Particles.Colliders;
+import Particles.Parallel;
 import Particles.Particles;
+import Particles.RadixSort;
+import Particles.SpatialGrid;
+import Particles.VectorGrid;
 
 export namespace PARTICLES::UPDATERS
 {
 
-class EulerUpdater : public IParticleUpdater
+// The integrators move the awake particles, so they also gather the bounds and speeds, see
+// 'ParticleStats', in the same loop. Big ranges are shared out between the threads.
+class IIntegratorUpdater : public IRangeParticleUpdater
+{
+public:
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void override;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void final;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool final;
+
+protected:
+  // Moves the particles in 'idRange' and, if 'stats' isn't null, adds their new positions and
+  // velocities to it. Called from several threads at once, for separate ranges.
+  virtual auto IntegrateRange(double dt,
+                              ParticleData& particleData,
+                              const IdRange& idRange,
+                              ParticleStats* stats) const noexcept -> void = 0;
+
+private:
+  // Below this a range is quicker on one thread than shared out.
+  static constexpr auto MIN_PARALLEL_SIZE = 16384U;
+
+  std::shared_ptr<Parallel> m_parallel;
+  std::vector<ParticleStats> m_chunkStats;
+};
+
+class EulerUpdater : public IIntegratorUpdater
 {
 public:
   explicit EulerUpdater(const glm::vec4& globalAcceleration) noexcept;
 
-  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+protected:
+  auto IntegrateRange(double dt,
+                      ParticleData& particleData,
+                      const IdRange& idRange,
+                      ParticleStats* stats) const noexcept -> void override;
+
+private:
+  glm::vec4 m_globalAcceleration;
+};
+
+// Symplectic Euler - the velocity is updated first and the new velocity moves the particle.
+// Much better behaved than explicit Euler for orbits around attractors and bounces.
+class SemiImplicitEulerUpdater : public IIntegratorUpdater
+{
+public:
+  explicit SemiImplicitEulerUpdater(const glm::vec4& globalAcceleration) noexcept;
+
+protected:
+  auto IntegrateRange(double dt,
+                      ParticleData& particleData,
+                      const IdRange& idRange,
+                      ParticleStats* stats) const noexcept -> void override;
 
 private:
   glm::vec4 m_globalAcceleration;
 };
 
-// Collision with the floor :) todo: implement a collision model
-class FloorUpdater : public IParticleUpdater
+enum class ForceSource : uint8_t
+{
+  GLOBAL_AND_UPDATERS, // the global acceleration plus what the updaters before it add
+  GLOBAL_ONLY,         // just the global acceleration - the accelerations aren't read
+};
+
+// Velocity Verlet. The forces are evaluated once a step, by the updaters before this one, so
+// both half kicks use that step's acceleration. This is exact for constant acceleration, like
+// gravity, and second order in position otherwise. For effects whose only force is gravity,
+// like a fountain, 'GLOBAL_ONLY' leaves the accelerations alone, so the system can skip
+// clearing them when nothing else needs them.
+class VelocityVerletUpdater : public IIntegratorUpdater
+{
+public:
+  explicit VelocityVerletUpdater(const glm::vec4& globalAcceleration) noexcept;
+
+  // 'GLOBAL_AND_UPDATERS' by default.
+  auto SetForceSource(ForceSource forceSource) noexcept -> void;
+
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
+protected:
+  auto IntegrateRange(double dt,
+                      ParticleData& particleData,
+                      const IdRange& idRange,
+                      ParticleStats* stats) const noexcept -> void override;
+
+private:
+  glm::vec4 m_globalAcceleration;
+  ForceSource m_forceSource = ForceSource::GLOBAL_AND_UPDATERS;
+};
+
+// Collision with the floor :) ColliderUpdater handles other shapes, and many of them. It
+// bounces the particles that an integrator before it moved below the floor, and only changes
+// their velocities, not the accelerations.
+class FloorUpdater : public IRangeParticleUpdater
 {
 public:
   FloorUpdater(float floorY, float bounceFactor) noexcept;
 
-  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  // Particles on the floor slower than this are put to sleep. Zero (the default) disables it.
+  auto SetSleepSpeed(float sleepSpeed) noexcept -> void;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
 
 private:
   float m_floorY;
   float m_bounceFactor;
+  float m_sleepSpeedSq = 0.0F;
 };
 
-class AttractorUpdater : public IParticleUpdater
+// Keeps particles out of a set of solid shapes. A particle found inside is moved out to the
+// surface of the shape it is deepest in, its velocity into that surface is reflected, scaled
+// by 'bounceFactor', and its velocity along the surface is scaled by one minus 'friction'.
+class ColliderUpdater : public IRangeParticleUpdater
+{
+public:
+  ColliderUpdater(std::shared_ptr<const ColliderSet> colliders,
+                  float bounceFactor,
+                  float friction) noexcept;
+
+  // Particles slower than this after a collision are put to sleep. Zero (the default) disables
+  // it. Only for colliders that stay put.
+  auto SetSleepSpeed(float sleepSpeed) noexcept -> void;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
+private:
+  std::shared_ptr<const ColliderSet> m_colliders;
+  float m_bounceFactor;
+  float m_friction;
+  float m_sleepSpeedSq = 0.0F;
+  std::vector<size_t> m_collidingIds;
+};
+
+// Keeps particles out of a solid given by a distance field, see 'MakeDistanceField', pushing
+// them out along its gradient and bouncing them as ColliderUpdater does. Only particles in the
+// box around the solid's cells sample the field.
+class DistanceFieldColliderUpdater : public IRangeParticleUpdater
+{
+public:
+  DistanceFieldColliderUpdater(std::shared_ptr<const VectorGrid> distanceField,
+                               float bounceFactor,
+                               float friction) noexcept;
+
+  // As for ColliderUpdater.
+  auto SetSleepSpeed(float sleepSpeed) noexcept -> void;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
+private:
+  std::shared_ptr<const VectorGrid> m_distanceField;
+  float m_bounceFactor;
+  float m_friction;
+  float m_sleepSpeedSq = 0.0F;
+  glm::vec4 m_solidMin{0.0F};
+  glm::vec4 m_solidMax{0.0F};
+};
+
+enum class AttractorEvaluation : uint8_t
+{
+  EXACT,      // every attractor for every particle, O(N*M)
+  BARNES_HUT, // octree approximation, roughly O(N*log(M))
+};
+
+struct ForceFieldCacheSettings
+{
+  glm::vec4 boundsMin{-1.0F};
+  glm::vec4 boundsMax{+1.0F};
+  uint32_t resolution = 32U; // grid points along each axis
+  // Cells where the interpolated field is further than this, relative to the exact field, at
+  // the cell centre keep the exact evaluation. These are the cells around the attractors.
+  float tolerance       = 0.05F;
+  bool bakeInBackground = true;
+};
+
+struct AttractorErrorReport
+{
+  size_t numSamples;
+  double meanRelativeError;
+  double maxRelativeError;
+};
+
+class AttractorUpdater : public IRangeParticleUpdater
 {
 public:
   AttractorUpdater() noexcept = default;
 
   auto AddAttractorPosition(const glm::vec4& attractorPosition) noexcept -> void;
+  // For moving attractors. 'index' is in the order the attractors were added.
+  auto SetAttractorPosition(size_t index, const glm::vec4& attractorPosition) noexcept -> void;
+  [[nodiscard]] auto GetNumAttractors() const noexcept -> size_t;
+
+  // Barnes-Hut pays off from around a hundred attractors. With the default opening angle the
+  // typical error is about a percent.
+  static constexpr auto DEFAULT_OPENING_ANGLE = 0.5F;
+  auto SetEvaluation(AttractorEvaluation evaluation,
+                     float openingAngle = DEFAULT_OPENING_ANGLE) noexcept -> void;
+  [[nodiscard]] auto GetEvaluation() const noexcept -> AttractorEvaluation;
+
+  // For attractors that stay put, or only move now and then. The summed field is baked into
+  // a grid over the bounds and particles inside it just sample the grid. Adding or moving an
+  // attractor rebakes the grid, and until that is done the evaluation mode is used.
+  auto EnableForceFieldCache(const ForceFieldCacheSettings& settings) noexcept -> void;
+  auto DisableForceFieldCache() noexcept -> void;
+  [[nodiscard]] auto IsForceFieldCacheReady() const noexcept -> bool;
+
+  // Compares what the updater currently uses, the cache or the evaluation mode, with the exact
+  // sum over up to 'maxNumSamples' of the awake particles, spread evenly over them.
+  [[nodiscard]] auto MeasureApproximationError(const ParticleData& particleData,
+                                               size_t maxNumSamples) noexcept
+      -> AttractorErrorReport;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool override;
+
+private:
+  std::vector<glm::vec4> m_attractorPositions; // .w is force
+  AttractorEvaluation m_evaluation = AttractorEvaluation::EXACT;
+  float m_openingAngle             = DEFAULT_OPENING_ANGLE;
+  AttractorOctree m_octree;
+  bool m_octreeIsStale = true;
+
+  // Bumped by any change to the attractors or the cache settings.
+  uint64_t m_fieldVersion = 0U;
+  struct BakedForceField
+  {
+    VectorGrid field;
+    std::vector<uint8_t> exactCells;
+    uint64_t fieldVersion;
+  };
+  std::optional<ForceFieldCacheSettings> m_cacheSettings;
+  std::shared_ptr<const BakedForceField> m_bakedField;
+  std::future<std::shared_ptr<const BakedForceField>> m_pendingBake;
+  auto UpdateForceFieldCache() noexcept -> void;
+  [[nodiscard]] static auto BakeForceField(const ForceFieldCacheSettings& settings,
+                                           const std::vector<glm::vec4>& attractorPositions,
+                                           uint64_t fieldVersion)
+      -> std::shared_ptr<const BakedForceField>;
+  auto UpdateRangeWithCache(ParticleData& particleData, const IdRange& idRange) noexcept -> void;
+  [[nodiscard]] auto GetCachedAcceleration(const glm::vec4& position) noexcept -> glm::vec4;
+
+  [[nodiscard]] auto GetAcceleration(const glm::vec4& position) noexcept -> glm::vec4;
+  auto UpdateOctree() noexcept -> void;
+};
+
+struct FlockingSettings
+{
+  float neighbourRadius     = 0.1F;
+  float separationStrength  = 1.0F; // push away from neighbours, harder the closer they are
+  float alignmentStrength   = 0.0F; // steer towards the neighbours' average velocity
+  float cohesionStrength    = 0.0F; // pull towards the neighbours' centre
+  uint32_t maxNumNeighbours = 32U; // caps the work in dense clumps
+  uint32_t gridSlotsLog2    = 18U; // about one grid slot per particle is best
+};
+
+// Particle-particle forces between the awake particles within a radius of each other. The
+// neighbours are found with a spatial hash grid rebuilt each update, so the cost is linear in
+// the number of particles rather than quadratic. With the default settings this just keeps
+// particles from piling up on each other.
+class FlockingUpdater : public IParticleUpdater
+{
+public:
+  explicit FlockingUpdater(const FlockingSettings& settings) noexcept;
+
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void override;
 
   auto Update(double dt, ParticleData& particleData) noexcept -> void override;
 
 private:
-  std::vector<glm::vec4> m_attractorPositions; // .w is force
+  FlockingSettings m_settings;
+  SpatialHashGrid m_grid;
+  std::shared_ptr<Parallel> m_parallel;
+
+  auto UpdateParticles(ParticleData& particleData, size_t begin, size_t end) const noexcept
+      -> void;
+};
+
+// Kills swap the last particle into the hole, so over time particles next to each other in
+// memory end up far apart in space. This sorts the awake particles along a Z-order curve,
+// which makes anything that walks the particles and touches spatial data, like field sampling
+// or grid building, hit the cache more. To keep the cost of any one frame small, each update
+// only sorts the next window of the awake range, 1/'period' of it, so all of it is sorted
+// every 'period' updates. The curve is laid over the bounds of the alive particles at the start
+// of each period. Run it before the updaters that benefit. With LOD on, the sort mixes the
+// tiers up and partitioning them again undoes much of it, so it does little.
+class SpatialReorderUpdater : public IParticleUpdater
+{
+public:
+  explicit SpatialReorderUpdater(uint32_t period) noexcept;
+
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void override;
+
+  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
+  // The mean distance between awake particles next to each other in memory. Lower is better.
+  [[nodiscard]] static auto MeasureLocality(const ParticleData& particleData) noexcept -> double;
+
+private:
+  // So small systems are sorted in one go.
+  static constexpr auto MIN_WINDOW_SIZE = 4096U;
+  // Coordinates along each axis of the curve.
+  static constexpr auto MAX_COORD = static_cast<float>((1U << 10U) - 1U);
+  uint32_t m_period;
+  size_t m_windowStart = 0U;
+  glm::vec4 m_boundsMin{0.0F};
+  glm::vec4 m_boundsScale{0.0F};
+  std::shared_ptr<Parallel> m_parallel;
+  RadixSort m_radixSort;
+  std::vector<uint32_t> m_keys;
+  std::vector<uint32_t> m_order;
+
+  auto MakeBounds(std::span<const glm::vec4> positions) noexcept -> void;
+  auto MakeKeys(std::span<const glm::vec4> positions) noexcept -> void;
+};
+
+enum class VectorFieldMode : uint8_t
+{
+  FORCE, // the field is an acceleration
+  FLOW,  // the field is a velocity the particles are dragged towards, 'strength' per second
 };
 
-class IColorUpdater : public IParticleUpdater
+// Moves particles through a precomputed vector field, loaded from a file or made at startup,
+// for example 'MakeCurlNoiseGrid'. Particles outside the grid get the value at its boundary.
+class VectorFieldUpdater : public IRangeParticleUpdater
+{
+public:
+  VectorFieldUpdater(std::shared_ptr<const VectorGrid> field,
+                     VectorFieldMode mode,
+                     float strength) noexcept;
+
+  // Animates the field by blending smoothly to 'blendField' and back every 'period' seconds
+  // of 'SetTime'. Both grids must have the same bounds and resolution.
+  auto SetBlendField(std::shared_ptr<const VectorGrid> blendField, double period) noexcept
+      -> void;
+  // For example the particle system's simulation time.
+  auto SetTime(double time) noexcept -> void;
+
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
+  [[nodiscard]] auto SkipsSleepingParticles() const noexcept -> bool override;
+
+private:
+  std::shared_ptr<const VectorGrid> m_field;
+  VectorFieldMode m_mode;
+  float m_strength;
+  std::shared_ptr<const VectorGrid> m_blendField;
+  double m_blendPeriod = 1.0;
+  float m_blendAmount  = 0.0F;
+};
+
+class IColorUpdater : public IRangeParticleUpdater
 {
 public:
   auto SetTintColor(const glm::vec4& tintColor) noexcept -> void;
   auto SetTintMixAmount(float mixAmount) noexcept -> void; // higher mix amount for more tint
 
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
 protected:
   [[nodiscard]] auto GetMixedTintColor() const noexcept -> const glm::vec4&;
 
@@ -67,7 +404,8 @@ private:
 class BasicColorUpdater : public IColorUpdater
 {
 public:
-  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
 };
 
 class PositionColorUpdater : public IColorUpdater
@@ -75,7 +413,8 @@ class PositionColorUpdater : public IColorUpdater
 public:
   PositionColorUpdater(const glm::vec4& minPosition, const glm::vec4& maxPosition) noexcept;
 
-  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
 
 private:
   glm::vec4 m_minPosition;
@@ -88,7 +427,8 @@ class VelocityColorUpdater : public IColorUpdater
 public:
   VelocityColorUpdater(const glm::vec4& minVelocity, const glm::vec4& maxVelocity) noexcept;
 
-  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void override;
 
 private:
   glm::vec4 m_minVelocity;
@@ -100,6 +440,48 @@ class BasicTimeUpdater : public IParticleUpdater
 {
 public:
   auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  // Ageing is linear in time, so any step is exact.
+  [[nodiscard]] auto RunsWhenCulled() const noexcept -> bool override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+};
+
+enum class StaggerMode : uint8_t
+{
+  EVERY_NTH_FRAME, // update all the particles once every 'period' frames
+  ROTATING_WINDOW, // update a different 1/period of the particles each frame
+};
+
+struct StaggerSchedule
+{
+  StaggerMode mode = StaggerMode::EVERY_NTH_FRAME;
+  uint32_t period  = 1U;
+};
+
+// Runs another updater on a reduced schedule. Meant for cosmetic stages, like the color
+// updaters, where a few frames of lag is invisible. The wrapped updater is always given the
+// time elapsed since it last saw the particles, so time dependent stages still work.
+// Rotating window mode needs a range updater - any other updater gets every Nth frame.
+class StaggeredUpdater : public IParticleUpdater
+{
+public:
+  StaggeredUpdater(const std::shared_ptr<IParticleUpdater>& updater,
+                   const StaggerSchedule& schedule) noexcept;
+
+  [[nodiscard]] auto GetSchedule() const noexcept -> const StaggerSchedule&;
+
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void override;
+
+  auto Update(double dt, ParticleData& particleData) noexcept -> void override;
+  [[nodiscard]] auto RunsWhenCulled() const noexcept -> bool override;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool override;
+
+private:
+  std::shared_ptr<IParticleUpdater> m_updater;
+  std::shared_ptr<IRangeParticleUpdater> m_rangeUpdater;
+  StaggerSchedule m_schedule;
+  uint32_t m_frame            = 0U;
+  double m_elapsedSinceUpdate = 0.0;
+  std::vector<double> m_windowDts; // last 'period' frame dts, for rotating window mode
 };
 
 } // namespace PARTICLES::UPDATERS
@@ -107,10 +489,187 @@ public:
 namespace PARTICLES::UPDATERS
 {
 
+inline auto IIntegratorUpdater::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept
+    -> void
+{
+  m_parallel = parallel;
+}
+
+inline auto IIntegratorUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto VelocityVerletUpdater::SetForceSource(const ForceSource forceSource) noexcept -> void
+{
+  m_forceSource = forceSource;
+}
+
+inline auto VelocityVerletUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return ForceSource::GLOBAL_AND_UPDATERS == m_forceSource;
+}
+
+inline auto FloorUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto FloorUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto FloorUpdater::SetSleepSpeed(const float sleepSpeed) noexcept -> void
+{
+  m_sleepSpeedSq = sleepSpeed * sleepSpeed;
+}
+
+inline auto ColliderUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto ColliderUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto ColliderUpdater::SetSleepSpeed(const float sleepSpeed) noexcept -> void
+{
+  m_sleepSpeedSq = sleepSpeed * sleepSpeed;
+}
+
+inline auto DistanceFieldColliderUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto DistanceFieldColliderUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto DistanceFieldColliderUpdater::SetSleepSpeed(const float sleepSpeed) noexcept -> void
+{
+  m_sleepSpeedSq = sleepSpeed * sleepSpeed;
+}
+
+inline auto AttractorUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
 inline auto AttractorUpdater::AddAttractorPosition(const glm::vec4& attractorPosition) noexcept
     -> void
 {
   m_attractorPositions.push_back(attractorPosition);
+  m_octreeIsStale = true;
+  ++m_fieldVersion;
+}
+
+inline auto AttractorUpdater::SetAttractorPosition(const size_t index,
+                                                   const glm::vec4& attractorPosition) noexcept
+    -> void
+{
+  m_attractorPositions.at(index) = attractorPosition;
+  m_octreeIsStale                = true;
+  ++m_fieldVersion;
+}
+
+inline auto AttractorUpdater::GetNumAttractors() const noexcept -> size_t
+{
+  return m_attractorPositions.size();
+}
+
+inline auto AttractorUpdater::SetEvaluation(const AttractorEvaluation evaluation,
+                                            const float openingAngle) noexcept -> void
+{
+  m_evaluation   = evaluation;
+  m_openingAngle = openingAngle;
+}
+
+inline auto AttractorUpdater::GetEvaluation() const noexcept -> AttractorEvaluation
+{
+  return m_evaluation;
+}
+
+inline auto AttractorUpdater::EnableForceFieldCache(
+    const ForceFieldCacheSettings& settings) noexcept -> void
+{
+  m_cacheSettings = settings;
+  ++m_fieldVersion;
+}
+
+inline auto AttractorUpdater::DisableForceFieldCache() noexcept -> void
+{
+  m_cacheSettings.reset();
+  m_bakedField.reset();
+}
+
+inline auto AttractorUpdater::IsForceFieldCacheReady() const noexcept -> bool
+{
+  return (nullptr != m_bakedField) and (m_bakedField->fieldVersion == m_fieldVersion);
+}
+
+inline auto FlockingUpdater::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept
+    -> void
+{
+  m_parallel = parallel;
+  m_grid.SetParallel(parallel);
+}
+
+inline auto VectorFieldUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto SpatialReorderUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto SpatialReorderUpdater::SetParallel(
+    const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  m_parallel = parallel;
+  m_radixSort.SetParallel(parallel);
+}
+
+inline auto BasicTimeUpdater::RunsWhenCulled() const noexcept -> bool
+{
+  return true;
+}
+
+inline auto BasicTimeUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto StaggeredUpdater::RunsWhenCulled() const noexcept -> bool
+{
+  return m_updater->RunsWhenCulled();
+}
+
+inline auto StaggeredUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return m_updater->NeedsAccelerations();
+}
+
+inline auto StaggeredUpdater::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept
+    -> void
+{
+  m_updater->SetParallel(parallel);
+}
+
+inline auto StaggeredUpdater::GetSchedule() const noexcept -> const StaggerSchedule&
+{
+  return m_schedule;
+}
+
+inline auto IColorUpdater::NeedsAccelerations() const noexcept -> bool
+{
+  return false;
 }
 
 inline auto IColorUpdater::SetTintColor(const glm::vec4& tintColor) noexcept -> void
@@ -3,16 +3,61 @@
 module;
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 export module Particles.Particles;
 
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.Random;
+
 export namespace PARTICLES
 {
 
+struct IdRange
+{
+  size_t start;
+  size_t end;
+};
+
+// Bounds and statistics of the alive particles, for culling and telemetry. The integrators and
+// the time updater gather them in the loops they already run, see 'ParticleSystem::EnableStats'.
+struct ParticleStats
+{
+  glm::vec4 boundsMin{std::numeric_limits<float>::max()};
+  glm::vec4 boundsMax{std::numeric_limits<float>::lowest()};
+  float minSpeedSq   = std::numeric_limits<float>::max();
+  float maxSpeedSq   = 0.0F;
+  size_t numInBounds = 0U;
+  double totalAge    = 0.0;
+  size_t numAged     = 0U;
+
+  auto AddMotion(const glm::vec4& position, const glm::vec4& velocity) noexcept -> void;
+  auto AddAge(float age) noexcept -> void;
+  // The bounds and speeds are minimums and maximums, so chunks of a parallel loop can be merged
+  // in any order and give the same result.
+  auto Merge(const ParticleStats& other) noexcept -> void;
+
+  [[nodiscard]] auto HasBounds() const noexcept -> bool;
+  [[nodiscard]] auto GetMinSpeed() const noexcept -> float;
+  [[nodiscard]] auto GetMaxSpeed() const noexcept -> float;
+  [[nodiscard]] auto GetMeanAge() const noexcept -> double; // seconds since emission
+};
+
 class ParticleData
 {
 public:
@@ -23,10 +68,42 @@ public:
   auto Kill(size_t id) noexcept -> void;
   auto Wake(size_t id) noexcept -> void;
   auto SwapData(size_t a, size_t b) noexcept -> void;
+  // Unlike 'SwapData', which just overwrites 'a' with 'b', this keeps both particles.
+  auto SwapParticles(size_t a, size_t b) noexcept -> void;
+  // Moves the particles in [start, start + order.size()) so that 'start + i' is the one that
+  // was at 'start + order[i]'. For sorting, as all the streams move at once.
+  auto Permute(size_t start, std::span<const uint32_t> order) noexcept -> void;
 
   [[nodiscard]] auto GetCount() const noexcept -> size_t;
   [[nodiscard]] auto GetAliveCount() const noexcept -> size_t;
 
+  // Alive particles at rest can be put to sleep. They are kept at the end of the alive range,
+  // [awake count, alive count), and motion updaters skip them until they are woken.
+  [[nodiscard]] auto GetAwakeCount() const noexcept -> size_t;
+  // Sleeping is deferred until 'ApplySleepRequests' so that updaters can request it in the
+  // middle of a loop without particles moving under them.
+  auto RequestSleep(size_t i) noexcept -> void;
+  [[nodiscard]] auto HasSleepRequests() const noexcept -> bool;
+  auto ApplySleepRequests() noexcept -> void;
+  auto WakeAllSleeping() noexcept -> void;
+
+  // Every particle woken gets a new id, which stays with it as it moves about the streams
+  // until it dies, for following particles from frame to frame. Ids wrap around to 0 after
+  // 2^32 wakes, so one is only given out again after 2^32 more particles are woken. That is far
+  // more than are alive at once or woken from one frame to the next, so ids stay unique among
+  // the alive particles and between consecutive frames, but not over a whole long run.
+  [[nodiscard]] auto GetIds() const noexcept -> std::span<const uint32_t>;
+
+  // The LOD tier a particle is updated in, kept by 'ParticleSystem'. Like the id, it stays with
+  // the particle as it moves about the streams. New and woken particles start in tier 0.
+  [[nodiscard]] auto GetLodTier(size_t i) const noexcept -> uint8_t;
+  auto SetLodTier(size_t i, uint8_t lodTier) noexcept -> void;
+
+  // The whole streams, for tight loops over the alive particles.
+  [[nodiscard]] auto GetPositions() const noexcept -> std::span<const glm::vec4>;
+  [[nodiscard]] auto GetVelocities() const noexcept -> std::span<const glm::vec4>;
+  [[nodiscard]] auto GetColors() const noexcept -> std::span<const glm::vec4>;
+
   [[nodiscard]] auto GetPosition(size_t i) const noexcept -> const glm::vec4&;
   auto SetPosition(size_t i, const glm::vec4& position) noexcept -> void;
   auto IncPosition(size_t i, const glm::vec4& amount) noexcept -> void;
@@ -52,11 +129,31 @@ public:
   [[nodiscard]] auto GetTime(size_t i) const noexcept -> const glm::vec4&;
   auto SetTime(size_t i, const glm::vec4& time) noexcept -> void;
 
+  // While gathering stats, updaters that read positions, velocities or ages merge what they see
+  // into the stats. The owner resets them.
+  auto SetGatherStats(bool gatherStats) noexcept -> void;
+  [[nodiscard]] auto IsGatheringStats() const noexcept -> bool;
+  auto ResetStats() noexcept -> void;
+  auto MergeStats(const ParticleStats& stats) noexcept -> void;
+  [[nodiscard]] auto GetStats() const noexcept -> const ParticleStats&;
+
+  // The alive part of every stream, in a fixed order, for saving the particles as they are.
+  // See 'Particles.Snapshot'.
+  static constexpr auto NUM_STREAMS = 7U;
+  using Streams                     = std::array<std::span<const glm::vec4>, NUM_STREAMS>;
+  [[nodiscard]] auto GetAliveStreams() const noexcept -> Streams;
+  // Replaces the particles with the ones in 'streams', which are all the same size and no
+  // bigger than the count. The first 'awakeCount' are awake and the rest asleep. They are
+  // given new ids.
+  auto Restore(const Streams& streams, size_t awakeCount) noexcept -> void;
+
   [[nodiscard]] static auto ComputeMemoryUsage(const ParticleData& particleData) noexcept -> size_t;
 
 private:
   size_t m_count;
   size_t m_countAlive = 0U;
+  size_t m_countAwake = 0U;
+  std::vector<size_t> m_sleepRequests;
 
   std::vector<glm::vec4> m_position;
   std::vector<glm::vec4> m_velocity;
@@ -65,42 +162,236 @@ private:
   std::vector<glm::vec4> m_startColor;
   std::vector<glm::vec4> m_endColor;
   std::vector<glm::vec4> m_time;
+  std::vector<uint32_t> m_id;
+  uint32_t m_nextId = 0U; // wraps, see 'GetIds'
+  std::vector<uint8_t> m_lodTier;
   std::vector<bool> m_alive;
-
-  static constexpr auto MEM_BYTES = +(2 * sizeof(size_t)) + (7 * sizeof(glm::vec4)) + sizeof(bool);
+  std::vector<glm::vec4> m_permuteScratch;
+  std::vector<uint32_t> m_permuteIdScratch;
+  std::vector<uint8_t> m_permuteLodTierScratch;
+  bool m_gatherStats = false;
+  ParticleStats m_stats{};
+
+  static constexpr auto MEM_BYTES =
+      +(2 * sizeof(size_t)) + (7 * sizeof(glm::vec4)) + sizeof(uint32_t) + sizeof(uint8_t) +
+      sizeof(bool);
 };
 
 class ParticleEmitter;
 class IParticleUpdater;
 
+// A vertex layout for 'ParticleSystem::WriteVertices', like the ones in 'VertexFormats'.
+template<typename Format>
+concept VertexFormat = requires(const ParticleData& particleData,
+                                const typename Format::Settings& settings,
+                                const IdRange& idRange,
+                                std::span<const uint32_t> ids,
+                                std::span<typename Format::Vertex> vertices) {
+  { Format::VERTICES_PER_PARTICLE } -> std::convertible_to<uint32_t>;
+  Format::Write(particleData, settings, idRange, vertices);
+  Format::Write(particleData, settings, ids, vertices);
+};
+
+struct LodSettings
+{
+  static constexpr auto NUM_TIERS = 3U;
+  // Particles further from the view than 'tierDistances[i]' go in tier i + 1. Particles
+  // outside the view frustum always go in the last tier.
+  std::array<float, NUM_TIERS - 1> tierDistances{};
+  // Tier i is only updated every 'updatePeriods[i]' frames, catching up on the missed time.
+  // Tier 0 is always updated every frame, as new particles start in it.
+  std::array<uint32_t, NUM_TIERS> updatePeriods{1U, 1U, 1U};
+};
+
+struct CullSettings
+{
+  // While culled, the updaters that run when culled get the elapsed time every this many frames.
+  uint32_t updatePeriod = 4U;
+  // When a culled system becomes visible again, the other updaters are given the time they
+  // missed in one step, but no more than this, to keep the integrators stable.
+  double maxCatchUpDt = 0.1;
+};
+
 class ParticleSystem
 {
 public:
   explicit ParticleSystem(size_t maxCount);
 
+  // Level of detail. Every frame, the alive particles are partitioned into tiers by their
+  // distance from the view and range updaters are run on each tier on the tier's schedule.
+  // A particle only moves to another tier when neither tier has time still to catch up on.
+  // Full updaters, like the time updater, still see all particles every frame.
+  auto SetLodSettings(const LodSettings& lodSettings) noexcept -> void;
+  auto SetLodView(const glm::vec4& viewPosition, const std::optional<Frustum>& viewFrustum) noexcept
+      -> void;
+  auto DisableLod() noexcept -> void;
+  // Limit an updater to the nearer tiers, for example to drop attractor forces for far away
+  // particles.
+  auto SetUpdaterMaxLodTier(const std::shared_ptr<IParticleUpdater>& updater,
+                            uint32_t maxLodTier) noexcept -> void;
+  // Only valid after an update with LOD enabled.
+  [[nodiscard]] auto GetLodTierRange(uint32_t tier) const noexcept -> const IdRange&;
+
   auto AddEmitter(const std::shared_ptr<ParticleEmitter>& emitter) noexcept -> void;
+  // The generators each draw from a random stream of their own, picked by the seed and their
+  // place in the system, so the same seed gives the same particles. Reseeds the emitters
+  // added so far, and the ones added later.
+  auto SetRandomSeed(uint64_t seed) noexcept -> void;
+  [[nodiscard]] auto GetRandomSeed() const noexcept -> uint64_t;
 
   auto AddUpdater(const std::shared_ptr<IParticleUpdater>& updater) noexcept -> void;
   auto ReplaceUpdater(const std::shared_ptr<IParticleUpdater>& oldUpdater,
                       const std::shared_ptr<IParticleUpdater>& newUpdater) noexcept -> void;
 
   auto Reset() noexcept -> void;
+  // Replaces the particles and the simulation time with ones saved from a system with the same
+  // emitters and updaters, to start a pre-warmed effect. See 'Particles.Snapshot'.
+  auto Restore(const ParticleData::Streams& streams,
+               size_t awakeCount,
+               double simulationTime) noexcept -> void;
+
+  // Shares a thread pool with all the updaters, current and future.
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+
+  // In fixed time step mode, 'Update' accumulates the frame time and simulates it in whole
+  // steps of 'stepDt', running at most 'maxNumSteps' a frame. Any time beyond that is dropped
+  // rather than letting the simulation fall further and further behind.
+  auto SetFixedTimeStep(double stepDt, uint32_t maxNumSteps) noexcept -> void;
+  auto DisableFixedTimeStep() noexcept -> void;
 
   auto Update(double dt) noexcept -> void;
 
+  // Brings the system, from empty, close to where 'Update' at frame rate for 'seconds' would,
+  // in a fraction of the time, for effects that should start in full flow. The particles are
+  // aged by the lifetimes the 'BasicTimeGenerator' gives them. Emitting starts the longest
+  // lifetime before the end, as all the particles from before then are dead by it, and the
+  // ones due to die before the end are dropped as they are emitted. The rest are updated in
+  // steps of 'stepDt', a frame by default, with the births spread evenly over each step.
+  // Longer steps save time when the updaters are costly, at some cost in accuracy, and don't
+  // suit colliders that push particles back out a step at a time, like 'FloorUpdater'.
+  // Emitters that move from frame to frame are left where they are. If some emitter's
+  // particles have no lifetime, every step's particles are emitted as in 'Update', all at once.
+  static constexpr auto DEFAULT_PREWARM_STEP_DT = 1.0 / 60.0;
+  auto Prewarm(double seconds) noexcept -> void;
+  auto Prewarm(double seconds, double stepDt) noexcept -> void;
+
+  // Call when something disturbs particles at rest, such as a collider or attractor moving.
+  auto WakeSleepingParticles() noexcept -> void;
+
   [[nodiscard]] auto GetNumAllParticles() const noexcept -> size_t;
   [[nodiscard]] auto GetNumAliveParticles() const noexcept -> size_t;
   [[nodiscard]] auto GetFinalData() const noexcept -> const ParticleData&;
 
+  // The time of the current particle state - the sum of all the simulated steps.
+  [[nodiscard]] auto GetSimulationTime() const noexcept -> double;
+  // Lets the simulation run at a lower rate than the renderer. Writes the alive particle
+  // positions, moved along their velocities to 'renderTime', into 'positions' and returns the
+  // number written. With LOD, each particle is moved from where its tier was last updated. A
+  // render time a little before the simulation time approximates interpolating between the
+  // last two steps.
+  auto WriteExtrapolatedPositions(double renderTime, std::span<glm::vec4> positions) const noexcept
+      -> size_t;
+
+  // Writes the alive particles, laid out as 'Format' says, straight into 'vertices', which can
+  // be a persistently mapped GPU buffer. Big systems are shared out between the threads.
+  // Returns the number of particles written, as many as fit.
+  template<VertexFormat Format>
+  auto WriteVertices(const typename Format::Settings& settings,
+                     std::span<typename Format::Vertex> vertices) const noexcept -> size_t;
+  // The same for just the particles in 'ids', in that order, such as the visible ones from a
+  // 'ParticleCuller' or the order from a 'DepthSorter', so that culled and sorted particles
+  // are written packed in the one pass.
+  template<VertexFormat Format>
+  auto WriteVertices(const typename Format::Settings& settings,
+                     std::span<const uint32_t> ids,
+                     std::span<typename Format::Vertex> vertices) const noexcept -> size_t;
+
+  // Bounds, speeds and mean age of the alive particles after the last step. Off by default.
+  // The integrators gather the bounds and speeds as they move the particles, and the particles
+  // they didn't move - sleeping ones, or ones in LOD tiers that weren't due - are added from
+  // where they are. Without an integrator, or a time updater for the ages, the system makes a
+  // pass of its own. Collisions after the integrator can leave a particle just outside the
+  // bounds, by how far it was pushed.
+  auto EnableStats() noexcept -> void;
+  auto DisableStats() noexcept -> void;
+  [[nodiscard]] auto GetStats() const noexcept -> const ParticleStats&;
+
+  // Whole system culling, for effects the camera isn't facing. A culled system keeps emitting,
+  // but only the updaters that 'RunsWhenCulled', like the time updater, are run, on the cull
+  // schedule, with the time since they last ran. When it becomes visible again the other
+  // updaters catch up on the time they missed in one step.
+  auto SetCullSettings(const CullSettings& cullSettings) noexcept -> void;
+  auto SetCulled(bool culled) noexcept -> void;
+  [[nodiscard]] auto IsCulled() const noexcept -> bool;
+  // Culls the system if its bounds, see 'GetStats', are outside 'viewFrustum', and returns
+  // whether it is visible. Turns the stats on if they are off, and a system without bounds yet
+  // is never culled. Particles emitted while culled are added to the bounds.
+  auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool;
+
   [[nodiscard]] static auto ComputeMemoryUsage(const ParticleSystem& particleSystem) noexcept
       -> size_t;
 
 private:
   size_t m_count;
   ParticleData m_particles;
+  // Below this, writing vertices, or spreading pre-warm births, is quicker on one thread than
+  // shared out.
+  static constexpr auto MIN_PARALLEL_VERTICES = 16384U;
+  static constexpr auto MIN_PARALLEL_EMITTED  = 16384U;
 
   std::vector<std::shared_ptr<ParticleEmitter>> m_emitters;
+  uint64_t m_randomSeed = Random::DEFAULT_SEED;
   std::vector<std::shared_ptr<IParticleUpdater>> m_updaters;
+  std::vector<uint32_t> m_updaterMaxLodTiers;
+  std::shared_ptr<Parallel> m_parallel;
+
+  bool m_fixedTimeStepEnabled = false;
+  double m_fixedTimeStep      = 0.0;
+  uint32_t m_maxNumTimeSteps  = 1U;
+  double m_accumulatedTime    = 0.0;
+  double m_simulationTime     = 0.0;
+
+  CullSettings m_cullSettings{};
+  bool m_culled             = false;
+  bool m_catchUpPending     = false;
+  uint32_t m_culledFrame    = 0U;
+  double m_culledUpdatersDt = 0.0; // not yet given to the updaters that run when culled
+  double m_catchUpDt        = 0.0; // not yet given to the others
+
+  bool m_lodEnabled = false;
+  LodSettings m_lodSettings{};
+  std::array<float, LodSettings::NUM_TIERS - 1> m_lodTierDistancesSq{};
+  glm::vec4 m_viewPosition{0.0F};
+  std::optional<Frustum> m_viewFrustum;
+  uint32_t m_lodFrame = 0U;
+  std::array<double, LodSettings::NUM_TIERS> m_lodElapsedTimes{};
+  std::array<IdRange, LodSettings::NUM_TIERS> m_lodTierRanges{};
+
+  std::vector<uint8_t> m_diesInPrewarm; // per particle emitted in a pre-warm step
+
+  [[nodiscard]] auto IsIdle() const noexcept -> bool;
+  auto Step(double dt) noexcept -> void;
+  auto Emit(double dt) noexcept -> void;
+  auto RunUpdaters(double dt) noexcept -> void;
+  [[nodiscard]] auto GetMaxLifetime() const noexcept -> std::optional<float>;
+  // 'remainingTime' is the pre-warm time left after this step.
+  auto SpreadPrewarmBirths(const IdRange& emitted, double dt, double remainingTime) noexcept
+      -> void;
+  [[nodiscard]] auto NeedsAccelerations() const noexcept -> bool;
+  auto ClearAccelerations() noexcept -> void;
+  auto UpdateCulled(double dt) noexcept -> void;
+  auto RunCulledUpdaters() noexcept -> void;
+  auto CatchUp() noexcept -> void;
+  auto CompleteStats() noexcept -> void;
+  auto GatherMotionStats(const IdRange& idRange) noexcept -> void;
+  auto GatherAgeStats() noexcept -> void;
+  auto ApplySleepRequests() noexcept -> void;
+  auto UpdateWithLod(double dt) noexcept -> void;
+  auto AssignLodTiers() noexcept -> void;
+  [[nodiscard]] auto IsLodTierUpToDate(uint32_t tier) const noexcept -> bool;
+  auto PartitionLodTiers() noexcept -> void;
+  [[nodiscard]] auto PartitionLodTier(uint32_t tier, const IdRange& idRange) noexcept -> size_t;
+  [[nodiscard]] auto GetLodTier(const glm::vec4& position) const noexcept -> uint32_t;
 };
 
 class IParticleGenerator;
@@ -113,16 +404,26 @@ public:
   auto SetEmitRate(float emitRate) noexcept -> void;
   auto SetMaxNumAliveParticles(size_t maxNumAliveParticles) noexcept -> void;
   auto AddGenerator(const std::shared_ptr<IParticleGenerator>& gen) noexcept -> void;
+  // Generator 'i' gets stream 'i' of the emitter's, see 'ParticleSystem::SetRandomSeed'.
+  auto SetRandomSeed(uint64_t seed, uint64_t stream) noexcept -> void;
 
   // Calls all the generators and at the end it activates (wakes) particle.
   auto Emit(double dt, ParticleData& particleData) noexcept -> void;
 
+  [[nodiscard]] auto IsIdle() const noexcept -> bool;
+  // The longest lifetime a generator gives the particles, if one sets it.
+  [[nodiscard]] auto GetMaxLifetime() const noexcept -> std::optional<float>;
+
 private:
   float m_emitRate              = 0.0F;
   size_t m_maxNumAliveParticles = std::numeric_limits<size_t>::max();
   std::vector<std::shared_ptr<IParticleGenerator>> m_generators;
+  uint64_t m_randomSeed   = Random::DEFAULT_SEED;
+  uint64_t m_randomStream = 0U;
+  double m_emitRemainder  = 0.0; // the part of a particle not yet emitted
 
-  [[nodiscard]] auto GetMaxAllowedNewParticles(double dt,
+  auto SeedGenerator(size_t index) noexcept -> void;
+  [[nodiscard]] auto GetMaxAllowedNewParticles(size_t requestedNewParticles,
                                                const ParticleData& particleData) const noexcept
       -> size_t;
 };
@@ -137,13 +438,26 @@ public:
   auto operator=(const IParticleGenerator&) -> IParticleGenerator& = delete;
   auto operator=(IParticleGenerator&&) -> IParticleGenerator&      = delete;
 
-  struct IdRange
-  {
-    size_t start;
-    size_t end;
-  };
+  using IdRange = PARTICLES::IdRange;
   virtual auto Generate(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
       -> void = 0;
+
+  // Generators that set the particles' lifetimes say the longest, so that 'Prewarm' knows
+  // which particles are dead by its end.
+  [[nodiscard]] virtual auto GetMaxLifetime() const noexcept -> std::optional<float>
+  {
+    return std::nullopt;
+  }
+
+  // Set by the emitter, see 'ParticleSystem::SetRandomSeed'.
+  auto SetRandomSeed(uint64_t seed, uint64_t stream) noexcept -> void;
+
+protected:
+  // For the generators to draw from instead of 'std::rand'.
+  [[nodiscard]] auto GetRandom() noexcept -> Random&;
+
+private:
+  Random m_random;
 };
 
 class IParticleUpdater
@@ -157,6 +471,42 @@ public:
   auto operator=(IParticleUpdater&&) -> IParticleUpdater&      = delete;
 
   virtual auto Update(double dt, ParticleData& particleData) noexcept -> void = 0;
+
+  // Whether this updater adds to, integrates or reads the accelerations, which the system
+  // clears at the start of every step. When no updater does, the clearing pass is skipped.
+  [[nodiscard]] virtual auto NeedsAccelerations() const noexcept -> bool
+  {
+    return true;
+  }
+
+  // Whether a culled system, see 'ParticleSystem::SetCulled', still runs this updater. Only for
+  // updaters that are cheap and can take a large time step, like ageing the particles.
+  [[nodiscard]] virtual auto RunsWhenCulled() const noexcept -> bool
+  {
+    return false;
+  }
+
+  // Updaters that can split their work over threads override this. Null means single threaded.
+  virtual auto SetParallel([[maybe_unused]] const std::shared_ptr<Parallel>& parallel) noexcept
+      -> void
+  {
+  }
+};
+
+// An updater that treats every particle independently, so it can be run on any sub-range
+// of the alive particles. This lets the work be spread over several frames.
+class IRangeParticleUpdater : public IParticleUpdater
+{
+public:
+  auto Update(double dt, ParticleData& particleData) noexcept -> void final;
+
+  virtual auto UpdateRange(double dt, ParticleData& particleData, const IdRange& idRange) noexcept
+      -> void = 0;
+
+  // Forces, integrators and colliders have nothing to do for sleeping particles.
+  [[nodiscard]] virtual auto SkipsSleepingParticles() const noexcept -> bool;
+  [[nodiscard]] auto GetNumParticlesToUpdate(const ParticleData& particleData) const noexcept
+      -> size_t;
 };
 
 } // namespace PARTICLES
@@ -164,9 +514,60 @@ public:
 namespace PARTICLES
 {
 
+inline auto ParticleStats::AddMotion(const glm::vec4& position, const glm::vec4& velocity) noexcept
+    -> void
+{
+  const auto speedSq = glm::dot(glm::vec3{velocity}, glm::vec3{velocity});
+
+  boundsMin  = glm::min(boundsMin, position);
+  boundsMax  = glm::max(boundsMax, position);
+  minSpeedSq = std::min(minSpeedSq, speedSq);
+  maxSpeedSq = std::max(maxSpeedSq, speedSq);
+  ++numInBounds;
+}
+
+inline auto ParticleStats::AddAge(const float age) noexcept -> void
+{
+  totalAge += static_cast<double>(age);
+  ++numAged;
+}
+
+inline auto ParticleStats::Merge(const ParticleStats& other) noexcept -> void
+{
+  boundsMin  = glm::min(boundsMin, other.boundsMin);
+  boundsMax  = glm::max(boundsMax, other.boundsMax);
+  minSpeedSq = std::min(minSpeedSq, other.minSpeedSq);
+  maxSpeedSq = std::max(maxSpeedSq, other.maxSpeedSq);
+  numInBounds += other.numInBounds;
+  totalAge += other.totalAge;
+  numAged += other.numAged;
+}
+
+inline auto ParticleStats::HasBounds() const noexcept -> bool
+{
+  return numInBounds > 0U;
+}
+
+inline auto ParticleStats::GetMinSpeed() const noexcept -> float
+{
+  return HasBounds() ? std::sqrt(minSpeedSq) : 0.0F;
+}
+
+inline auto ParticleStats::GetMaxSpeed() const noexcept -> float
+{
+  return std::sqrt(maxSpeedSq);
+}
+
+inline auto ParticleStats::GetMeanAge() const noexcept -> double
+{
+  return 0U == numAged ? 0.0 : totalAge / static_cast<double>(numAged);
+}
+
 inline auto ParticleData::Reset() noexcept -> void
 {
   m_countAlive = 0U;
+  m_countAwake = 0U;
+  m_sleepRequests.clear();
 }
 
 inline auto ParticleData::GetCount() const noexcept -> size_t
@@ -185,6 +586,59 @@ inline auto ParticleData::GetAliveCount() const noexcept -> size_t
   return m_countAlive;
 }
 
+inline auto ParticleData::GetAwakeCount() const noexcept -> size_t
+{
+  return m_countAwake;
+}
+
+inline auto ParticleData::RequestSleep(const size_t i) noexcept -> void
+{
+  m_sleepRequests.push_back(i);
+}
+
+inline auto ParticleData::HasSleepRequests() const noexcept -> bool
+{
+  return not m_sleepRequests.empty();
+}
+
+inline auto ParticleData::WakeAllSleeping() noexcept -> void
+{
+  std::fill(m_lodTier.begin() + static_cast<std::ptrdiff_t>(m_countAwake),
+            m_lodTier.begin() + static_cast<std::ptrdiff_t>(m_countAlive),
+            uint8_t{0U});
+  m_countAwake = m_countAlive;
+}
+
+inline auto ParticleData::GetIds() const noexcept -> std::span<const uint32_t>
+{
+  return m_id;
+}
+
+inline auto ParticleData::GetLodTier(const size_t i) const noexcept -> uint8_t
+{
+  return m_lodTier[i];
+}
+
+inline auto ParticleData::SetLodTier(const size_t i, const uint8_t lodTier) noexcept -> void
+{
+  m_lodTier[i] = lodTier;
+}
+
+inline auto ParticleData::GetPositions() const noexcept -> std::span<const glm::vec4>
+{
+  return m_position;
+}
+
+inline auto ParticleData::GetVelocities() const noexcept -> std::span<const glm::vec4>
+{
+  return m_velocity;
+}
+
+inline auto ParticleData::GetColors() const noexcept -> std::span<const glm::vec4>
+{
+  return m_color;
+}
+
 inline auto ParticleData::GetPosition(const size_t i) const noexcept -> const glm::vec4&
 {
   return m_position[i];
@@ -277,6 +731,116 @@ inline auto ParticleData::SetTime(const size_t i, const glm::vec4& time) noexcep
   m_time[i] = time;
 }
 
+inline auto ParticleData::SetGatherStats(const bool gatherStats) noexcept -> void
+{
+  m_gatherStats = gatherStats;
+}
+
+inline auto ParticleData::IsGatheringStats() const noexcept -> bool
+{
+  return m_gatherStats;
+}
+
+inline auto ParticleData::ResetStats() noexcept -> void
+{
+  m_stats = ParticleStats{};
+}
+
+inline auto ParticleData::MergeStats(const ParticleStats& stats) noexcept -> void
+{
+  m_stats.Merge(stats);
+}
+
+inline auto ParticleData::GetStats() const noexcept -> const ParticleStats&
+{
+  return m_stats;
+}
+
+inline auto ParticleSystem::EnableStats() noexcept -> void
+{
+  m_particles.SetGatherStats(true);
+}
+
+inline auto ParticleSystem::DisableStats() noexcept -> void
+{
+  m_particles.SetGatherStats(false);
+  m_particles.ResetStats();
+}
+
+inline auto ParticleSystem::GetStats() const noexcept -> const ParticleStats&
+{
+  return m_particles.GetStats();
+}
+
+template<VertexFormat Format>
+auto ParticleSystem::WriteVertices(const typename Format::Settings& settings,
+                                   const std::span<typename Format::Vertex> vertices) const noexcept
+    -> size_t
+{
+  const auto numParticles =
+      std::min(m_particles.GetAliveCount(), vertices.size() / Format::VERTICES_PER_PARTICLE);
+  const auto writeRange = [this, &settings, &vertices](const size_t begin, const size_t end)
+  {
+    Format::Write(m_particles,
+                  settings,
+                  {.start = begin, .end = end},
+                  vertices.subspan(begin * Format::VERTICES_PER_PARTICLE,
+                                   (end - begin) * Format::VERTICES_PER_PARTICLE));
+  };
+
+  if ((nullptr == m_parallel) or (numParticles < MIN_PARALLEL_VERTICES))
+  {
+    writeRange(0U, numParticles);
+    return numParticles;
+  }
+  m_parallel->ForLoop(numParticles,
+                      [&writeRange]([[maybe_unused]] const uint32_t chunk,
+                                    const size_t begin,
+                                    const size_t end) { writeRange(begin, end); });
+
+  return numParticles;
+}
+
+template<VertexFormat Format>
+auto ParticleSystem::WriteVertices(const typename Format::Settings& settings,
+                                   const std::span<const uint32_t> ids,
+                                   const std::span<typename Format::Vertex> vertices) const noexcept
+    -> size_t
+{
+  const auto numParticles = std::min(ids.size(), vertices.size() / Format::VERTICES_PER_PARTICLE);
+  const auto writeRange   = [this, &settings, ids, &vertices](const size_t begin, const size_t end)
+  {
+    Format::Write(m_particles,
+                  settings,
+                  ids.subspan(begin, end - begin),
+                  vertices.subspan(begin * Format::VERTICES_PER_PARTICLE,
+                                   (end - begin) * Format::VERTICES_PER_PARTICLE));
+  };
+
+  if ((nullptr == m_parallel) or (numParticles < MIN_PARALLEL_VERTICES))
+  {
+    writeRange(0U, numParticles);
+    return numParticles;
+  }
+  m_parallel->ForLoop(numParticles,
+                      [&writeRange]([[maybe_unused]] const uint32_t chunk,
+                                    const size_t begin,
+                                    const size_t end) { writeRange(begin, end); });
+
+  return numParticles;
+}
+
+inline auto ParticleSystem::SetCullSettings(const CullSettings& cullSettings) noexcept -> void
+{
+  m_cullSettings              = cullSettings;
+  m_cullSettings.updatePeriod = std::max(1U, m_cullSettings.updatePeriod);
+}
+
+inline auto ParticleSystem::IsCulled() const noexcept -> bool
+{
+  return m_culled;
+}
+
 inline auto ParticleSystem::GetNumAllParticles() const noexcept -> size_t
 {
   return m_particles.GetCount();
@@ -290,13 +854,24 @@ inline auto ParticleSystem::GetNumAliveParticles() const noexcept -> size_t
 inline auto ParticleSystem::AddEmitter(const std::shared_ptr<ParticleEmitter>& emitter) noexcept
     -> void
 {
+  emitter->SetRandomSeed(m_randomSeed, m_emitters.size());
   m_emitters.push_back(emitter);
 }
 
+inline auto ParticleSystem::GetRandomSeed() const noexcept -> uint64_t
+{
+  return m_randomSeed;
+}
+
 inline auto ParticleSystem::AddUpdater(const std::shared_ptr<IParticleUpdater>& updater) noexcept
     -> void
 {
   m_updaters.push_back(updater);
+  m_updaterMaxLodTiers.push_back(LodSettings::NUM_TIERS - 1);
+  if (nullptr != m_parallel)
+  {
+    updater->SetParallel(m_parallel);
+  }
 }
 
 inline auto ParticleSystem::ReplaceUpdater(
@@ -305,6 +880,19 @@ inline auto ParticleSystem::ReplaceUpdater(
     const std::shared_ptr<IParticleUpdater>& newUpdater) noexcept -> void
 {
   std::ranges::replace(m_updaters, oldUpdater, newUpdater);
+  if (nullptr != m_parallel)
+  {
+    newUpdater->SetParallel(m_parallel);
+  }
+}
+
+inline auto ParticleSystem::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  m_parallel = parallel;
+  for (const auto& updater : m_updaters)
+  {
+    updater->SetParallel(m_parallel);
+  }
 }
 
 inline auto ParticleSystem::GetFinalData() const noexcept -> const ParticleData&
@@ -312,6 +900,33 @@ inline auto ParticleSystem::GetFinalData() const noexcept -> const ParticleData&
   return m_particles;
 }
 
+inline auto ParticleSystem::WakeSleepingParticles() noexcept -> void
+{
+  m_particles.WakeAllSleeping();
+}
+
+inline auto ParticleSystem::GetSimulationTime() const noexcept -> double
+{
+  return m_simulationTime;
+}
+
+inline auto ParticleSystem::DisableFixedTimeStep() noexcept -> void
+{
+  m_fixedTimeStepEnabled = false;
+  m_accumulatedTime      = 0.0;
+}
+
+inline auto ParticleSystem::DisableLod() noexcept -> void
+{
+  m_lodEnabled = false;
+}
+
+inline auto ParticleSystem::GetLodTierRange(const uint32_t tier) const noexcept -> const IdRange&
+{
+  assert(tier < LodSettings::NUM_TIERS);
+  return m_lodTierRanges[tier];
+}
+
 inline auto ParticleEmitter::SetEmitRate(const float emitRate) noexcept -> void
 {
   m_emitRate = emitRate;
@@ -323,10 +938,62 @@ inline auto ParticleEmitter::SetMaxNumAliveParticles(const size_t maxNumAlivePar
   m_maxNumAliveParticles = maxNumAliveParticles;
 }
 
+inline auto ParticleEmitter::IsIdle() const noexcept -> bool
+{
+  return (m_emitRate <= 0.0F) or (0U == m_maxNumAliveParticles);
+}
+
 inline auto ParticleEmitter::AddGenerator(const std::shared_ptr<IParticleGenerator>& gen) noexcept
     -> void
 {
   m_generators.push_back(gen);
+  SeedGenerator(m_generators.size() - 1U);
+}
+
+inline auto ParticleEmitter::SetRandomSeed(const uint64_t seed, const uint64_t stream) noexcept
+    -> void
+{
+  m_randomSeed   = seed;
+  m_randomStream = stream;
+  for (auto i = size_t{0U}; i < m_generators.size(); ++i)
+  {
+    SeedGenerator(i);
+  }
+}
+
+inline auto ParticleEmitter::SeedGenerator(const size_t index) noexcept -> void
+{
+  // Room for 2^32 generators in each of 2^31 emitters' streams.
+  static constexpr auto GENERATOR_BITS = 32U;
+  m_generators[index]->SetRandomSeed(m_randomSeed, (m_randomStream << GENERATOR_BITS) + index);
+}
+
+inline auto IParticleGenerator::SetRandomSeed(const uint64_t seed, const uint64_t stream) noexcept
+    -> void
+{
+  m_random.Seed(seed, stream);
+}
+
+inline auto IParticleGenerator::GetRandom() noexcept -> Random&
+{
+  return m_random;
+}
+
+inline auto IRangeParticleUpdater::Update(const double dt, ParticleData& particleData) noexcept
+    -> void
+{
+  UpdateRange(dt, particleData, {.start = 0U, .end = GetNumParticlesToUpdate(particleData)});
+}
+
+inline auto IRangeParticleUpdater::SkipsSleepingParticles() const noexcept -> bool
+{
+  return false;
+}
+
+inline auto IRangeParticleUpdater::GetNumParticlesToUpdate(
+    const ParticleData& particleData) const noexcept -> size_t
+{
+  return SkipsSleepingParticles() ? particleData.GetAwakeCount() : particleData.GetAliveCount();
 }
 
 } // namespace PARTICLES
@@ -0,0 +1,60 @@
+module;
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+export module Particles.RadixSort;
+
+import Particles.Parallel;
+
+export namespace PARTICLES
+{
+
+// Stable least significant digit radix sort of 32 bit keys, a byte at a time. A byte that is
+// the same in every key is skipped, so narrower keys cost fewer passes. With a thread pool
+// each pass counts and scatters a chunk of the keys per thread, and the result is the same
+// for any number of threads.
+class RadixSort
+{
+public:
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+
+  // Fills 'order' with the indices of 'keys' in increasing key order, equal keys in index
+  // order.
+  auto SortIndices(std::span<const uint32_t> keys, std::vector<uint32_t>& order) noexcept
+      -> void;
+  // Reorders 'values', one per key, into increasing key order, equal keys in index order.
+  auto SortValues(std::span<const uint32_t> keys, std::vector<uint32_t>& values) noexcept
+      -> void;
+
+private:
+  static constexpr auto DIGIT_BITS = 8U;
+  static constexpr auto NUM_DIGITS = 1U << DIGIT_BITS;
+  static constexpr auto DIGIT_MASK = NUM_DIGITS - 1U;
+  static constexpr auto NUM_PASSES = 32U / DIGIT_BITS;
+  // Below this a pass is quicker on one thread than shared out.
+  static constexpr auto MIN_PARALLEL_SIZE = 16384U;
+
+  std::shared_ptr<Parallel> m_parallel;
+  std::vector<uint32_t> m_keys;
+  std::vector<uint32_t> m_scratchKeys;
+  std::vector<uint32_t> m_scratchOrder;
+  std::vector<uint32_t> m_chunkDigitCounts; // per chunk, then per digit
+
+  auto SortPass(uint32_t shift, uint32_t numChunks, std::vector<uint32_t>& order) noexcept
+      -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto RadixSort::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  m_parallel = parallel;
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,107 @@
+module;
+
+#include <cstdint>
+#include <glm/vec4.hpp>
+
+export module Particles.Random;
+
+export namespace PARTICLES
+{
+
+// A small, fast random number generator (PCG32) with its state in the object, so that
+// whatever draws from it gets the same numbers for the same seed whatever else is drawing
+// random numbers. Different streams from the same seed are independent sequences.
+class Random
+{
+public:
+  static constexpr auto DEFAULT_SEED = uint64_t{0x853C49E6748FEA9BU};
+
+  Random() noexcept;
+  Random(uint64_t seed, uint64_t stream) noexcept;
+
+  auto Seed(uint64_t seed, uint64_t stream) noexcept -> void;
+
+  [[nodiscard]] auto NextUint32() noexcept -> uint32_t;
+  // Evenly spread between 'min' and 'max'.
+  [[nodiscard]] auto Uniform(float min, float max) noexcept -> float;
+  [[nodiscard]] auto Uniform(double min, double max) noexcept -> double;
+  // Each component separately.
+  [[nodiscard]] auto Uniform(const glm::vec4& min, const glm::vec4& max) noexcept -> glm::vec4;
+
+private:
+  static constexpr auto MULTIPLIER = uint64_t{6364136223846793005U};
+  uint64_t m_state     = 0U;
+  uint64_t m_increment = 1U; // odd, and picks the stream
+
+  auto Step() noexcept -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline Random::Random() noexcept : Random{DEFAULT_SEED, 0U} {}
+
+inline Random::Random(const uint64_t seed, const uint64_t stream) noexcept
+{
+  Seed(seed, stream);
+}
+
+inline auto Random::Seed(const uint64_t seed, const uint64_t stream) noexcept -> void
+{
+  m_state     = 0U;
+  m_increment = (stream << 1U) | 1U;
+  Step();
+  m_state += seed;
+  Step();
+}
+
+inline auto Random::Step() noexcept -> void
+{
+  m_state = (m_state * MULTIPLIER) + m_increment;
+}
+
+inline auto Random::NextUint32() noexcept -> uint32_t
+{
+  static constexpr auto XOR_SHIFT      = 18U;
+  static constexpr auto OUTPUT_SHIFT   = 27U;
+  static constexpr auto ROTATION_SHIFT = 59U;
+  static constexpr auto ROTATION_MASK  = 31U;
+
+  const auto state = m_state;
+  Step();
+
+  const auto xorShifted = static_cast<uint32_t>(((state >> XOR_SHIFT) ^ state) >> OUTPUT_SHIFT);
+  const auto rotation   = static_cast<uint32_t>(state >> ROTATION_SHIFT);
+  return (xorShifted >> rotation) | (xorShifted << ((0U - rotation) & ROTATION_MASK));
+}
+
+inline auto Random::Uniform(const float min, const float max) noexcept -> float
+{
+  // The top 24 bits, as many as a float has.
+  static constexpr auto UNUSED_BITS = 8U;
+  static constexpr auto SCALE       = 1.0F / 16777216.0F; // 2^-24
+  const auto unit                   = static_cast<float>(NextUint32() >> UNUSED_BITS) * SCALE;
+  return min + ((max - min) * unit);
+}
+
+inline auto Random::Uniform(const double min, const double max) noexcept -> double
+{
+  static constexpr auto SCALE = 1.0 / 4294967296.0; // 2^-32
+  const auto unit             = static_cast<double>(NextUint32()) * SCALE;
+  return min + ((max - min) * unit);
+}
+
+inline auto Random::Uniform(const glm::vec4& min, const glm::vec4& max) noexcept -> glm::vec4
+{
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+  const auto x = Uniform(min.x, max.x);
+  const auto y = Uniform(min.y, max.y);
+  const auto z = Uniform(min.z, max.z);
+  const auto w = Uniform(min.w, max.w);
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+  return {x, y, z, w};
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,58 @@
+module;
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+export module Particles.Snapshot;
+
+import Particles.Particles;
+
+export namespace PARTICLES
+{
+
+// Snapshots save a particle system's alive particles and simulation time, to start effects
+// pre-warmed instead of running them for seconds first. The file is a header followed by the
+// streams, each on a cache line of its own, in the machine's own layout. Loading maps the file
+// and copies the streams straight out, after checking the header, with no parsing.
+//
+// Only the particles are saved. The system to restore into needs the same emitters and
+// updaters, and at least as many particles, as the one saved. Throws 'std::runtime_error' when
+// the file can't be read or written, or isn't a snapshot that fits the system.
+auto SaveSnapshot(const ParticleSystem& particleSystem, const std::filesystem::path& filename)
+    -> void;
+auto LoadSnapshot(ParticleSystem& particleSystem, const std::filesystem::path& filename) -> void;
+
+// A directory of snapshots, one per effect name and particle count, so a pre-warmed state is
+// made once and reused on later runs.
+class SnapshotCache
+{
+public:
+  explicit SnapshotCache(std::filesystem::path directory) noexcept;
+
+  [[nodiscard]] auto GetDirectory() const noexcept -> const std::filesystem::path&;
+  [[nodiscard]] auto GetPath(std::string_view name, size_t numParticles) const
+      -> std::filesystem::path;
+
+  // Returns false, and leaves the system as it was, if there is no usable snapshot.
+  [[nodiscard]] auto Restore(ParticleSystem& particleSystem, std::string_view name) const
+      -> bool;
+  // Writes to a temporary file and renames it, so other runs never see half a snapshot.
+  // Returns false if it can't.
+  auto Store(const ParticleSystem& particleSystem, std::string_view name) const -> bool;
+
+private:
+  std::filesystem::path m_directory;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto SnapshotCache::GetDirectory() const noexcept -> const std::filesystem::path&
+{
+  return m_directory;
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,269 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+export module Particles.SpatialGrid;
+
+import Particles.Parallel;
+import Particles.Particles;
+
+export namespace PARTICLES
+{
+
+// Particles binned by position into a uniform grid of cubic cells, for neighbour queries.
+// The cells are hashed into a fixed size table, so the grid has no bounds. It is rebuilt from
+// scratch every frame with a counting sort, which keeps the particles of a cell contiguous.
+class SpatialHashGrid
+{
+public:
+  // The table has 2^numSlotsLog2 slots. About one slot per particle works well.
+  SpatialHashGrid(float cellSize, uint32_t numSlotsLog2) noexcept;
+
+  auto SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void;
+
+  [[nodiscard]] auto GetCellSize() const noexcept -> float;
+  [[nodiscard]] auto GetNumSlots() const noexcept -> uint32_t;
+  [[nodiscard]] auto GetNumParticles() const noexcept -> size_t;
+
+  auto Build(const ParticleData& particleData, const IdRange& idRange) noexcept -> void;
+
+  // All the binned particles in slot order. Running queries in this order, rather than by
+  // particle id, keeps neighbouring queries on the same few slots and so in cache.
+  [[nodiscard]] auto GetSortedIds() const noexcept -> std::span<const uint32_t>;
+  [[nodiscard]] auto GetSortedPositions() const noexcept -> std::span<const glm::vec4>;
+
+  [[nodiscard]] auto GetSlot(const glm::vec4& position) const noexcept -> uint32_t;
+  // The particles binned in a slot. A slot can hold particles from more than one cell.
+  [[nodiscard]] auto GetSlotParticles(uint32_t slot) const noexcept -> std::span<const uint32_t>;
+  [[nodiscard]] auto GetSlotPositions(uint32_t slot) const noexcept
+      -> std::span<const glm::vec4>;
+
+  // Calls 'func(particleId, offset, distSq)' for each binned particle within 'radius' of
+  // 'position', where 'offset' is from 'position' to the particle. Stops early if 'func'
+  // returns false. The radius can be at most MAX_QUERY_RADIUS_IN_CELLS cells.
+  static constexpr auto MAX_QUERY_RADIUS_IN_CELLS = 2.0F;
+  template<typename Func>
+  auto ForEachInRadius(const glm::vec4& position, float radius, Func&& func) const noexcept
+      -> void;
+
+private:
+  float m_cellSize;
+  float m_invCellSize = 1.0F / m_cellSize;
+  uint32_t m_numSlotsLog2;
+  uint32_t m_numSlots = 1U << m_numSlotsLog2;
+  std::shared_ptr<Parallel> m_parallel;
+
+  // Binned particle ids and a copy of their positions, sorted by slot, so a neighbour search
+  // reads contiguous memory. Slot 's' is [m_slotStarts[s], m_slotStarts[s + 1]).
+  std::vector<uint32_t> m_slotStarts;
+  std::vector<uint32_t> m_sortedIds;
+  std::vector<glm::vec4> m_sortedPositions;
+
+  std::vector<uint32_t> m_particleSlots;
+  std::vector<uint32_t> m_chunkSlotCounts; // per chunk histograms, then scatter offsets
+  [[nodiscard]] auto GetChunkSlotCounts(uint32_t chunk) noexcept -> std::span<uint32_t>;
+
+  struct Cell
+  {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+  };
+  [[nodiscard]] auto GetCell(const glm::vec4& position) const noexcept -> Cell;
+  [[nodiscard]] auto GetSlot(const Cell& cell) const noexcept -> uint32_t;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline SpatialHashGrid::SpatialHashGrid(const float cellSize, const uint32_t numSlotsLog2) noexcept
+  : m_cellSize{cellSize}, m_numSlotsLog2{numSlotsLog2}, m_slotStarts(m_numSlots + 1, 0U)
+{
+  assert(cellSize > 0.0F);
+  assert((numSlotsLog2 > 0U) and (numSlotsLog2 < 32U));
+}
+
+inline auto SpatialHashGrid::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept
+    -> void
+{
+  m_parallel = parallel;
+}
+
+inline auto SpatialHashGrid::GetCellSize() const noexcept -> float
+{
+  return m_cellSize;
+}
+
+inline auto SpatialHashGrid::GetNumSlots() const noexcept -> uint32_t
+{
+  return m_numSlots;
+}
+
+inline auto SpatialHashGrid::GetNumParticles() const noexcept -> size_t
+{
+  return m_sortedIds.size();
+}
+
+inline auto SpatialHashGrid::GetSortedIds() const noexcept -> std::span<const uint32_t>
+{
+  return m_sortedIds;
+}
+
+inline auto SpatialHashGrid::GetSortedPositions() const noexcept -> std::span<const glm::vec4>
+{
+  return m_sortedPositions;
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+inline auto SpatialHashGrid::GetCell(const glm::vec4& position) const noexcept -> Cell
+{
+  // 'std::floor' is a library call without SSE4.1 and this is the hot part of a build.
+  const auto floorToInt = [](const float value)
+  {
+    const auto truncated = static_cast<int32_t>(value);
+    return truncated - static_cast<int32_t>(value < static_cast<float>(truncated));
+  };
+
+  return {floorToInt(position.x * m_invCellSize),
+          floorToInt(position.y * m_invCellSize),
+          floorToInt(position.z * m_invCellSize)};
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+inline auto SpatialHashGrid::GetSlot(const Cell& cell) const noexcept -> uint32_t
+{
+  static constexpr auto PRIME_Y = 19349663U;
+  static constexpr auto PRIME_Z = 83492791U;
+  static constexpr auto MIX     = 0x9E3779B1U;
+
+  // Only the row is hashed. Cells along x stay in consecutive slots, so a query touches a few
+  // runs of slots rather than a scattered slot per cell.
+  const auto rowHash =
+      ((static_cast<uint32_t>(cell.y) * PRIME_Y) ^ (static_cast<uint32_t>(cell.z) * PRIME_Z)) *
+      MIX;
+
+  return (rowHash + static_cast<uint32_t>(cell.x)) & (m_numSlots - 1U);
+}
+
+inline auto SpatialHashGrid::GetSlot(const glm::vec4& position) const noexcept -> uint32_t
+{
+  return GetSlot(GetCell(position));
+}
+
+inline auto SpatialHashGrid::GetSlotParticles(const uint32_t slot) const noexcept
+    -> std::span<const uint32_t>
+{
+  return std::span{m_sortedIds}.subspan(m_slotStarts[slot],
+                                        m_slotStarts[slot + 1] - m_slotStarts[slot]);
+}
+
+inline auto SpatialHashGrid::GetSlotPositions(const uint32_t slot) const noexcept
+    -> std::span<const glm::vec4>
+{
+  return std::span{m_sortedPositions}.subspan(m_slotStarts[slot],
+                                              m_slotStarts[slot + 1] - m_slotStarts[slot]);
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+template<typename Func>
+auto SpatialHashGrid::ForEachInRadius(const glm::vec4& position,
+                                      const float radius,
+                                      Func&& func) const noexcept -> void
+{
+  assert(radius <= (MAX_QUERY_RADIUS_IN_CELLS * m_cellSize));
+
+  // One extra cell per axis in case the rounding of the query bounds goes against us.
+  static constexpr auto MAX_CELLS_PER_AXIS =
+      (2U * static_cast<uint32_t>(MAX_QUERY_RADIUS_IN_CELLS)) + 2U;
+  static constexpr auto MAX_QUERY_ROWS = MAX_CELLS_PER_AXIS * MAX_CELLS_PER_AXIS;
+
+  const auto radiusVec = glm::vec4{radius, radius, radius, 0.0F};
+  const auto minCell   = GetCell(position - radiusVec);
+  const auto maxCell   = GetCell(position + radiusVec);
+  const auto radiusSq  = radius * radius;
+  const auto rowLength = static_cast<uint32_t>(maxCell.x - minCell.x) + 1U;
+  const auto slotMask  = m_numSlots - 1U;
+
+  const auto visitParticles = [this, &position, radiusSq, &func](const uint32_t start,
+                                                                 const uint32_t end)
+  {
+    for (auto i = start; i < end; ++i)
+    {
+      const auto& otherPosition = m_sortedPositions[i];
+      const auto offset         = glm::vec4{otherPosition.x - position.x,
+                                    otherPosition.y - position.y,
+                                    otherPosition.z - position.z,
+                                    0.0F};
+      const auto distSq = (offset.x * offset.x) + (offset.y * offset.y) + (offset.z * offset.z);
+      if ((distSq <= radiusSq) and (not func(m_sortedIds[i], offset, distSq)))
+      {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Each row of cells along x is a run of consecutive slots, so normally a whole row is one
+  // run of particles. Different rows can hash onto overlapping slots though, and a slot must
+  // only be searched once.
+  auto rowStarts = std::array<uint32_t, MAX_QUERY_ROWS>{};
+  auto numRows   = 0U;
+
+  const auto isInEarlierRow = [&rowStarts, &numRows, rowLength, slotMask](const uint32_t slot)
+  {
+    return std::any_of(rowStarts.cbegin(),
+                       rowStarts.cbegin() + numRows,
+                       [slot, rowLength, slotMask](const uint32_t rowStart)
+                       { return ((slot - rowStart) & slotMask) < rowLength; });
+  };
+
+  for (auto z = minCell.z; z <= maxCell.z; ++z)
+  {
+    for (auto y = minCell.y; y <= maxCell.y; ++y)
+    {
+      const auto rowStart = GetSlot(Cell{minCell.x, y, z});
+      const auto rowEnd   = rowStart + rowLength;
+
+      const auto overlapsEarlierRow =
+          isInEarlierRow(rowStart) or isInEarlierRow((rowEnd - 1U) & slotMask);
+      if ((not overlapsEarlierRow) and (rowEnd <= m_numSlots))
+      {
+        if (not visitParticles(m_slotStarts[rowStart], m_slotStarts[rowEnd]))
+        {
+          return;
+        }
+      }
+      else
+      {
+        for (auto slot = rowStart; slot != rowEnd; ++slot)
+        {
+          const auto wrappedSlot = slot & slotMask;
+          if ((not isInEarlierRow(wrappedSlot)) and
+              (not visitParticles(m_slotStarts[wrappedSlot], m_slotStarts[wrappedSlot + 1])))
+          {
+            return;
+          }
+        }
+      }
+
+      rowStarts.at(numRows) = rowStart;
+      ++numRows;
+    }
+  }
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
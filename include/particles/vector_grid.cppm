@@ -0,0 +1,253 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/vec4.hpp>
+#include <string>
+#include <vector>
+
+export module Particles.VectorGrid;
+
+export namespace PARTICLES
+{
+
+// Vectors sampled at the points of a regular grid spanning a box, with trilinear
+// interpolation in between. There are 'resolution' points along each axis, so
+// 'resolution - 1' cells.
+// The points are stored in 4x4x4 bricks, so the 8 corners of a cell are nearly always in the
+// same one or two kilobytes, and particles close together sample close together in memory.
+class VectorGrid
+{
+public:
+  VectorGrid(const glm::vec4& boundsMin, const glm::vec4& boundsMax, uint32_t resolution);
+
+  // A simple binary format: a header with the resolution, bounds and version, then the value
+  // of every point, x fastest. Throws 'std::runtime_error' on failure.
+  [[nodiscard]] static auto LoadFromFile(const std::string& filename) -> VectorGrid;
+  auto SaveToFile(const std::string& filename) const -> void;
+
+  [[nodiscard]] auto GetResolution() const noexcept -> uint32_t;
+  [[nodiscard]] auto GetBoundsMin() const noexcept -> const glm::vec4&;
+  [[nodiscard]] auto GetBoundsMax() const noexcept -> const glm::vec4&;
+  [[nodiscard]] auto GetNumCells() const noexcept -> size_t;
+
+  // Saved with the grid, for callers to tell apart grids made from different sources. 0 by
+  // default.
+  auto SetVersion(uint64_t version) noexcept -> void;
+  [[nodiscard]] auto GetVersion() const noexcept -> uint64_t;
+
+  [[nodiscard]] auto GetPointPosition(uint32_t x, uint32_t y, uint32_t z) const noexcept
+      -> glm::vec4;
+  [[nodiscard]] auto GetValue(uint32_t x, uint32_t y, uint32_t z) const noexcept
+      -> const glm::vec4&;
+  auto SetValue(uint32_t x, uint32_t y, uint32_t z, const glm::vec4& value) noexcept -> void;
+
+  [[nodiscard]] auto IsInside(const glm::vec4& position) const noexcept -> bool;
+  // Only valid for positions inside the bounds.
+  [[nodiscard]] auto GetCellIndex(const glm::vec4& position) const noexcept -> size_t;
+  // Positions outside the bounds get the value at the nearest boundary.
+  [[nodiscard]] auto Sample(const glm::vec4& position) const noexcept -> glm::vec4;
+
+  // The cell a position is in and where in the cell, for when a caller wants to look at the
+  // cell before sampling without working it out twice.
+  struct Location
+  {
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+    glm::vec4 fraction;
+  };
+  [[nodiscard]] auto GetLocation(const glm::vec4& position) const noexcept -> Location;
+  [[nodiscard]] auto GetCellIndex(const Location& location) const noexcept -> size_t;
+  [[nodiscard]] auto Sample(const Location& location) const noexcept -> glm::vec4;
+
+private:
+  glm::vec4 m_boundsMin;
+  glm::vec4 m_boundsMax;
+  uint32_t m_resolution;
+  glm::vec4 m_pointsPerUnit;
+  uint64_t m_version = 0U;
+
+  static constexpr auto BRICK_SIZE_LOG2 = 2U;
+  static constexpr auto BRICK_SIZE      = 1U << BRICK_SIZE_LOG2;
+  static constexpr auto BRICK_VOLUME    = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+  size_t m_bricksPerAxis = (m_resolution + BRICK_SIZE - 1) / BRICK_SIZE;
+  std::vector<glm::vec4> m_values;
+
+  // A point's index is the sum of a separate offset for each coordinate.
+  [[nodiscard]] auto GetXOffset(uint32_t x) const noexcept -> size_t;
+  [[nodiscard]] auto GetYOffset(uint32_t y) const noexcept -> size_t;
+  [[nodiscard]] auto GetZOffset(uint32_t z) const noexcept -> size_t;
+  [[nodiscard]] auto GetPointIndex(uint32_t x, uint32_t y, uint32_t z) const noexcept -> size_t;
+};
+
+struct CurlNoiseSettings
+{
+  float frequency = 1.0F; // noise features per unit
+  float amplitude = 1.0F;
+  uint32_t seed   = 0U;
+};
+
+// Divergence free turbulence - the curl of a 3D Perlin noise potential - so particles swirl
+// without bunching up or spreading out.
+[[nodiscard]] auto MakeCurlNoiseGrid(const glm::vec4& boundsMin,
+                                     const glm::vec4& boundsMax,
+                                     uint32_t resolution,
+                                     const CurlNoiseSettings& settings) -> VectorGrid;
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+inline auto VectorGrid::GetResolution() const noexcept -> uint32_t
+{
+  return m_resolution;
+}
+
+inline auto VectorGrid::GetBoundsMin() const noexcept -> const glm::vec4&
+{
+  return m_boundsMin;
+}
+
+inline auto VectorGrid::GetBoundsMax() const noexcept -> const glm::vec4&
+{
+  return m_boundsMax;
+}
+
+inline auto VectorGrid::SetVersion(const uint64_t version) noexcept -> void
+{
+  m_version = version;
+}
+
+inline auto VectorGrid::GetVersion() const noexcept -> uint64_t
+{
+  return m_version;
+}
+
+inline auto VectorGrid::GetNumCells() const noexcept -> size_t
+{
+  const auto cellsPerAxis = static_cast<size_t>(m_resolution - 1);
+  return cellsPerAxis * cellsPerAxis * cellsPerAxis;
+}
+
+inline auto VectorGrid::GetXOffset(const uint32_t x) const noexcept -> size_t
+{
+  return (static_cast<size_t>(x >> BRICK_SIZE_LOG2) * BRICK_VOLUME) + (x & (BRICK_SIZE - 1));
+}
+
+inline auto VectorGrid::GetYOffset(const uint32_t y) const noexcept -> size_t
+{
+  return (static_cast<size_t>(y >> BRICK_SIZE_LOG2) * BRICK_VOLUME * m_bricksPerAxis) +
+         ((y & (BRICK_SIZE - 1)) * BRICK_SIZE);
+}
+
+inline auto VectorGrid::GetZOffset(const uint32_t z) const noexcept -> size_t
+{
+  return (static_cast<size_t>(z >> BRICK_SIZE_LOG2) * BRICK_VOLUME * m_bricksPerAxis *
+          m_bricksPerAxis) +
+         ((z & (BRICK_SIZE - 1)) * BRICK_SIZE * BRICK_SIZE);
+}
+
+inline auto VectorGrid::GetPointIndex(const uint32_t x,
+                                      const uint32_t y,
+                                      const uint32_t z) const noexcept -> size_t
+{
+  assert((x < m_resolution) and (y < m_resolution) and (z < m_resolution));
+
+  return GetXOffset(x) + GetYOffset(y) + GetZOffset(z);
+}
+
+inline auto VectorGrid::GetValue(const uint32_t x,
+                                 const uint32_t y,
+                                 const uint32_t z) const noexcept -> const glm::vec4&
+{
+  return m_values[GetPointIndex(x, y, z)];
+}
+
+inline auto VectorGrid::SetValue(const uint32_t x,
+                                 const uint32_t y,
+                                 const uint32_t z,
+                                 const glm::vec4& value) noexcept -> void
+{
+  m_values[GetPointIndex(x, y, z)] = value;
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+inline auto VectorGrid::IsInside(const glm::vec4& position) const noexcept -> bool
+{
+  return (position.x >= m_boundsMin.x) and (position.x < m_boundsMax.x) and
+         (position.y >= m_boundsMin.y) and (position.y < m_boundsMax.y) and
+         (position.z >= m_boundsMin.z) and (position.z < m_boundsMax.z);
+}
+
+inline auto VectorGrid::GetLocation(const glm::vec4& position) const noexcept -> Location
+{
+  const auto maxGridPosition = static_cast<float>(m_resolution - 1);
+  const auto gridPosition    = glm::clamp(
+      (position - m_boundsMin) * m_pointsPerUnit, glm::vec4{0.0F}, glm::vec4{maxGridPosition});
+
+  const auto maxCell = m_resolution - 2U;
+  const auto x       = std::min(maxCell, static_cast<uint32_t>(gridPosition.x));
+  const auto y       = std::min(maxCell, static_cast<uint32_t>(gridPosition.y));
+  const auto z       = std::min(maxCell, static_cast<uint32_t>(gridPosition.z));
+
+  return {.x        = x,
+          .y        = y,
+          .z        = z,
+          .fraction = gridPosition - glm::vec4{static_cast<float>(x),
+                                               static_cast<float>(y),
+                                               static_cast<float>(z),
+                                               gridPosition.w}};
+}
+
+inline auto VectorGrid::GetCellIndex(const Location& location) const noexcept -> size_t
+{
+  const auto cellsPerAxis = static_cast<size_t>(m_resolution - 1);
+  return location.x + (cellsPerAxis * (location.y + (cellsPerAxis * location.z)));
+}
+
+inline auto VectorGrid::GetCellIndex(const glm::vec4& position) const noexcept -> size_t
+{
+  return GetCellIndex(GetLocation(position));
+}
+
+// The vec4 mixes are plain 4 lane arithmetic, which the compiler turns into SIMD.
+inline auto VectorGrid::Sample(const Location& location) const noexcept -> glm::vec4
+{
+  const auto x0 = GetXOffset(location.x);
+  const auto x1 = GetXOffset(location.x + 1);
+  const auto y0 = GetYOffset(location.y);
+  const auto y1 = GetYOffset(location.y + 1);
+  const auto z0 = GetZOffset(location.z);
+  const auto z1 = GetZOffset(location.z + 1);
+
+  const auto& v000 = m_values[x0 + y0 + z0];
+  const auto& v100 = m_values[x1 + y0 + z0];
+  const auto& v010 = m_values[x0 + y1 + z0];
+  const auto& v110 = m_values[x1 + y1 + z0];
+  const auto& v001 = m_values[x0 + y0 + z1];
+  const auto& v101 = m_values[x1 + y0 + z1];
+  const auto& v011 = m_values[x0 + y1 + z1];
+  const auto& v111 = m_values[x1 + y1 + z1];
+
+  const auto& t  = location.fraction;
+  const auto v00 = glm::mix(v000, v100, t.x);
+  const auto v10 = glm::mix(v010, v110, t.x);
+  const auto v01 = glm::mix(v001, v101, t.x);
+  const auto v11 = glm::mix(v011, v111, t.x);
+
+  return glm::mix(glm::mix(v00, v10, t.y), glm::mix(v01, v11, t.y), t.z);
+}
+
+inline auto VectorGrid::Sample(const glm::vec4& position) const noexcept -> glm::vec4
+{
+  return Sample(GetLocation(position));
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,130 @@
+module;
+
+#include <array>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+
+export module Particles.VertexFormats;
+
+import Particles.Particles;
+
+export namespace PARTICLES
+{
+
+// Vertex layouts for 'ParticleSystem::WriteVertices'. Each format names its 'Vertex' record,
+// the 'Settings' it needs from the caller, how many vertices a particle takes and a 'Write'
+// that fills the vertices for a range of particles, or for a list of them, in order, with
+// whole records, as mapped GPU memory likes.
+
+// RGBA8 with red in the lowest byte, the order GL_RGBA with GL_UNSIGNED_BYTE reads on little
+// endian machines. Components are clamped to [0, 1].
+[[nodiscard]] auto PackColor(const glm::vec4& color) noexcept -> uint32_t;
+
+// A point sprite per particle.
+struct PositionColorFormat
+{
+  struct Vertex
+  {
+    glm::vec3 position;
+    uint32_t color;
+  };
+  struct Settings
+  {
+  };
+  static constexpr auto VERTICES_PER_PARTICLE = 1U;
+
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    const IdRange& idRange,
+                    std::span<Vertex> vertices) noexcept -> void;
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    std::span<const uint32_t> ids,
+                    std::span<Vertex> vertices) noexcept -> void;
+};
+
+// As 'PositionColorFormat' in 12 bytes instead of 16. Each coordinate is a 16 bit fraction of
+// the way across the bounds - the system's stats bounds, see 'ParticleSystem::GetStats', fit.
+// The shader gets the position back with 'boundsMin + (position / 65535) * (boundsMax -
+// boundsMin)', or with a normalized attribute. Positions outside the bounds are clamped.
+struct QuantizedPositionColorFormat
+{
+  struct Vertex
+  {
+    std::array<uint16_t, 4> position; // the last one is padding
+    uint32_t color;
+  };
+  struct Settings
+  {
+    glm::vec4 boundsMin;
+    glm::vec4 boundsMax;
+  };
+  static constexpr auto VERTICES_PER_PARTICLE = 1U;
+
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    const IdRange& idRange,
+                    std::span<Vertex> vertices) noexcept -> void;
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    std::span<const uint32_t> ids,
+                    std::span<Vertex> vertices) noexcept -> void;
+};
+
+// The four corners of a camera facing square per particle, for drivers without point sprites.
+// The corners go around from bottom left, so indices 0, 1, 2 and 0, 2, 3 make the two
+// triangles.
+struct QuadCornerFormat
+{
+  using Vertex = PositionColorFormat::Vertex;
+  struct Settings
+  {
+    glm::vec4 cameraRight; // unit vectors, in world space
+    glm::vec4 cameraUp;
+    float halfSize;
+  };
+  static constexpr auto VERTICES_PER_PARTICLE = 4U;
+
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    const IdRange& idRange,
+                    std::span<Vertex> vertices) noexcept -> void;
+  static auto Write(const ParticleData& particleData,
+                    const Settings& settings,
+                    std::span<const uint32_t> ids,
+                    std::span<Vertex> vertices) noexcept -> void;
+};
+
+} // namespace PARTICLES
+
+namespace PARTICLES
+{
+
+static_assert(16U == sizeof(PositionColorFormat::Vertex));
+static_assert(12U == sizeof(QuantizedPositionColorFormat::Vertex));
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+inline auto PackColor(const glm::vec4& color) noexcept -> uint32_t
+{
+  static constexpr auto MAX_CHANNEL = 255.0F;
+  static constexpr auto RED_SHIFT   = 0U;
+  static constexpr auto GREEN_SHIFT = 8U;
+  static constexpr auto BLUE_SHIFT  = 16U;
+  static constexpr auto ALPHA_SHIFT = 24U;
+
+  // Adding a half and truncating rounds, as the values are never negative.
+  const auto channels = (glm::clamp(color, 0.0F, 1.0F) * MAX_CHANNEL) + 0.5F;
+
+  return (static_cast<uint32_t>(channels.r) << RED_SHIFT) |
+         (static_cast<uint32_t>(channels.g) << GREEN_SHIFT) |
+         (static_cast<uint32_t>(channels.b) << BLUE_SHIFT) |
+         (static_cast<uint32_t>(channels.a) << ALPHA_SHIFT);
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,222 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+module Particles.AttractorOctree;
+
+namespace PARTICLES
+{
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+namespace
+{
+
+[[nodiscard]] auto GetAttractorAcceleration(const glm::vec4& position,
+                                            const glm::vec4& attractor) noexcept -> glm::vec4
+{
+  const auto offset = glm::vec4{
+      attractor.x - position.x, attractor.y - position.y, attractor.z - position.z, 0.0F};
+  const auto distSq = glm::dot(offset, offset);
+
+  return offset * (attractor.w / distSq);
+}
+
+[[nodiscard]] auto GetOctant(const glm::vec4& point, const glm::vec4& boxCentre) noexcept
+    -> uint32_t
+{
+  return (point.x < boxCentre.x ? 0U : 1U) + (point.y < boxCentre.y ? 0U : 2U) +
+         (point.z < boxCentre.z ? 0U : 4U);
+}
+
+} // namespace
+
+auto AttractorOctree::Build(const std::span<const glm::vec4> attractors) noexcept -> void
+{
+  m_attractors.assign(attractors.begin(), attractors.end());
+  m_nodes.clear();
+  if (m_attractors.empty())
+  {
+    return;
+  }
+
+  auto boxMin = glm::vec4{m_attractors.front()};
+  auto boxMax = glm::vec4{m_attractors.front()};
+  for (const auto& attractor : m_attractors)
+  {
+    boxMin = glm::min(boxMin, attractor);
+    boxMax = glm::max(boxMax, attractor);
+  }
+  const auto extent   = boxMax - boxMin;
+  const auto halfSize = 0.5F * std::max({extent.x, extent.y, extent.z});
+  auto boxCentre      = 0.5F * (boxMin + boxMax);
+  boxCentre.w         = 0.0F;
+
+  m_nodes.emplace_back();
+  BuildNode(0U, 0U, static_cast<uint32_t>(m_attractors.size()), boxCentre, halfSize, 0U);
+}
+
+auto AttractorOctree::BuildNode(const uint32_t nodeIndex,
+                                const uint32_t firstAttractor,
+                                const uint32_t numAttractors,
+                                const glm::vec4& boxCentre,
+                                const float halfSize,
+                                const uint32_t depth) noexcept -> void
+{
+  const auto nodeAttractors = std::span{m_attractors}.subspan(firstAttractor, numAttractors);
+
+  // The centre is weighted by the magnitude of the strengths, so that repelling attractors
+  // (negative strength) don't drag it outside the node.
+  auto weightedSum = glm::vec4{0.0F};
+  auto sumWeights  = 0.0F;
+  auto sumStrength = 0.0F;
+  for (const auto& attractor : nodeAttractors)
+  {
+    const auto weight = std::abs(attractor.w);
+    weightedSum += weight * glm::vec4{attractor.x, attractor.y, attractor.z, 0.0F};
+    sumWeights += weight;
+    sumStrength += attractor.w;
+  }
+  auto centre = sumWeights > 0.0F ? weightedSum / sumWeights : boxCentre;
+  centre.w    = sumStrength;
+
+  m_nodes[nodeIndex] = Node{.centre         = centre,
+                            .size           = 2.0F * halfSize,
+                            .firstChild     = 0U,
+                            .numChildren    = 0U,
+                            .firstAttractor = firstAttractor,
+                            .numAttractors  = numAttractors};
+
+  if ((numAttractors <= MAX_LEAF_SIZE) or (depth == MAX_DEPTH))
+  {
+    return;
+  }
+
+  static constexpr auto NUM_OCTANTS = 8U;
+  std::ranges::sort(nodeAttractors,
+                    [&boxCentre](const glm::vec4& lhs, const glm::vec4& rhs)
+                    { return GetOctant(lhs, boxCentre) < GetOctant(rhs, boxCentre); });
+
+  auto octantCounts = std::array<uint32_t, NUM_OCTANTS>{};
+  for (const auto& attractor : nodeAttractors)
+  {
+    ++octantCounts.at(GetOctant(attractor, boxCentre));
+  }
+
+  // The children are allocated together so they can be found from 'firstChild'.
+  const auto numChildren = static_cast<uint32_t>(
+      std::ranges::count_if(octantCounts, [](const auto count) { return count > 0U; }));
+  const auto firstChild  = static_cast<uint32_t>(m_nodes.size());
+
+  m_nodes[nodeIndex].firstChild  = firstChild;
+  m_nodes[nodeIndex].numChildren = numChildren;
+  m_nodes.resize(m_nodes.size() + numChildren);
+
+  const auto childHalfSize = 0.5F * halfSize;
+  auto childIndex          = firstChild;
+  auto childFirstAttractor = firstAttractor;
+  for (auto octant = 0U; octant < NUM_OCTANTS; ++octant)
+  {
+    const auto count = octantCounts.at(octant);
+    if (0U == count)
+    {
+      continue;
+    }
+
+    const auto childCentre =
+        boxCentre + glm::vec4{(octant & 1U) != 0U ? childHalfSize : -childHalfSize,
+                              (octant & 2U) != 0U ? childHalfSize : -childHalfSize,
+                              (octant & 4U) != 0U ? childHalfSize : -childHalfSize,
+                              0.0F};
+    BuildNode(childIndex, childFirstAttractor, count, childCentre, childHalfSize, depth + 1);
+
+    ++childIndex;
+    childFirstAttractor += count;
+  }
+}
+
+auto AttractorOctree::GetAcceleration(const glm::vec4& position,
+                                      const float openingAngle) const noexcept -> glm::vec4
+{
+  auto acceleration = glm::vec4{0.0F};
+  if (m_nodes.empty())
+  {
+    return acceleration;
+  }
+
+  static constexpr auto MAX_STACK_SIZE = (7U * MAX_DEPTH) + 8U;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init): only the used part is read
+  std::array<uint32_t, MAX_STACK_SIZE> nodeStack;
+  nodeStack[0]   = 0U;
+  auto stackSize = 1U;
+
+  const auto openingAngleSq = openingAngle * openingAngle;
+
+  while (stackSize > 0U)
+  {
+    --stackSize;
+    const auto& node = m_nodes[nodeStack[stackSize]];
+
+    const auto offset = glm::vec4{node.centre.x - position.x,
+                                  node.centre.y - position.y,
+                                  node.centre.z - position.z,
+                                  0.0F};
+    const auto distSq = glm::dot(offset, offset);
+    if ((node.size * node.size) < (openingAngleSq * distSq))
+    {
+      acceleration += offset * (node.centre.w / distSq);
+      continue;
+    }
+
+    if (0U == node.numChildren)
+    {
+      // Written out rather than calling 'GetAttractorAcceleration', which GCC won't inline
+      // here, and this loop is most of the work.
+      for (auto i = node.firstAttractor; i < node.firstAttractor + node.numAttractors; ++i)
+      {
+        const auto& attractor      = m_attractors[i];
+        const auto attractorOffset = glm::vec4{attractor.x - position.x,
+                                               attractor.y - position.y,
+                                               attractor.z - position.z,
+                                               0.0F};
+        const auto attractorDistSq = glm::dot(attractorOffset, attractorOffset);
+
+        acceleration += attractorOffset * (attractor.w / attractorDistSq);
+      }
+      continue;
+    }
+
+    for (auto child = node.firstChild; child < node.firstChild + node.numChildren; ++child)
+    {
+      nodeStack[stackSize] = child;
+      ++stackSize;
+    }
+  }
+
+  return acceleration;
+}
+
+auto AttractorOctree::GetExactAcceleration(const glm::vec4& position,
+                                           const std::span<const glm::vec4> attractors) noexcept
+    -> glm::vec4
+{
+  auto acceleration = glm::vec4{0.0F};
+  for (const auto& attractor : attractors)
+  {
+    acceleration += GetAttractorAcceleration(position, attractor);
+  }
+
+  return acceleration;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,367 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+module Particles.Colliders;
+
+namespace PARTICLES
+{
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+namespace
+{
+
+// For a point exactly at a sphere's centre or on a capsule's segment, where any way out will do.
+constexpr auto FALLBACK_NORMAL = glm::vec4{0.0F, 1.0F, 0.0F, 0.0F};
+
+[[nodiscard]] auto NormaliseOrFallback(const glm::vec3& vec) noexcept -> glm::vec4
+{
+  const auto length = glm::length(vec);
+  if (length <= 0.0F)
+  {
+    return FALLBACK_NORMAL;
+  }
+  return glm::vec4{vec / length, 0.0F};
+}
+
+} // namespace
+
+auto ColliderSet::AddPlane(const PlaneCollider& plane) noexcept -> void
+{
+  const auto normal = glm::normalize(glm::vec3{plane.normal});
+
+  m_planes.normalX.push_back(normal.x);
+  m_planes.normalY.push_back(normal.y);
+  m_planes.normalZ.push_back(normal.z);
+  m_planes.offset.push_back(glm::dot(normal, glm::vec3{plane.point}));
+}
+
+auto ColliderSet::AddSphere(const SphereCollider& sphere) noexcept -> void
+{
+  m_spheres.centreX.push_back(sphere.centre.x);
+  m_spheres.centreY.push_back(sphere.centre.y);
+  m_spheres.centreZ.push_back(sphere.centre.z);
+  m_spheres.radius.push_back(sphere.radius);
+
+  m_sphereBounds.push_back({.min = sphere.centre - sphere.radius,
+                            .max = sphere.centre + sphere.radius});
+  BuildGrid();
+}
+
+auto ColliderSet::AddBox(const BoxCollider& box) noexcept -> void
+{
+  const auto axisX = glm::normalize(box.orientation[0]);
+  const auto axisY = glm::normalize(box.orientation[1]);
+  const auto axisZ = glm::normalize(box.orientation[2]);
+
+  m_boxes.centreX.push_back(box.centre.x);
+  m_boxes.centreY.push_back(box.centre.y);
+  m_boxes.centreZ.push_back(box.centre.z);
+  m_boxes.halfExtentX.push_back(box.halfExtents.x);
+  m_boxes.halfExtentY.push_back(box.halfExtents.y);
+  m_boxes.halfExtentZ.push_back(box.halfExtents.z);
+  m_boxes.axisXx.push_back(axisX.x);
+  m_boxes.axisXy.push_back(axisX.y);
+  m_boxes.axisXz.push_back(axisX.z);
+  m_boxes.axisYx.push_back(axisY.x);
+  m_boxes.axisYy.push_back(axisY.y);
+  m_boxes.axisYz.push_back(axisY.z);
+  m_boxes.axisZx.push_back(axisZ.x);
+  m_boxes.axisZy.push_back(axisZ.y);
+  m_boxes.axisZz.push_back(axisZ.z);
+
+  const auto extent = (glm::abs(axisX) * box.halfExtents.x) +
+                      (glm::abs(axisY) * box.halfExtents.y) +
+                      (glm::abs(axisZ) * box.halfExtents.z);
+  m_boxBounds.push_back({.min = box.centre - glm::vec4{extent, 0.0F},
+                         .max = box.centre + glm::vec4{extent, 0.0F}});
+  BuildGrid();
+}
+
+auto ColliderSet::AddCapsule(const CapsuleCollider& capsule) noexcept -> void
+{
+  const auto axis     = glm::vec3{capsule.end - capsule.start};
+  const auto lengthSq = glm::dot(axis, axis);
+
+  m_capsules.startX.push_back(capsule.start.x);
+  m_capsules.startY.push_back(capsule.start.y);
+  m_capsules.startZ.push_back(capsule.start.z);
+  m_capsules.axisX.push_back(axis.x);
+  m_capsules.axisY.push_back(axis.y);
+  m_capsules.axisZ.push_back(axis.z);
+  // A zero length capsule is a sphere.
+  m_capsules.invAxisLengthSq.push_back(lengthSq > 0.0F ? 1.0F / lengthSq : 0.0F);
+  m_capsules.radius.push_back(capsule.radius);
+
+  m_capsuleBounds.push_back({.min = glm::min(capsule.start, capsule.end) - capsule.radius,
+                             .max = glm::max(capsule.start, capsule.end) + capsule.radius});
+  BuildGrid();
+}
+
+auto ColliderSet::Clear() noexcept -> void
+{
+  m_planes   = Planes{};
+  m_spheres  = Spheres{};
+  m_boxes    = Boxes{};
+  m_capsules = Capsules{};
+
+  m_sphereBounds.clear();
+  m_boxBounds.clear();
+  m_capsuleBounds.clear();
+  BuildGrid();
+}
+
+auto ColliderSet::BuildGrid() noexcept -> void
+{
+  const auto shapeBounds = std::array{std::span<const Bounds>{m_sphereBounds},
+                                      std::span<const Bounds>{m_boxBounds},
+                                      std::span<const Bounds>{m_capsuleBounds}};
+
+  auto numShapes = size_t{0U};
+  m_gridBounds   = {.min = glm::vec4{std::numeric_limits<float>::max()},
+                    .max = glm::vec4{std::numeric_limits<float>::lowest()}};
+  for (const auto& bounds : shapeBounds)
+  {
+    for (const auto& shape : bounds)
+    {
+      m_gridBounds.min = glm::min(m_gridBounds.min, shape.min);
+      m_gridBounds.max = glm::max(m_gridBounds.max, shape.max);
+    }
+    numShapes += bounds.size();
+  }
+
+  m_cellStarts.clear();
+  m_cellShapes.clear();
+  if (0U == numShapes)
+  {
+    m_gridResolution = 0U;
+    m_cellsPerUnit   = glm::vec4{0.0F};
+    return;
+  }
+
+  // Around four cells per shape along each axis, so most cells hold one shape or none.
+  static constexpr auto CELLS_PER_SHAPE = 4.0;
+
+  m_gridResolution = std::clamp(
+      static_cast<uint32_t>(CELLS_PER_SHAPE * std::cbrt(static_cast<double>(numShapes))),
+      1U,
+      MAX_GRID_RESOLUTION);
+
+  const auto size  = glm::max(m_gridBounds.max - m_gridBounds.min,
+                              glm::vec4{std::numeric_limits<float>::min()});
+  m_cellsPerUnit   = static_cast<float>(m_gridResolution) / size;
+  m_cellsPerUnit.w = 0.0F;
+
+  const auto getCellRange = [this](const Bounds& bounds)
+  {
+    const auto maxCell = static_cast<float>(m_gridResolution - 1);
+    const auto first   = glm::clamp(
+        (bounds.min - m_gridBounds.min) * m_cellsPerUnit, glm::vec4{0.0F}, glm::vec4{maxCell});
+    const auto last = glm::clamp(
+        (bounds.max - m_gridBounds.min) * m_cellsPerUnit, glm::vec4{0.0F}, glm::vec4{maxCell});
+    return std::array{glm::uvec3{first}, glm::uvec3{last}};
+  };
+
+  // Counting sort of (cell, list) entries, as the lists are laid out.
+  const auto numCells = static_cast<size_t>(m_gridResolution) * m_gridResolution * m_gridResolution;
+  m_cellStarts.assign((NUM_SHAPE_LISTS * numCells) + 1, 0U);
+  const auto forEachEntry = [this, &shapeBounds, &getCellRange](const auto& func)
+  {
+    for (auto list = 0U; list < NUM_SHAPE_LISTS; ++list)
+    {
+      for (auto shape = 0U; shape < shapeBounds.at(list).size(); ++shape)
+      {
+        const auto [first, last] = getCellRange(shapeBounds.at(list)[shape]);
+        for (auto z = first.z; z <= last.z; ++z)
+        {
+          for (auto y = first.y; y <= last.y; ++y)
+          {
+            for (auto x = first.x; x <= last.x; ++x)
+            {
+              const auto cell = x + (m_gridResolution * (y + (m_gridResolution * z)));
+              func((NUM_SHAPE_LISTS * static_cast<size_t>(cell)) + list, shape);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  forEachEntry([this](const size_t entryList, [[maybe_unused]] const uint32_t shape)
+               { ++m_cellStarts[entryList + 1]; });
+  std::partial_sum(m_cellStarts.cbegin(), m_cellStarts.cend(), m_cellStarts.begin());
+
+  m_cellShapes.resize(m_cellStarts.back());
+  auto nextSlots = std::vector<uint32_t>(m_cellStarts.cbegin(), m_cellStarts.cend() - 1);
+  forEachEntry([this, &nextSlots](const size_t entryList, const uint32_t shape)
+               { m_cellShapes[nextSlots[entryList]++] = shape; });
+}
+
+auto ColliderSet::FindInside(const std::span<const glm::vec4> positions,
+                             const size_t firstId,
+                             std::vector<size_t>& insideIds) const noexcept -> void
+{
+  for (auto id = size_t{0U}; id < positions.size(); ++id)
+  {
+    const auto& position = positions[id];
+    const auto x         = position.x;
+    const auto y         = position.y;
+    const auto z         = position.z;
+
+    auto distance = std::numeric_limits<float>::max();
+    for (auto i = size_t{0U}; i < m_planes.offset.size(); ++i)
+    {
+      distance = std::min(distance, GetPlaneDistance(i, x, y, z));
+    }
+
+    if (const auto cell = GetCell(position); cell != NO_CELL)
+    {
+      for (const auto i : GetCellShapes(cell, SPHERES))
+      {
+        distance = std::min(distance, GetSphereDistance(i, x, y, z));
+      }
+      for (const auto i : GetCellShapes(cell, BOXES))
+      {
+        distance = std::min(distance, GetBoxDistance(i, x, y, z));
+      }
+      for (const auto i : GetCellShapes(cell, CAPSULES))
+      {
+        distance = std::min(distance, GetCapsuleDistance(i, x, y, z));
+      }
+    }
+
+    if (distance < 0.0F)
+    {
+      insideIds.push_back(firstId + id);
+    }
+  }
+}
+
+auto ColliderSet::GetContact(const glm::vec4& position) const noexcept -> Contact
+{
+  enum class Shape : uint8_t
+  {
+    PLANE,
+    SPHERE,
+    BOX,
+    CAPSULE,
+  };
+
+  const auto x = position.x;
+  const auto y = position.y;
+  const auto z = position.z;
+
+  auto distance = std::numeric_limits<float>::max();
+  auto shape    = Shape::PLANE;
+  auto index    = size_t{0U};
+
+  const auto findDeepest = [&distance, &shape, &index](const Shape shapeType,
+                                                       const size_t shapeIndex,
+                                                       const float shapeDistance)
+  {
+    if (shapeDistance < distance)
+    {
+      distance = shapeDistance;
+      shape    = shapeType;
+      index    = shapeIndex;
+    }
+  };
+
+  for (auto i = size_t{0U}; i < m_planes.offset.size(); ++i)
+  {
+    findDeepest(Shape::PLANE, i, GetPlaneDistance(i, x, y, z));
+  }
+  // Any bounded shape the position is inside overlaps its cell.
+  if (const auto cell = GetCell(position); cell != NO_CELL)
+  {
+    for (const auto i : GetCellShapes(cell, SPHERES))
+    {
+      findDeepest(Shape::SPHERE, i, GetSphereDistance(i, x, y, z));
+    }
+    for (const auto i : GetCellShapes(cell, BOXES))
+    {
+      findDeepest(Shape::BOX, i, GetBoxDistance(i, x, y, z));
+    }
+    for (const auto i : GetCellShapes(cell, CAPSULES))
+    {
+      findDeepest(Shape::CAPSULE, i, GetCapsuleDistance(i, x, y, z));
+    }
+  }
+
+  if (distance >= 0.0F)
+  {
+    return {.distance = 0.0F, .normal = FALLBACK_NORMAL};
+  }
+
+  switch (shape)
+  {
+    case Shape::PLANE:
+      return {.distance = distance,
+              .normal   = glm::vec4{m_planes.normalX[index],
+                                  m_planes.normalY[index],
+                                  m_planes.normalZ[index],
+                                  0.0F}};
+    case Shape::SPHERE:
+      return {.distance = distance,
+              .normal   = NormaliseOrFallback(glm::vec3{x - m_spheres.centreX[index],
+                                                      y - m_spheres.centreY[index],
+                                                      z - m_spheres.centreZ[index]})};
+    case Shape::BOX:
+    {
+      const auto axisX = glm::vec3{
+          m_boxes.axisXx[index], m_boxes.axisXy[index], m_boxes.axisXz[index]};
+      const auto axisY = glm::vec3{
+          m_boxes.axisYx[index], m_boxes.axisYy[index], m_boxes.axisYz[index]};
+      const auto axisZ = glm::vec3{
+          m_boxes.axisZx[index], m_boxes.axisZy[index], m_boxes.axisZz[index]};
+      const auto offset = glm::vec3{
+          x - m_boxes.centreX[index], y - m_boxes.centreY[index], z - m_boxes.centreZ[index]};
+
+      const auto local = glm::vec3{
+          glm::dot(offset, axisX), glm::dot(offset, axisY), glm::dot(offset, axisZ)};
+      const auto q = glm::abs(local) - glm::vec3{m_boxes.halfExtentX[index],
+                                                 m_boxes.halfExtentY[index],
+                                                 m_boxes.halfExtentZ[index]};
+
+      // Out through the nearest face.
+      const auto face   = ((q.x >= q.y) and (q.x >= q.z)) ? 0 : ((q.y >= q.z) ? 1 : 2);
+      auto localNormal  = glm::vec3{0.0F};
+      localNormal[face] = (local[face] < 0.0F) ? -1.0F : 1.0F;
+
+      return {.distance = distance,
+              .normal   = NormaliseOrFallback((localNormal.x * axisX) + (localNormal.y * axisY) +
+                                            (localNormal.z * axisZ))};
+    }
+    case Shape::CAPSULE:
+    {
+      const auto axis   = glm::vec3{
+          m_capsules.axisX[index], m_capsules.axisY[index], m_capsules.axisZ[index]};
+      const auto offset = glm::vec3{x - m_capsules.startX[index],
+                                    y - m_capsules.startY[index],
+                                    z - m_capsules.startZ[index]};
+      const auto t =
+          std::clamp(glm::dot(offset, axis) * m_capsules.invAxisLengthSq[index], 0.0F, 1.0F);
+
+      return {.distance = distance, .normal = NormaliseOrFallback(offset - (t * axis))};
+    }
+  }
+
+  return {.distance = distance, .normal = FALLBACK_NORMAL};
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
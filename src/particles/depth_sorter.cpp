@@ -0,0 +1,357 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+module Particles.DepthSorter;
+
+import Particles.Parallel;
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+namespace
+{
+
+// Flipping the sign bit of a positive float, and every bit of a negative one, gives an unsigned
+// int in the same order as the float. Inverting that puts the furthest first.
+[[nodiscard]] auto GetBackToFrontKey(const float depth) noexcept -> uint32_t
+{
+  static constexpr auto SIGN_BIT = 0x80000000U;
+
+  const auto bits      = std::bit_cast<uint32_t>(depth);
+  const auto ascending = (0U != (bits & SIGN_BIT)) ? ~bits : (bits | SIGN_BIT);
+
+  return ~ascending;
+}
+
+} // namespace
+
+auto DepthSorter::Sort(const ParticleData& particleData,
+                       const glm::vec4& viewPosition,
+                       const glm::vec4& viewDirection) noexcept -> std::span<const uint32_t>
+{
+  SortIds(particleData, std::nullopt, viewPosition, viewDirection);
+  return m_order;
+}
+
+auto DepthSorter::Sort(const ParticleData& particleData,
+                       const std::span<const uint32_t> ids,
+                       const glm::vec4& viewPosition,
+                       const glm::vec4& viewDirection) noexcept -> std::span<const uint32_t>
+{
+  SortIds(particleData, ids, viewPosition, viewDirection);
+  return m_order;
+}
+
+auto DepthSorter::SortIds(const ParticleData& particleData,
+                          const OptionalIds& ids,
+                          const glm::vec4& viewPosition,
+                          const glm::vec4& viewDirection) noexcept -> void
+{
+  if ((DepthSortMode::FULL == m_mode) or
+      (not SortAdaptive(particleData, ids, viewPosition, viewDirection)))
+  {
+    SortFull(particleData, ids, viewPosition, viewDirection);
+  }
+
+  m_isOrderOfAllAlive = not ids.has_value();
+}
+
+auto DepthSorter::SortFull(const ParticleData& particleData,
+                           const OptionalIds& ids,
+                           const glm::vec4& viewPosition,
+                           const glm::vec4& viewDirection) noexcept -> void
+{
+  MakeKeys(particleData, ids, viewPosition, viewDirection);
+  if (ids.has_value())
+  {
+    m_order.assign(ids->begin(), ids->end());
+    m_radixSort.SortValues(m_keys, m_order);
+  }
+  else
+  {
+    m_radixSort.SortIndices(m_keys, m_order);
+  }
+
+  m_numSortedLast = m_order.size();
+}
+
+auto DepthSorter::SortChunk(const size_t begin,
+                            const size_t end,
+                            AdaptiveChunk& chunk) const noexcept -> bool
+{
+  // Particles a few places out are insertion sorted into the ones kept. One that is ahead of a
+  // particle 'MAX_SHIFT' places on, or behind one kept 'MAX_SHIFT' places back, is taken out
+  // instead, so the insertions stay short and one particle far out of place does not hold up
+  // all the ones after it.
+  const auto numSorted     = m_order.size();
+  const auto maxOutOfPlace = (end - begin) / MAX_OUT_OF_PLACE_DIVISOR;
+  const auto maxNumShifts  = (end - begin) * MAX_MEAN_SHIFT;
+  auto numShifts           = size_t{0U};
+  auto& inPlace            = chunk.inPlace;
+  auto& outOfPlace         = chunk.outOfPlace;
+  inPlace.clear();
+  outOfPlace.clear();
+  for (auto i = begin; i < end; ++i)
+  {
+    const auto particle = KeyedIndex{.key = m_keys[i], .index = m_order[i]};
+    const auto numKept  = inPlace.size();
+
+    const auto isFarAhead =
+        ((i + MAX_SHIFT) < numSorted) and (particle.key > m_keys[i + MAX_SHIFT]);
+    const auto isFarBehind =
+        (numKept >= MAX_SHIFT) and (particle.key < inPlace[numKept - MAX_SHIFT].key);
+    if (isFarAhead or isFarBehind)
+    {
+      if (outOfPlace.size() == maxOutOfPlace)
+      {
+        return false;
+      }
+      outOfPlace.push_back(particle);
+      continue;
+    }
+
+    inPlace.push_back(particle);
+    auto place = numKept;
+    for (; (place > 0U) and (inPlace[place - 1].key > particle.key); --place)
+    {
+      inPlace[place] = inPlace[place - 1];
+    }
+    inPlace[place] = particle;
+
+    numShifts += numKept - place;
+    if (numShifts > maxNumShifts)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+auto DepthSorter::CarryOverOrder(const size_t numAlive, const OptionalIds& ids) noexcept -> void
+{
+  // Last frame's order of all the alive particles holds every particle that was alive then.
+  // Those past the alive count have been killed, and emitted ones have been added after the
+  // rest.
+  if (m_isOrderOfAllAlive and (not ids.has_value()))
+  {
+    const auto numPrevAlive = m_order.size();
+    std::erase_if(m_order, [numAlive](const uint32_t id) { return id >= numAlive; });
+    for (auto id = numPrevAlive; id < numAlive; ++id)
+    {
+      m_order.push_back(static_cast<uint32_t>(id));
+    }
+    return;
+  }
+
+  // Otherwise the particles to sort are marked, those in last frame's order are kept in it and
+  // unmarked, and the ones still marked are added after.
+  m_isListed.assign(numAlive, ids.has_value() ? 0U : 1U);
+  if (ids.has_value())
+  {
+    for (const auto id : *ids)
+    {
+      m_isListed[id] = 1U;
+    }
+  }
+  std::erase_if(m_order,
+                [this, numAlive](const uint32_t id)
+                { return (id >= numAlive) or (0U == m_isListed[id]); });
+  for (const auto id : m_order)
+  {
+    m_isListed[id] = 0U;
+  }
+
+  const auto addIfListed = [this](const uint32_t id)
+  {
+    if (0U != m_isListed[id])
+    {
+      m_order.push_back(id);
+    }
+  };
+  if (ids.has_value())
+  {
+    std::ranges::for_each(*ids, addIfListed);
+    return;
+  }
+  for (auto id = 0U; id < numAlive; ++id)
+  {
+    addIfListed(id);
+  }
+}
+
+auto DepthSorter::SortAdaptive(const ParticleData& particleData,
+                               const OptionalIds& ids,
+                               const glm::vec4& viewPosition,
+                               const glm::vec4& viewDirection) noexcept -> bool
+{
+  CarryOverOrder(particleData.GetAliveCount(), ids);
+  const auto numSorted = m_order.size();
+
+  if (not IsNearlySorted(particleData, viewPosition, viewDirection))
+  {
+    return false;
+  }
+
+  MakeKeys(particleData, m_order, viewPosition, viewDirection);
+
+  const auto numChunks = ((nullptr == m_parallel) or (numSorted < MIN_PARALLEL_SIZE))
+                             ? 1U
+                             : m_parallel->GetNumThreads();
+  m_chunks.resize(numChunks);
+  const auto sortChunk =
+      [this]([[maybe_unused]] const uint32_t chunk, const size_t begin, const size_t end)
+  { m_chunks[chunk].isNearlySorted = SortChunk(begin, end, m_chunks[chunk]); };
+  if (1U == numChunks)
+  {
+    sortChunk(0U, 0U, numSorted);
+  }
+  else
+  {
+    m_parallel->ForLoop(numSorted, sortChunk);
+  }
+  if (not std::ranges::all_of(m_chunks, &AdaptiveChunk::isNearlySorted))
+  {
+    return false;
+  }
+
+  // Each chunk's particles kept in place are in order, but the end of one chunk can overlap the
+  // start of the next. Those at the start of a chunk are insertion sorted into the ones before,
+  // until one is no nearer than all of them, and so are all that follow it.
+  const auto maxNumShifts = numSorted * MAX_MEAN_SHIFT;
+  auto numShifts          = size_t{0U};
+  std::swap(m_inPlace, m_chunks.front().inPlace);
+  std::swap(m_outOfPlace, m_chunks.front().outOfPlace);
+  for (const auto& chunk : std::span{m_chunks}.subspan(1U))
+  {
+    auto particle = chunk.inPlace.cbegin();
+    for (; (chunk.inPlace.cend() != particle) and (not m_inPlace.empty()) and
+           (particle->key < m_inPlace.back().key);
+         ++particle)
+    {
+      const auto numKept = m_inPlace.size();
+      m_inPlace.push_back(*particle);
+      auto place = numKept;
+      for (; (place > 0U) and (m_inPlace[place - 1].key > particle->key); --place)
+      {
+        m_inPlace[place] = m_inPlace[place - 1];
+      }
+      m_inPlace[place] = *particle;
+
+      numShifts += numKept - place;
+      if (numShifts > maxNumShifts)
+      {
+        return false;
+      }
+    }
+    m_inPlace.insert(m_inPlace.cend(), particle, chunk.inPlace.cend());
+    m_outOfPlace.insert(m_outOfPlace.cend(), chunk.outOfPlace.cbegin(), chunk.outOfPlace.cend());
+  }
+
+  std::ranges::sort(m_outOfPlace,
+                    [](const KeyedIndex& lhs, const KeyedIndex& rhs)
+                    {
+                      return (lhs.key < rhs.key) or
+                             ((lhs.key == rhs.key) and (lhs.index < rhs.index));
+                    });
+
+  auto inPlace    = m_inPlace.cbegin();
+  auto outOfPlace = m_outOfPlace.cbegin();
+  for (auto& id : m_order)
+  {
+    if ((m_outOfPlace.cend() == outOfPlace) or
+        ((m_inPlace.cend() != inPlace) and (inPlace->key <= outOfPlace->key)))
+    {
+      id = (inPlace++)->index;
+    }
+    else
+    {
+      id = (outOfPlace++)->index;
+    }
+  }
+
+  m_numSortedLast = m_outOfPlace.size();
+  return true;
+}
+
+auto DepthSorter::IsNearlySorted(const ParticleData& particleData,
+                                 const glm::vec4& viewPosition,
+                                 const glm::vec4& viewDirection) const noexcept -> bool
+{
+  if (m_order.size() < (NUM_SAMPLED_PAIRS * MAX_SHIFT))
+  {
+    return true;
+  }
+
+  const auto eye       = glm::vec3{viewPosition};
+  const auto direction = glm::vec3{viewDirection};
+  const auto getKey    = [&particleData, eye, direction](const uint32_t id)
+  { return GetBackToFrontKey(glm::dot(glm::vec3{particleData.GetPosition(id)} - eye, direction)); };
+
+  // The pairs are 'MAX_SHIFT' places apart, so a pair out of order means at least one of the
+  // two particles is too far out to be insertion sorted.
+  const auto stride       = (m_order.size() - MAX_SHIFT) / NUM_SAMPLED_PAIRS;
+  auto numPairsOutOfOrder = 0U;
+  for (auto pair = 0U; pair < NUM_SAMPLED_PAIRS; ++pair)
+  {
+    const auto i = pair * stride;
+    if (getKey(m_order[i]) > getKey(m_order[i + MAX_SHIFT]))
+    {
+      ++numPairsOutOfOrder;
+    }
+  }
+
+  return (numPairsOutOfOrder * MAX_OUT_OF_PLACE_DIVISOR) <= NUM_SAMPLED_PAIRS;
+}
+
+auto DepthSorter::MakeKeys(const ParticleData& particleData,
+                           const OptionalIds& ids,
+                           const glm::vec4& viewPosition,
+                           const glm::vec4& viewDirection) noexcept -> void
+{
+  const auto numKeys   = ids.has_value() ? ids->size() : particleData.GetAliveCount();
+  const auto positions = particleData.GetPositions();
+  const auto eye       = glm::vec3{viewPosition};
+  const auto direction = glm::vec3{viewDirection};
+
+  m_keys.resize(numKeys);
+
+  const auto makeKeys =
+      [this, &ids, positions, eye, direction](
+          [[maybe_unused]] const uint32_t chunk, const size_t begin, const size_t end)
+  {
+    if (not ids.has_value())
+    {
+      for (auto i = begin; i < end; ++i)
+      {
+        m_keys[i] = GetBackToFrontKey(glm::dot(glm::vec3{positions[i]} - eye, direction));
+      }
+      return;
+    }
+    const auto& idList = *ids;
+    for (auto i = begin; i < end; ++i)
+    {
+      m_keys[i] = GetBackToFrontKey(glm::dot(glm::vec3{positions[idList[i]]} - eye, direction));
+    }
+  };
+
+  if ((nullptr == m_parallel) or (numKeys < MIN_PARALLEL_SIZE))
+  {
+    makeKeys(0U, 0U, numKeys);
+    return;
+  }
+  m_parallel->ForLoop(numKeys, makeKeys);
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,130 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <stdexcept>
+
+module Particles.DistanceField;
+
+import Particles.Parallel;
+import Particles.VectorGrid;
+
+namespace PARTICLES
+{
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+namespace
+{
+
+auto BakeSlices(VectorGrid& field,
+                const DistanceFunction& distance,
+                const size_t beginZ,
+                const size_t endZ) -> void
+{
+  const auto resolution = field.GetResolution();
+
+  // Central differences over half a grid spacing.
+  const auto spacing = (field.GetBoundsMax() - field.GetBoundsMin()) /
+                       static_cast<float>(resolution - 1);
+  const auto epsilon = 0.5F * std::min({spacing.x, spacing.y, spacing.z});
+  const auto dx      = glm::vec4{epsilon, 0.0F, 0.0F, 0.0F};
+  const auto dy      = glm::vec4{0.0F, epsilon, 0.0F, 0.0F};
+  const auto dz      = glm::vec4{0.0F, 0.0F, epsilon, 0.0F};
+
+  for (auto z = static_cast<uint32_t>(beginZ); z < endZ; ++z)
+  {
+    for (auto y = 0U; y < resolution; ++y)
+    {
+      for (auto x = 0U; x < resolution; ++x)
+      {
+        const auto position = field.GetPointPosition(x, y, z);
+
+        auto gradient = glm::vec3{distance(position + dx) - distance(position - dx),
+                                  distance(position + dy) - distance(position - dy),
+                                  distance(position + dz) - distance(position - dz)};
+        if (const auto length = glm::length(gradient); length > 0.0F)
+        {
+          gradient /= length;
+        }
+
+        field.SetValue(x, y, z, glm::vec4{gradient, distance(position)});
+      }
+    }
+  }
+}
+
+[[nodiscard]] auto IsSameGrid(const VectorGrid& field,
+                              const DistanceFieldSettings& settings) noexcept -> bool
+{
+  return (field.GetVersion() == settings.shapeVersion) and
+         (field.GetResolution() == settings.resolution) and
+         (glm::vec3{field.GetBoundsMin()} == glm::vec3{settings.boundsMin}) and
+         (glm::vec3{field.GetBoundsMax()} == glm::vec3{settings.boundsMax});
+}
+
+} // namespace
+
+auto MakeDistanceField(const DistanceFieldSettings& settings,
+                       const DistanceFunction& distance,
+                       const std::shared_ptr<Parallel>& parallel) -> VectorGrid
+{
+  if (settings.resolution < 2U)
+  {
+    throw std::invalid_argument("A distance field needs at least 2 points along each axis.");
+  }
+
+  if (not settings.cacheFilename.empty())
+  {
+    try
+    {
+      auto field = VectorGrid::LoadFromFile(settings.cacheFilename);
+      if (IsSameGrid(field, settings))
+      {
+        return field;
+      }
+    }
+    catch (const std::runtime_error&)
+    {
+      // No usable bake yet.
+    }
+  }
+
+  auto field = VectorGrid{settings.boundsMin, settings.boundsMax, settings.resolution};
+  field.SetVersion(settings.shapeVersion);
+
+  if (nullptr == parallel)
+  {
+    BakeSlices(field, distance, 0U, settings.resolution);
+  }
+  else
+  {
+    parallel->ForLoop(settings.resolution,
+                      [&field, &distance]([[maybe_unused]] const uint32_t chunk,
+                                          const size_t begin,
+                                          const size_t end)
+                      { BakeSlices(field, distance, begin, end); });
+  }
+
+  if (not settings.cacheFilename.empty())
+  {
+    try
+    {
+      field.SaveToFile(settings.cacheFilename);
+    }
+    catch (const std::runtime_error&)
+    {
+      // The cache only saves time, so a read only location just means baking every run.
+    }
+  }
+
+  return field;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,373 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+module Particles.EffectTrace;
+
+import Particles.Effect;
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.ParticleUpdaters;
+import Particles.Particles;
+
+namespace PARTICLES::EFFECTS
+{
+
+using UPDATERS::StaggerMode;
+using UPDATERS::StaggerSchedule;
+
+enum class TracedCall : uint8_t
+{
+  RESET,
+  SET_TINT_COLOR,              // glm::vec4
+  SET_TINT_MIX_AMOUNT,         // float
+  SET_MAX_NUM_ALIVE_PARTICLES, // uint64_t
+  SET_COLOR_UPDATE_SCHEDULE,   // StaggerMode, uint32_t period
+  UPDATE,                      // double dt
+  UPDATE_VISIBILITY,           // Frustum::Planes
+  SET_PARALLEL,                // uint32_t number of threads, 0 for no pool
+  SET_RANDOM_SEED,             // uint64_t
+  NUM_CALLS,
+};
+
+namespace
+{
+
+constexpr auto TRACE_MAGIC   = std::array{'P', 'T', 'R', 'C'};
+// 1 seeded 'std::rand', 2 didn't trace 'SetParallel', 3 didn't trace 'SetRandomSeed'
+constexpr auto TRACE_VERSION = 4U;
+
+struct TraceHeader
+{
+  std::array<char, TRACE_MAGIC.size()> magic;
+  uint32_t version;
+  uint64_t numParticles;
+  uint64_t randomSeed;
+  uint32_t effectNameSize; // the name follows the header
+  uint32_t padding;
+};
+
+// The bytes of arguments after each call's byte.
+constexpr auto ARGUMENTS_SIZES = std::array<size_t, static_cast<size_t>(TracedCall::NUM_CALLS)>{
+    0U,
+    sizeof(glm::vec4),
+    sizeof(float),
+    sizeof(uint64_t),
+    sizeof(StaggerMode) + sizeof(uint32_t),
+    sizeof(double),
+    sizeof(Frustum::Planes),
+    sizeof(uint32_t),
+    sizeof(uint64_t),
+};
+
+[[nodiscard]] constexpr auto GetArgumentsSize(const TracedCall call) noexcept -> size_t
+{
+  return ARGUMENTS_SIZES.at(static_cast<size_t>(call));
+}
+
+template<typename T>
+auto WriteValue(std::ofstream& file, const T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+auto ReadValue(std::ifstream& file, T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+// Reads the value at 'position' in the calls and moves past it. The calls were checked when
+// loaded, so it is always there.
+template<typename T>
+[[nodiscard]] auto TakeValue(const std::span<const std::byte> calls, size_t& position) noexcept
+    -> T
+{
+  auto value = T{};
+  std::memcpy(&value, calls.subspan(position, sizeof(T)).data(), sizeof(T));
+  position += sizeof(T);
+  return value;
+}
+
+} // namespace
+
+TracedEffect::TracedEffect(std::shared_ptr<IEffect> effect,
+                           const EffectTraceInfo& info,
+                           const std::filesystem::path& filename)
+  : m_effect{std::move(effect)}, m_filename{filename}, m_file{filename, std::ios::binary}
+{
+  const auto header = TraceHeader{
+      .magic          = TRACE_MAGIC,
+      .version        = TRACE_VERSION,
+      .numParticles   = info.numParticles,
+      .randomSeed     = info.randomSeed,
+      .effectNameSize = static_cast<uint32_t>(info.effectName.size()),
+      .padding        = 0U,
+  };
+  WriteValue(m_file, header);
+  m_file.write(info.effectName.data(), static_cast<std::streamsize>(info.effectName.size()));
+  if (not m_file)
+  {
+    throw std::runtime_error("Could not create effect trace file '" + filename.string() + "'.");
+  }
+
+  m_effect->SetRandomSeed(info.randomSeed); // in the header, not a record
+}
+
+TracedEffect::~TracedEffect() noexcept
+{
+  try
+  {
+    Close();
+  }
+  catch (const std::runtime_error&)
+  {
+    // Nothing to tell, call 'Close' to find out.
+  }
+}
+
+auto TracedEffect::Close() -> void
+{
+  if (m_closed)
+  {
+    return;
+  }
+  m_closed = true;
+
+  m_file.close();
+  if (not m_file)
+  {
+    throw std::runtime_error("Could not write effect trace file '" + m_filename.string() + "'.");
+  }
+}
+
+template<typename... Arguments>
+auto TracedEffect::Trace(const TracedCall call, const Arguments&... arguments) noexcept -> void
+{
+  if (m_closed)
+  {
+    return;
+  }
+  WriteValue(m_file, call);
+  (WriteValue(m_file, arguments), ...);
+  ++m_numTracedCalls;
+}
+
+auto TracedEffect::Reset() noexcept -> void
+{
+  Trace(TracedCall::RESET);
+  m_effect->Reset();
+}
+
+auto TracedEffect::SetTintColor(const glm::vec4& tintColor) noexcept -> void
+{
+  Trace(TracedCall::SET_TINT_COLOR, tintColor);
+  m_effect->SetTintColor(tintColor);
+}
+
+auto TracedEffect::SetTintMixAmount(const float mixAmount) noexcept -> void
+{
+  Trace(TracedCall::SET_TINT_MIX_AMOUNT, mixAmount);
+  m_effect->SetTintMixAmount(mixAmount);
+}
+
+auto TracedEffect::SetMaxNumAliveParticles(const size_t maxNumAliveParticles) noexcept -> void
+{
+  Trace(TracedCall::SET_MAX_NUM_ALIVE_PARTICLES, uint64_t{maxNumAliveParticles});
+  m_effect->SetMaxNumAliveParticles(maxNumAliveParticles);
+}
+
+auto TracedEffect::SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void
+{
+  Trace(TracedCall::SET_COLOR_UPDATE_SCHEDULE, schedule.mode, schedule.period);
+  m_effect->SetColorUpdateSchedule(schedule);
+}
+
+auto TracedEffect::SetRandomSeed(const uint64_t seed) noexcept -> void
+{
+  Trace(TracedCall::SET_RANDOM_SEED, seed);
+  m_effect->SetRandomSeed(seed);
+}
+
+auto TracedEffect::SetParallel(const std::shared_ptr<Parallel>& parallel) noexcept -> void
+{
+  Trace(TracedCall::SET_PARALLEL, (nullptr == parallel) ? 0U : parallel->GetNumThreads());
+  m_effect->SetParallel(parallel);
+}
+
+auto TracedEffect::Update(const double dt) noexcept -> void
+{
+  Trace(TracedCall::UPDATE, dt);
+  m_effect->Update(dt);
+}
+
+auto TracedEffect::UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool
+{
+  Trace(TracedCall::UPDATE_VISIBILITY, viewFrustum.GetPlanes());
+  return m_effect->UpdateVisibility(viewFrustum);
+}
+
+// Only called by 'Prewarm', which is traced as the updates it runs.
+auto TracedEffect::SetEffectTime(const double time) noexcept -> void
+{
+  SetEffectTimeOf(*m_effect, time);
+}
+
+EffectTracePlayer::EffectTracePlayer(const std::filesystem::path& filename)
+{
+  auto file = std::ifstream{filename, std::ios::binary | std::ios::ate};
+  if (not file)
+  {
+    throw std::runtime_error("Could not open effect trace file '" + filename.string() + "'.");
+  }
+  const auto fileSize = static_cast<uint64_t>(file.tellg());
+  file.seekg(0);
+
+  auto header = TraceHeader{};
+  ReadValue(file, header);
+  if ((not file) or (header.magic != TRACE_MAGIC))
+  {
+    throw std::runtime_error("Not an effect trace file '" + filename.string() + "'.");
+  }
+  if (header.version != TRACE_VERSION)
+  {
+    throw std::runtime_error("Effect trace file '" + filename.string() + "' is version " +
+                             std::to_string(header.version) + ", not " +
+                             std::to_string(TRACE_VERSION) + ".");
+  }
+  if (header.effectNameSize > (fileSize - sizeof(TraceHeader)))
+  {
+    throw std::runtime_error("Effect trace file '" + filename.string() + "' is truncated.");
+  }
+
+  m_info.effectName.resize(header.effectNameSize);
+  file.read(m_info.effectName.data(), static_cast<std::streamsize>(header.effectNameSize));
+  m_info.numParticles = header.numParticles;
+  m_info.randomSeed   = header.randomSeed;
+
+  m_calls.resize(fileSize - sizeof(TraceHeader) - header.effectNameSize);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(m_calls.data()), static_cast<std::streamsize>(m_calls.size()));
+  if (not file)
+  {
+    throw std::runtime_error("Could not read effect trace file '" + filename.string() + "'.");
+  }
+
+  // Checked once here, so that playing needs no checks.
+  for (auto position = size_t{0U}; position < m_calls.size();)
+  {
+    const auto call = static_cast<TracedCall>(m_calls[position]);
+    if ((call >= TracedCall::NUM_CALLS) or
+        (GetArgumentsSize(call) > (m_calls.size() - position - 1U)))
+    {
+      throw std::runtime_error("Effect trace file '" + filename.string() + "' is corrupt at byte " +
+                               std::to_string(sizeof(TraceHeader) + header.effectNameSize +
+                                              position) +
+                               ".");
+    }
+    if (TracedCall::SET_PARALLEL == call)
+    {
+      auto argumentPosition = position + 1U;
+      const auto numThreads = TakeValue<uint32_t>(m_calls, argumentPosition);
+      if ((0U != numThreads) and (nullptr == FindPool(numThreads)))
+      {
+        m_pools.push_back(std::make_shared<Parallel>(numThreads));
+      }
+    }
+    position += 1U + GetArgumentsSize(call);
+    ++m_numCalls;
+    m_numFrames += (TracedCall::UPDATE == call) ? 1U : 0U;
+  }
+}
+
+auto EffectTracePlayer::FindPool(const uint32_t numThreads) const noexcept
+    -> std::shared_ptr<Parallel>
+{
+  const auto pool = std::ranges::find_if(m_pools,
+                                         [numThreads](const auto& parallel)
+                                         { return parallel->GetNumThreads() == numThreads; });
+  return (m_pools.cend() == pool) ? nullptr : *pool;
+}
+
+auto EffectTracePlayer::PlayFrame(IEffect& effect) noexcept -> bool
+{
+  if (0U == m_position)
+  {
+    effect.SetRandomSeed(m_info.randomSeed);
+  }
+  while (m_position < m_calls.size())
+  {
+    if (PlayCall(effect))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto EffectTracePlayer::PlayAll(IEffect& effect) noexcept -> void
+{
+  while (PlayFrame(effect))
+  {
+  }
+}
+
+auto EffectTracePlayer::PlayCall(IEffect& effect) noexcept -> bool
+{
+  const auto calls = std::span<const std::byte>{m_calls};
+  const auto call  = TakeValue<TracedCall>(calls, m_position);
+  switch (call)
+  {
+    case TracedCall::RESET:
+      effect.Reset();
+      break;
+    case TracedCall::SET_TINT_COLOR:
+      effect.SetTintColor(TakeValue<glm::vec4>(calls, m_position));
+      break;
+    case TracedCall::SET_TINT_MIX_AMOUNT:
+      effect.SetTintMixAmount(TakeValue<float>(calls, m_position));
+      break;
+    case TracedCall::SET_MAX_NUM_ALIVE_PARTICLES:
+      effect.SetMaxNumAliveParticles(TakeValue<uint64_t>(calls, m_position));
+      break;
+    case TracedCall::SET_COLOR_UPDATE_SCHEDULE:
+    {
+      const auto mode   = TakeValue<StaggerMode>(calls, m_position);
+      const auto period = TakeValue<uint32_t>(calls, m_position);
+      effect.SetColorUpdateSchedule({.mode = mode, .period = period});
+      break;
+    }
+    case TracedCall::UPDATE:
+      effect.Update(TakeValue<double>(calls, m_position));
+      return true;
+    case TracedCall::UPDATE_VISIBILITY:
+      effect.UpdateVisibility(Frustum{TakeValue<Frustum::Planes>(calls, m_position)});
+      break;
+    case TracedCall::SET_PARALLEL:
+      effect.SetParallel(FindPool(TakeValue<uint32_t>(calls, m_position)));
+      break;
+    case TracedCall::SET_RANDOM_SEED:
+      effect.SetRandomSeed(TakeValue<uint64_t>(calls, m_position));
+      break;
+    case TracedCall::NUM_CALLS:
+      break; // not in a checked trace
+  }
+  return false;
+}
+
+} // namespace PARTICLES::EFFECTS
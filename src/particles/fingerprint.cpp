@@ -0,0 +1,193 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+module Particles.Fingerprint;
+
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+namespace
+{
+
+constexpr auto NUM_COMPONENTS = glm::vec4::length();
+
+// FNV-1a a word at a time.
+constexpr auto HASH_OFFSET = uint64_t{0xCBF29CE484222325U};
+constexpr auto HASH_PRIME  = uint64_t{0x100000001B3U};
+
+[[nodiscard]] constexpr auto HashWord(const uint64_t hash, const uint32_t word) noexcept
+    -> uint64_t
+{
+  return (hash ^ word) * HASH_PRIME;
+}
+
+// The SplitMix64 finalizer, so that the particles' hashes, which are summed, have their bits
+// spread over the whole word.
+constexpr auto MIX_SHIFT1      = 30U;
+constexpr auto MIX_SHIFT2      = 27U;
+constexpr auto MIX_SHIFT3      = 31U;
+constexpr auto MIX_MULTIPLIER1 = uint64_t{0xBF58476D1CE4E5B9U};
+constexpr auto MIX_MULTIPLIER2 = uint64_t{0x94D049BB133111EBU};
+
+[[nodiscard]] constexpr auto MixHash(uint64_t hash) noexcept -> uint64_t
+{
+  hash = (hash ^ (hash >> MIX_SHIFT1)) * MIX_MULTIPLIER1;
+  hash = (hash ^ (hash >> MIX_SHIFT2)) * MIX_MULTIPLIER2;
+  return hash ^ (hash >> MIX_SHIFT3);
+}
+
+// The alive particles' indices in increasing id order.
+auto SortById(const ParticleData& particleData, std::vector<uint32_t>& order) -> void
+{
+  const auto ids = particleData.GetIds();
+  order.resize(particleData.GetAliveCount());
+  std::iota(order.begin(), order.end(), 0U);
+  std::ranges::sort(order, {}, [&ids](const uint32_t i) { return ids[i]; });
+}
+
+} // namespace
+
+auto TakeFingerprint(const ParticleData& particleData) noexcept -> ParticleFingerprint
+{
+  const auto numAlive = particleData.GetAliveCount();
+  const auto ids      = particleData.GetIds();
+  const auto streams  = particleData.GetAliveStreams();
+
+  auto fingerprint = ParticleFingerprint{.numAlive = numAlive, .checksum = 0U, .means = {}};
+  for (auto i = size_t{0U}; i < numAlive; ++i)
+  {
+    auto hash = HashWord(HASH_OFFSET, ids[i]);
+    for (const auto& stream : streams)
+    {
+      for (auto component = 0; component < NUM_COMPONENTS; ++component)
+      {
+        hash = HashWord(hash, std::bit_cast<uint32_t>(stream[i][component]));
+      }
+    }
+    // Summed, so the order of the particles doesn't matter.
+    fingerprint.checksum += MixHash(hash);
+  }
+
+  if (0U == numAlive)
+  {
+    return fingerprint;
+  }
+  for (auto s = 0U; s < ParticleData::NUM_STREAMS; ++s)
+  {
+    auto sum = glm::dvec4{0.0};
+    for (const auto& value : streams[s])
+    {
+      sum += glm::dvec4{value};
+    }
+    fingerprint.means[s] = sum / static_cast<double>(numAlive);
+  }
+
+  return fingerprint;
+}
+
+auto CompareParticles(const ParticleData& reference,
+                      const ParticleData& other,
+                      const float tolerance) -> ParticleComparison
+{
+  auto referenceOrder = std::vector<uint32_t>{};
+  auto otherOrder     = std::vector<uint32_t>{};
+  SortById(reference, referenceOrder);
+  SortById(other, otherOrder);
+
+  const auto referenceIds     = reference.GetIds();
+  const auto otherIds         = other.GetIds();
+  const auto referenceStreams = reference.GetAliveStreams();
+  const auto otherStreams     = other.GetAliveStreams();
+
+  // How far off, in the terms of the tolerance, the particle furthest off in one stream is.
+  const auto getDifference = [](const std::span<const glm::vec4> referenceStream,
+                                const std::span<const glm::vec4> otherStream,
+                                const uint32_t referenceIndex,
+                                const uint32_t otherIndex)
+  {
+    auto maxDifference = 0.0F;
+    for (auto component = 0; component < NUM_COMPONENTS; ++component)
+    {
+      const auto referenceValue = referenceStream[referenceIndex][component];
+      const auto otherValue     = otherStream[otherIndex][component];
+      const auto difference     = std::abs(otherValue - referenceValue) /
+                              std::max(1.0F, std::abs(referenceValue));
+      // A NaN on either side is as far off as can be.
+      maxDifference = std::isnan(difference) ? std::numeric_limits<float>::infinity()
+                                             : std::max(maxDifference, difference);
+    }
+    return maxDifference;
+  };
+
+  auto comparison = ParticleComparison{.numCompared    = 0U,
+                                       .numMissing     = 0U,
+                                       .numOutside     = 0U,
+                                       .maxDifference  = 0.0F,
+                                       .maxDifferentId = 0U,
+                                       .firstOutsideId = std::nullopt};
+  auto r = size_t{0U};
+  auto o = size_t{0U};
+  while ((r < referenceOrder.size()) and (o < otherOrder.size()))
+  {
+    const auto referenceIndex = referenceOrder[r];
+    const auto otherIndex     = otherOrder[o];
+    const auto id             = referenceIds[referenceIndex];
+    if (id != otherIds[otherIndex])
+    {
+      ++comparison.numMissing;
+      if (id < otherIds[otherIndex])
+      {
+        ++r;
+      }
+      else
+      {
+        ++o;
+      }
+      continue;
+    }
+
+    auto difference = 0.0F;
+    for (auto s = 0U; s < ParticleData::NUM_STREAMS; ++s)
+    {
+      difference = std::max(
+          difference,
+          getDifference(referenceStreams.at(s), otherStreams.at(s), referenceIndex, otherIndex));
+    }
+    if (difference > comparison.maxDifference)
+    {
+      comparison.maxDifference  = difference;
+      comparison.maxDifferentId = id;
+    }
+    if (difference > tolerance)
+    {
+      ++comparison.numOutside;
+      if (not comparison.firstOutsideId.has_value())
+      {
+        comparison.firstOutsideId = id;
+      }
+    }
+
+    ++comparison.numCompared;
+    ++r;
+    ++o;
+  }
+  comparison.numMissing += (referenceOrder.size() - r) + (otherOrder.size() - o);
+
+  return comparison;
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,658 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec4.hpp>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+module Particles.FrameRecorder;
+
+import Particles.Particles;
+import Particles.RadixSort;
+import Particles.VertexFormats;
+
+namespace PARTICLES
+{
+
+namespace
+{
+
+using Vertex = QuantizedPositionColorFormat::Vertex;
+
+constexpr auto FILE_MAGIC  = std::array{'P', 'F', 'R', '1'};
+constexpr auto INDEX_MAGIC = std::array{'P', 'F', 'R', 'I'};
+
+struct FileHeader
+{
+  std::array<char, FILE_MAGIC.size()> magic;
+  uint32_t keyFrameInterval;
+  std::array<float, 4> boundsMin;
+  std::array<float, 4> boundsMax;
+};
+
+struct FrameHeader
+{
+  double time;
+  uint32_t numParticles;
+  uint32_t isKeyFrame;
+  uint64_t encodedSize;
+  uint64_t compressedSize;
+};
+
+// At the very end, so it is found without reading anything else.
+struct IndexFooter
+{
+  uint64_t indexOffset; // of the frame offsets, one per frame
+  uint64_t numFrames;
+  std::array<char, INDEX_MAGIC.size()> magic;
+  uint32_t padding;
+};
+
+// A particle with no match in the last frame is stored as the change from the one before it.
+constexpr auto NO_MATCH = UINT32_MAX;
+
+constexpr auto NUM_POSITION_COMPONENTS = 3U; // the fourth is padding
+constexpr auto NUM_COLOR_CHANNELS      = 4U;
+constexpr auto BITS_PER_CHANNEL        = 8U;
+constexpr auto CHANNEL_MASK            = 0xFFU;
+
+constexpr auto VARINT_BITS      = 7U;
+constexpr auto VARINT_MASK      = 0x7FU;
+constexpr auto VARINT_MORE      = 0x80U;
+constexpr auto MAX_VARINT_SHIFT = 28U;
+
+// Zero bytes are stored as a zero then how many follow it, up to a byte's worth.
+constexpr auto MAX_ZERO_RUN = 256U;
+// What a frame's sizes can't be past, so a corrupt frame isn't taken as a huge one.
+constexpr auto MAX_EXPANSION        = MAX_ZERO_RUN / 2U;
+constexpr auto MIN_ENCODED_PARTICLE = 1U + NUM_POSITION_COMPONENTS + NUM_COLOR_CHANNELS;
+
+template<typename T>
+auto WriteValue(std::ofstream& file, const T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+auto ReadValue(std::ifstream& file, T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template<typename T>
+auto WriteArray(std::ofstream& file, const std::span<const T> values) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(values.data()),
+             static_cast<std::streamsize>(values.size_bytes()));
+}
+
+template<typename T>
+auto ReadArray(std::ifstream& file, const std::span<T> values) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(values.data()),
+            static_cast<std::streamsize>(values.size_bytes()));
+}
+
+// Seven bits a byte, low first, so small numbers take one byte.
+auto AppendVarint(std::vector<uint8_t>& bytes, uint32_t value) -> void
+{
+  while (value > VARINT_MASK)
+  {
+    bytes.push_back(static_cast<uint8_t>((value & VARINT_MASK) | VARINT_MORE));
+    value >>= VARINT_BITS;
+  }
+  bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Small changes either way become small numbers: 0, -1, 1, -2 ... to 0, 1, 2, 3 ...
+[[nodiscard]] constexpr auto ZigZag(const int32_t value) noexcept -> uint32_t
+{
+  return (static_cast<uint32_t>(value) << 1U) ^ static_cast<uint32_t>(value >> 31U);
+}
+
+[[nodiscard]] constexpr auto UnZigZag(const uint32_t value) noexcept -> int32_t
+{
+  return static_cast<int32_t>((value >> 1U) ^ (0U - (value & 1U)));
+}
+
+// Reads encoded bytes, noting rather than throwing on reading past the end, which is checked
+// once a frame is decoded.
+class ByteReader
+{
+public:
+  explicit ByteReader(const std::span<const uint8_t> bytes) noexcept : m_bytes{bytes} {}
+
+  [[nodiscard]] auto IsGood() const noexcept -> bool { return not m_overrun; }
+  [[nodiscard]] auto IsAtEnd() const noexcept -> bool { return m_position == m_bytes.size(); }
+
+  auto ReadByte() noexcept -> uint8_t
+  {
+    if (m_position == m_bytes.size())
+    {
+      m_overrun = true;
+      return 0U;
+    }
+    return m_bytes[m_position++];
+  }
+
+  auto ReadVarint() noexcept -> uint32_t
+  {
+    auto value = 0U;
+    for (auto shift = 0U; shift <= MAX_VARINT_SHIFT; shift += VARINT_BITS)
+    {
+      const auto byte = ReadByte();
+      value |= (byte & VARINT_MASK) << shift;
+      if (0U == (byte & VARINT_MORE))
+      {
+        return value;
+      }
+    }
+    m_overrun = true; // too long to be a 'uint32_t'
+    return value;
+  }
+
+private:
+  std::span<const uint8_t> m_bytes;
+  size_t m_position = 0U;
+  bool m_overrun    = false;
+};
+
+auto CompressZeroRuns(const std::span<const uint8_t> input, std::vector<uint8_t>& output) -> void
+{
+  output.clear();
+  output.reserve(input.size());
+  for (auto i = size_t{0U}; i < input.size();)
+  {
+    if (0U != input[i])
+    {
+      output.push_back(input[i++]);
+      continue;
+    }
+    auto run = size_t{1U};
+    while ((run < MAX_ZERO_RUN) and ((i + run) < input.size()) and (0U == input[i + run]))
+    {
+      ++run;
+    }
+    output.push_back(0U);
+    output.push_back(static_cast<uint8_t>(run - 1U));
+    i += run;
+  }
+}
+
+// Returns false if the input ends inside a run.
+[[nodiscard]] auto DecompressZeroRuns(const std::span<const uint8_t> input,
+                                      std::vector<uint8_t>& output) -> bool
+{
+  output.clear();
+  for (auto i = size_t{0U}; i < input.size(); ++i)
+  {
+    if (0U != input[i])
+    {
+      output.push_back(input[i]);
+      continue;
+    }
+    if (++i == input.size())
+    {
+      return false;
+    }
+    output.insert(output.end(), size_t{input[i]} + 1U, uint8_t{0U});
+  }
+  return true;
+}
+
+// Both lists are in increasing id order, so one walk through them matches every particle. Ids
+// that have wrapped around are just the lowest, and are unique in both frames all the same.
+auto MatchIds(const std::span<const uint32_t> ids,
+              const std::span<const uint32_t> previousIds,
+              std::vector<uint32_t>& matches) -> void
+{
+  matches.resize(ids.size());
+  auto previous = size_t{0U};
+  for (auto i = size_t{0U}; i < ids.size(); ++i)
+  {
+    while ((previous < previousIds.size()) and (previousIds[previous] < ids[i]))
+    {
+      ++previous;
+    }
+    const auto isMatch = (previous < previousIds.size()) and (previousIds[previous] == ids[i]);
+    matches[i]         = isMatch ? static_cast<uint32_t>(previous) : NO_MATCH;
+  }
+}
+
+// What particle 'i' is stored as the change from, given the particles before it in its frame.
+[[nodiscard]] auto GetBase(const std::span<const uint32_t> matches,
+                           const std::span<const Vertex> previousVertices,
+                           const std::span<const Vertex> vertices,
+                           const size_t i) noexcept -> const Vertex&
+{
+  static constexpr auto ZERO = Vertex{};
+  if (NO_MATCH != matches[i])
+  {
+    return previousVertices[matches[i]];
+  }
+  return (i > 0U) ? vertices[i - 1U] : ZERO;
+}
+
+// The ids, then each position component and color channel for all the particles, so that the
+// bytes alike are together.
+auto EncodeFrame(const std::span<const uint32_t> ids,
+                 const std::span<const Vertex> vertices,
+                 const std::span<const uint32_t> matches,
+                 const std::span<const Vertex> previousVertices,
+                 std::vector<uint8_t>& encoded) -> void
+{
+  encoded.clear();
+
+  auto previousId = UINT32_MAX; // so the first gap is the first id
+  for (const auto id : ids)
+  {
+    AppendVarint(encoded, id - previousId - 1U);
+    previousId = id;
+  }
+
+  for (auto component = 0U; component < NUM_POSITION_COMPONENTS; ++component)
+  {
+    for (auto i = size_t{0U}; i < ids.size(); ++i)
+    {
+      const auto& base  = GetBase(matches, previousVertices, vertices, i);
+      const auto change = static_cast<int32_t>(vertices[i].position.at(component)) -
+                          static_cast<int32_t>(base.position.at(component));
+      AppendVarint(encoded, ZigZag(change));
+    }
+  }
+
+  for (auto channel = 0U; channel < NUM_COLOR_CHANNELS; ++channel)
+  {
+    const auto shift = channel * BITS_PER_CHANNEL;
+    for (auto i = size_t{0U}; i < ids.size(); ++i)
+    {
+      const auto& base = GetBase(matches, previousVertices, vertices, i);
+      encoded.push_back(static_cast<uint8_t>(((vertices[i].color >> shift) & CHANNEL_MASK) -
+                                             ((base.color >> shift) & CHANNEL_MASK)));
+    }
+  }
+}
+
+// Returns false if the bytes don't hold exactly the frame's particles.
+[[nodiscard]] auto DecodeFrameBytes(const std::span<const uint8_t> encoded,
+                                    const RecordedFrame& previousFrame,
+                                    const bool isKeyFrame,
+                                    RecordedFrame& frame,
+                                    std::vector<uint32_t>& matches) -> bool
+{
+  auto reader = ByteReader{encoded};
+
+  auto previousId = UINT32_MAX;
+  for (auto& id : frame.ids)
+  {
+    id         = previousId + 1U + reader.ReadVarint();
+    previousId = id;
+  }
+
+  if (isKeyFrame)
+  {
+    matches.assign(frame.ids.size(), NO_MATCH);
+  }
+  else
+  {
+    MatchIds(frame.ids, previousFrame.ids, matches);
+  }
+
+  const auto previousVertices = std::span<const Vertex>{previousFrame.vertices};
+  const auto vertices         = std::span<const Vertex>{frame.vertices};
+  for (auto component = 0U; component < NUM_POSITION_COMPONENTS; ++component)
+  {
+    for (auto i = size_t{0U}; i < frame.ids.size(); ++i)
+    {
+      const auto& base = GetBase(matches, previousVertices, vertices, i);
+      const auto value = static_cast<int32_t>(base.position.at(component)) +
+                         UnZigZag(reader.ReadVarint());
+      frame.vertices[i].position.at(component) = static_cast<uint16_t>(value);
+    }
+  }
+
+  for (auto& vertex : frame.vertices)
+  {
+    vertex.color = 0U;
+  }
+  for (auto channel = 0U; channel < NUM_COLOR_CHANNELS; ++channel)
+  {
+    const auto shift = channel * BITS_PER_CHANNEL;
+    for (auto i = size_t{0U}; i < frame.ids.size(); ++i)
+    {
+      const auto& base = GetBase(matches, previousVertices, vertices, i);
+      const auto value = (((base.color >> shift) & CHANNEL_MASK) + reader.ReadByte()) &
+                         CHANNEL_MASK;
+      frame.vertices[i].color |= value << shift;
+    }
+  }
+
+  return reader.IsGood() and reader.IsAtEnd();
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder(const std::filesystem::path& filename,
+                             const FrameRecorderSettings& settings)
+  : m_filename{filename},
+    m_settings{settings},
+    m_file{filename, std::ios::binary},
+    m_buffers(std::max(settings.numBufferedFrames, 1U))
+{
+  m_settings.keyFrameInterval = std::max(m_settings.keyFrameInterval, 1U);
+
+  const auto& boundsMin = m_settings.boundsMin;
+  const auto& boundsMax = m_settings.boundsMax;
+  const auto header     = FileHeader{
+      .magic            = FILE_MAGIC,
+      .keyFrameInterval = m_settings.keyFrameInterval,
+      .boundsMin        = {boundsMin[0], boundsMin[1], boundsMin[2], 0.0F},
+      .boundsMax        = {boundsMax[0], boundsMax[1], boundsMax[2], 0.0F},
+  };
+  WriteValue(m_file, header);
+  if (not m_file)
+  {
+    throw std::runtime_error("Could not create frame recording file '" + filename.string() +
+                             "'.");
+  }
+  m_fileSize = sizeof(FileHeader);
+
+  m_writer = std::jthread{[this]() { WriterLoop(); }};
+}
+
+FrameRecorder::~FrameRecorder() noexcept
+{
+  try
+  {
+    Close();
+  }
+  catch (const std::runtime_error&)
+  {
+    // Nothing to tell, call 'Close' to find out.
+  }
+}
+
+auto FrameRecorder::Capture(const ParticleData& particleData, const double time) noexcept -> bool
+{
+  auto* frame = static_cast<CapturedFrame*>(nullptr);
+  {
+    const auto lock = std::scoped_lock{m_mutex};
+    if (m_closed or ((m_numCaptured - m_numWritten) == m_buffers.size()))
+    {
+      ++m_numDropped;
+      return false;
+    }
+    frame = &m_buffers[m_numCaptured % m_buffers.size()];
+  }
+
+  // The buffer is ours until it is counted as captured.
+  const auto numAlive = particleData.GetAliveCount();
+  // Only ever grown, so capturing stops allocating once the particle count has peaked.
+  if (frame->ids.size() < numAlive)
+  {
+    frame->ids.resize(numAlive);
+    frame->vertices.resize(numAlive);
+  }
+  frame->time         = time;
+  frame->numParticles = numAlive;
+  std::ranges::copy(particleData.GetIds().first(numAlive), frame->ids.begin());
+  QuantizedPositionColorFormat::Write(
+      particleData,
+      {.boundsMin = m_settings.boundsMin, .boundsMax = m_settings.boundsMax},
+      {.start = 0U, .end = numAlive},
+      std::span{frame->vertices}.first(numAlive));
+
+  {
+    const auto lock = std::scoped_lock{m_mutex};
+    ++m_numCaptured;
+  }
+  m_frameCaptured.notify_one();
+  return true;
+}
+
+auto FrameRecorder::Close() -> void
+{
+  {
+    const auto lock = std::scoped_lock{m_mutex};
+    if (m_closed)
+    {
+      return;
+    }
+    m_closed   = true;
+    m_stopping = true;
+  }
+  m_frameCaptured.notify_one();
+  m_writer.join();
+
+  const auto footer = IndexFooter{
+      .indexOffset = m_fileSize,
+      .numFrames   = m_frameOffsets.size(),
+      .magic       = INDEX_MAGIC,
+      .padding     = 0U,
+  };
+  WriteArray(m_file, std::span<const uint64_t>{m_frameOffsets});
+  WriteValue(m_file, footer);
+  m_fileSize += (m_frameOffsets.size() * sizeof(uint64_t)) + sizeof(IndexFooter);
+  m_file.close();
+
+  if (m_writeFailed or (not m_file))
+  {
+    throw std::runtime_error("Could not write frame recording file '" + m_filename.string() +
+                             "'.");
+  }
+}
+
+auto FrameRecorder::WriterLoop() noexcept -> void
+{
+  while (true)
+  {
+    auto* frame = static_cast<CapturedFrame*>(nullptr);
+    {
+      auto lock = std::unique_lock{m_mutex};
+      m_frameCaptured.wait(lock,
+                           [this]() { return m_stopping or (m_numWritten < m_numCaptured); });
+      if (m_numWritten == m_numCaptured)
+      {
+        return; // stopping, with everything written
+      }
+      frame = &m_buffers[m_numWritten % m_buffers.size()];
+    }
+
+    WriteFrame(*frame);
+
+    const auto lock = std::scoped_lock{m_mutex};
+    ++m_numWritten;
+  }
+}
+
+auto FrameRecorder::WriteFrame(CapturedFrame& frame) noexcept -> void
+{
+  if (m_writeFailed)
+  {
+    return;
+  }
+
+  // In id order, to match the particles with the last frame's in one walk.
+  const auto numParticles = frame.numParticles;
+  m_radixSort.SortIndices(std::span{frame.ids}.first(numParticles), m_order);
+  m_ids.resize(numParticles);
+  m_vertices.resize(numParticles);
+  for (auto i = size_t{0U}; i < numParticles; ++i)
+  {
+    m_ids[i]      = frame.ids[m_order[i]];
+    m_vertices[i] = frame.vertices[m_order[i]];
+  }
+
+  const auto isKeyFrame = (0U == (m_frameOffsets.size() % m_settings.keyFrameInterval));
+  if (isKeyFrame)
+  {
+    m_matches.assign(numParticles, NO_MATCH);
+  }
+  else
+  {
+    MatchIds(m_ids, m_previousIds, m_matches);
+  }
+
+  // Allocating can throw, but after the first frames the vectors are big enough.
+  try
+  {
+    EncodeFrame(m_ids, m_vertices, m_matches, m_previousVertices, m_encoded);
+    CompressZeroRuns(m_encoded, m_compressed);
+  }
+  catch (const std::bad_alloc&)
+  {
+    m_writeFailed = true;
+    return;
+  }
+
+  const auto header = FrameHeader{
+      .time           = frame.time,
+      .numParticles   = static_cast<uint32_t>(numParticles),
+      .isKeyFrame     = isKeyFrame ? 1U : 0U,
+      .encodedSize    = m_encoded.size(),
+      .compressedSize = m_compressed.size(),
+  };
+  WriteValue(m_file, header);
+  WriteArray(m_file, std::span<const uint8_t>{m_compressed});
+  if (not m_file)
+  {
+    m_writeFailed = true;
+    return;
+  }
+
+  m_frameOffsets.push_back(m_fileSize);
+  m_fileSize += sizeof(FrameHeader) + m_compressed.size();
+  m_previousIds.swap(m_ids);
+  m_previousVertices.swap(m_vertices);
+}
+
+FrameReader::FrameReader(const std::filesystem::path& filename)
+  : m_filename{filename}, m_file{filename, std::ios::binary}
+{
+  if (not m_file)
+  {
+    throw std::runtime_error("Could not open frame recording file '" + filename.string() + "'.");
+  }
+
+  auto header = FileHeader{};
+  ReadValue(m_file, header);
+  if ((not m_file) or (header.magic != FILE_MAGIC) or (0U == header.keyFrameInterval))
+  {
+    throw std::runtime_error("Not a frame recording file '" + filename.string() + "'.");
+  }
+  m_settings.keyFrameInterval = header.keyFrameInterval;
+  m_settings.boundsMin = {header.boundsMin[0], header.boundsMin[1], header.boundsMin[2], 0.0F};
+  m_settings.boundsMax = {header.boundsMax[0], header.boundsMax[1], header.boundsMax[2], 0.0F};
+
+  auto footer = IndexFooter{};
+  m_file.seekg(-static_cast<std::streamoff>(sizeof(IndexFooter)), std::ios::end);
+  const auto footerOffset = static_cast<uint64_t>(m_file.tellg());
+  ReadValue(m_file, footer);
+  if ((not m_file) or (footer.magic != INDEX_MAGIC) or (footer.indexOffset > footerOffset) or
+      ((footerOffset - footer.indexOffset) != (footer.numFrames * sizeof(uint64_t))))
+  {
+    throw std::runtime_error("Frame recording file '" + filename.string() +
+                             "' is truncated or was not closed.");
+  }
+
+  m_indexOffset = footer.indexOffset;
+  m_frameOffsets.resize(footer.numFrames);
+  m_file.seekg(static_cast<std::streamoff>(footer.indexOffset));
+  ReadArray(m_file, std::span{m_frameOffsets});
+  // In order, each with room for its header, so a frame's size is bounded by the next one.
+  auto end = uint64_t{sizeof(FileHeader)};
+  for (const auto offset : m_frameOffsets)
+  {
+    if ((offset < end) or ((m_indexOffset - offset) < sizeof(FrameHeader)))
+    {
+      m_file.setstate(std::ios::failbit);
+      break;
+    }
+    end = offset + sizeof(FrameHeader);
+  }
+  if (not m_file)
+  {
+    throw std::runtime_error("Frame recording file '" + filename.string() + "' is truncated.");
+  }
+}
+
+auto FrameReader::ReadFrame(const size_t frame) -> const RecordedFrame&
+{
+  if (frame >= m_frameOffsets.size())
+  {
+    throw std::runtime_error("Frame recording file '" + m_filename.string() + "' has no frame " +
+                             std::to_string(frame) + ".");
+  }
+  if (m_decodedFrame == frame)
+  {
+    return m_frame;
+  }
+
+  // Frames are stored as changes from the one before, back to the last key frame.
+  const auto keyFrame   = frame - (frame % m_settings.keyFrameInterval);
+  const auto isOnTheWay = m_decodedFrame.has_value() and (*m_decodedFrame >= keyFrame) and
+                          (*m_decodedFrame < frame);
+  for (auto next = isOnTheWay ? (*m_decodedFrame + 1U) : keyFrame; next <= frame; ++next)
+  {
+    DecodeFrame(next);
+  }
+  return m_frame;
+}
+
+auto FrameReader::DecodeFrame(const size_t frame) -> void
+{
+  m_decodedFrame.reset(); // until it is decoded whole
+  const auto corrupt = [this, frame]()
+  {
+    throw std::runtime_error("Frame " + std::to_string(frame) + " of frame recording file '" +
+                             m_filename.string() + "' is corrupt.");
+  };
+
+  auto header = FrameHeader{};
+  m_file.clear();
+  m_file.seekg(static_cast<std::streamoff>(m_frameOffsets[frame]));
+  ReadValue(m_file, header);
+  const auto isKeyFrame = (0U == (frame % m_settings.keyFrameInterval));
+  const auto frameEnd =
+      ((frame + 1U) < m_frameOffsets.size()) ? m_frameOffsets[frame + 1U] : m_indexOffset;
+  if ((not m_file) or ((1U == header.isKeyFrame) != isKeyFrame) or
+      (header.compressedSize > (frameEnd - m_frameOffsets[frame] - sizeof(FrameHeader))) or
+      (header.encodedSize > (header.compressedSize * MAX_EXPANSION)) or
+      ((uint64_t{header.numParticles} * MIN_ENCODED_PARTICLE) > header.encodedSize))
+  {
+    corrupt();
+  }
+
+  m_compressed.resize(header.compressedSize);
+  ReadArray(m_file, std::span{m_compressed});
+  if ((not m_file) or (not DecompressZeroRuns(m_compressed, m_encoded)) or
+      (m_encoded.size() != header.encodedSize))
+  {
+    corrupt();
+  }
+
+  std::swap(m_previousFrame, m_frame);
+  m_frame.time = header.time;
+  m_frame.ids.resize(header.numParticles);
+  m_frame.vertices.resize(header.numParticles);
+  if (not DecodeFrameBytes(m_encoded, m_previousFrame, isKeyFrame, m_frame, m_matches))
+  {
+    corrupt();
+  }
+  m_decodedFrame = frame;
+}
+
+} // namespace PARTICLES
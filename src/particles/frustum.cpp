@@ -0,0 +1,48 @@
+module;
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+module Particles.Frustum;
+
+namespace PARTICLES
+{
+
+namespace
+{
+
+[[nodiscard]] auto GetNormalizedPlane(const glm::vec4& plane) noexcept -> glm::vec4
+{
+  return plane / glm::length(glm::vec3{plane});
+}
+
+} // namespace
+
+// Gribb and Hartmann's plane extraction.
+auto Frustum::FromViewProjection(const glm::mat4& viewProjection) noexcept -> Frustum
+{
+  const auto getRow = [&viewProjection](const int row)
+  {
+    return glm::vec4{viewProjection[0][row],
+                     viewProjection[1][row],
+                     viewProjection[2][row],
+                     viewProjection[3][row]};
+  };
+  const auto row0 = getRow(0);
+  const auto row1 = getRow(1);
+  const auto row2 = getRow(2);
+  const auto row3 = getRow(3);
+
+  return Frustum{{
+      GetNormalizedPlane(row3 + row0), // left
+      GetNormalizedPlane(row3 - row0), // right
+      GetNormalizedPlane(row3 + row1), // bottom
+      GetNormalizedPlane(row3 - row1), // top
+      GetNormalizedPlane(row3 + row2), // near
+      GetNormalizedPlane(row3 - row2), // far
+  }};
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,91 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+module Particles.Parallel;
+
+namespace PARTICLES
+{
+
+Parallel::Parallel(const uint32_t numThreads)
+  : m_numThreads{0U == numThreads ? std::max(1U, std::thread::hardware_concurrency())
+                                  : numThreads}
+{
+  m_workers.reserve(m_numThreads - 1);
+  for (auto chunk = 1U; chunk < m_numThreads; ++chunk)
+  {
+    m_workers.emplace_back([this, chunk]() { WorkerLoop(chunk); });
+  }
+}
+
+Parallel::~Parallel() noexcept
+{
+  {
+    const auto lock = std::scoped_lock{m_mutex};
+    m_stopping      = true;
+  }
+  m_startLoop.notify_all();
+  m_workers.clear(); // joins them, while the mutex and condition variables are still there
+}
+
+auto Parallel::ForLoop(const size_t numIterations, const LoopFunc& loopFunc) noexcept -> void
+{
+  if (m_workers.empty())
+  {
+    loopFunc(0U, 0U, numIterations);
+    return;
+  }
+
+  {
+    const auto lock  = std::scoped_lock{m_mutex};
+    m_loopFunc       = &loopFunc;
+    m_numIterations  = numIterations;
+    m_numBusyWorkers = static_cast<uint32_t>(m_workers.size());
+    ++m_loopGeneration;
+  }
+  m_startLoop.notify_all();
+
+  const auto [begin, end] = GetChunkRange(0U, m_numThreads, numIterations);
+  loopFunc(0U, begin, end);
+
+  auto lock = std::unique_lock{m_mutex};
+  m_loopDone.wait(lock, [this]() { return 0U == m_numBusyWorkers; });
+  m_loopFunc = nullptr;
+}
+
+auto Parallel::WorkerLoop(const uint32_t chunk) noexcept -> void
+{
+  auto lastGeneration = uint64_t{0U};
+
+  while (true)
+  {
+    auto lock = std::unique_lock{m_mutex};
+    m_startLoop.wait(lock,
+                     [this, lastGeneration]()
+                     { return m_stopping or (m_loopGeneration != lastGeneration); });
+    if (m_stopping)
+    {
+      return;
+    }
+    lastGeneration           = m_loopGeneration;
+    const auto* const func   = m_loopFunc;
+    const auto numIterations = m_numIterations;
+    lock.unlock();
+
+    const auto [begin, end] = GetChunkRange(chunk, m_numThreads, numIterations);
+    (*func)(chunk, begin, end);
+
+    lock.lock();
+    --m_numBusyWorkers;
+    if (0U == m_numBusyWorkers)
+    {
+      m_loopDone.notify_one();
+    }
+  }
+}
+
+} // namespace PARTICLES
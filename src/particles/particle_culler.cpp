@@ -0,0 +1,104 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+module Particles.ParticleCuller;
+
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+auto ParticleCuller::Cull(const ParticleData& particleData, const Frustum& viewFrustum) noexcept
+    -> std::span<const uint32_t>
+{
+  // The radius is folded into the distance terms, so the test is the same few multiply-adds
+  // for every particle.
+  auto planes = viewFrustum.GetPlanes();
+  for (auto& plane : planes)
+  {
+    plane.w += m_radius; // NOLINT(cppcoreguidelines-pro-type-union-access)
+  }
+
+  const auto numAlive  = particleData.GetAliveCount();
+  const auto positions = particleData.GetPositions();
+  const auto numChunks = ((nullptr == m_parallel) or (numAlive < MIN_PARALLEL_SIZE))
+                             ? 1U
+                             : m_parallel->GetNumThreads();
+
+  // Only ever grown, as growing it back after shrinking it to the visible ones would clear it.
+  if (m_visible.size() < numAlive)
+  {
+    m_visible.resize(numAlive);
+  }
+  m_chunkNumVisible.assign(numChunks, 0U);
+
+  // Each chunk lists its visible particles from the start of its own part of the list. The
+  // index is written whether or not the particle is visible and only kept by moving on, so
+  // the loop has no branches.
+  const auto cullChunk =
+      [visible = std::span{m_visible}, &chunkNumVisible = m_chunkNumVisible, positions, &planes](
+          const uint32_t chunk, const size_t begin, const size_t end)
+  {
+    auto numVisible = begin;
+    for (auto i = begin; i < end; ++i)
+    {
+      const auto position   = glm::vec3{positions[i]};
+      const auto distanceTo = [&position](const glm::vec4& plane)
+      {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+        return glm::dot(glm::vec3{plane}, position) + plane.w;
+      };
+
+      // Written out, as a loop over the planes is left a loop.
+      static_assert(6U == Frustum::NUM_PLANES);
+      const auto leftRight   = glm::min(distanceTo(planes[0]), distanceTo(planes[1]));
+      const auto bottomTop   = glm::min(distanceTo(planes[2]), distanceTo(planes[3]));
+      const auto nearFar     = glm::min(distanceTo(planes[4]), distanceTo(planes[5]));
+      const auto minDistance = glm::min(glm::min(leftRight, bottomTop), nearFar);
+
+      visible[numVisible] = static_cast<uint32_t>(i);
+      numVisible += (minDistance >= 0.0F) ? 1U : 0U;
+    }
+    chunkNumVisible[chunk] = numVisible - begin;
+  };
+
+  if (1U == numChunks)
+  {
+    cullChunk(0U, 0U, numAlive);
+  }
+  else
+  {
+    m_parallel->ForLoop(numAlive, cullChunk);
+  }
+
+  // Close the gaps between the chunks' lists.
+  auto numVisible = m_chunkNumVisible[0];
+  for (auto chunk = 1U; chunk < numChunks; ++chunk)
+  {
+    const auto chunkBegin = Parallel::GetChunkRange(chunk, numChunks, numAlive).begin;
+    if (chunkBegin != numVisible)
+    {
+      std::copy_n(m_visible.begin() + static_cast<std::ptrdiff_t>(chunkBegin),
+                  m_chunkNumVisible[chunk],
+                  m_visible.begin() + static_cast<std::ptrdiff_t>(numVisible));
+    }
+    numVisible += m_chunkNumVisible[chunk];
+  }
+  m_numVisible = numVisible;
+
+  return GetVisible();
+}
+
+} // namespace PARTICLES
@@ -1,7 +1,6 @@
 module;
 
 #include <glm/common.hpp>
-#include <glm/gtc/random.hpp>
 #include <glm/vec4.hpp>
 
 #ifndef M_PI
@@ -11,6 +10,7 @@ module;
 module Particles.ParticleGenerators;
 
 import Particles.Particles;
+import Particles.Random;
 
 namespace PARTICLES::GENERATORS
 {
@@ -39,7 +39,7 @@ auto BoxPositionGenerator::Generate([[maybe_unused]] const double dt,
 
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    particleData.SetPosition(i, glm::linearRand(posMin, posMax));
+    particleData.SetPosition(i, GetRandom().Uniform(posMin, posMax));
   }
 }
 
@@ -58,7 +58,7 @@ auto RoundPositionGenerator::Generate([[maybe_unused]] const double dt,
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
     // TODO(glk) - Need '2.01' instead of '2.0' to cover small radial gap (see tunnel effect).
-    const auto ang = glm::linearRand(0.0, M_PI * 2.01);
+    const auto ang = GetRandom().Uniform(0.0, M_PI * 2.01);
     particleData.SetPosition(i,
                              m_center + glm::vec4(static_cast<double>(m_xRadius) * std::sin(ang),
                                                   static_cast<double>(m_yRadius) * std::cos(ang),
@@ -85,8 +85,8 @@ auto BasicColorGenerator::Generate([[maybe_unused]] const double dt,
 {
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    particleData.SetStartColor(i, glm::linearRand(m_minStartColor, m_maxStartColor));
-    particleData.SetEndColor(i, glm::linearRand(m_minEndColor, m_maxEndColor));
+    particleData.SetStartColor(i, GetRandom().Uniform(m_minStartColor, m_maxStartColor));
+    particleData.SetEndColor(i, GetRandom().Uniform(m_minEndColor, m_maxEndColor));
   }
 }
 
@@ -103,7 +103,7 @@ auto BasicVelocityGenerator::Generate([[maybe_unused]] const double dt,
 {
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    particleData.SetVelocity(i, glm::linearRand(m_minStartVelocity, m_maxStartVelocity));
+    particleData.SetVelocity(i, GetRandom().Uniform(m_minStartVelocity, m_maxStartVelocity));
   }
 }
 
@@ -120,9 +120,9 @@ auto SphereVelocityGenerator::Generate([[maybe_unused]] const double dt,
 {
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    const auto phi      = static_cast<float>(glm::linearRand(-M_PI, M_PI));
-    const auto theta    = static_cast<float>(glm::linearRand(-M_PI, M_PI));
-    const auto velocity = glm::linearRand(m_minVelocity, m_maxVelocity);
+    const auto phi      = static_cast<float>(GetRandom().Uniform(-M_PI, M_PI));
+    const auto theta    = static_cast<float>(GetRandom().Uniform(-M_PI, M_PI));
+    const auto velocity = GetRandom().Uniform(m_minVelocity, m_maxVelocity);
     const auto radius   = velocity * std::sin(phi);
 
     particleData.SetVelocity(i,
@@ -149,7 +149,7 @@ auto VelocityFromPositionGenerator::Generate([[maybe_unused]] const double dt,
 {
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    const auto scale = glm::linearRand(m_minScale, m_maxScale);
+    const auto scale = GetRandom().Uniform(m_minScale, m_maxScale);
     const auto vel   = glm::vec4{particleData.GetPosition(i) - m_offset};
     particleData.SetVelocity(i, scale * vel);
   }
@@ -167,7 +167,7 @@ auto BasicTimeGenerator::Generate([[maybe_unused]] const double dt,
 {
   for (auto i = idRange.start; i < idRange.end; ++i)
   {
-    const auto xyTime = glm::linearRand(m_minTime, m_maxTime);
+    const auto xyTime = GetRandom().Uniform(m_minTime, m_maxTime);
 
     particleData.SetTime(i, {xyTime, xyTime, 0.0F, 1.0F / xyTime});
   }
@@ -1,12 +1,33 @@
 module;
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
 #include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/gtc/random.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
 
 module Particles.ParticleUpdaters;
 
+import Particles.AttractorOctree;
+import Particles.Colliders;
+import Particles.Parallel;
 import Particles.Particles;
+import Particles.RadixSort;
+import Particles.SpatialGrid;
+import Particles.VectorGrid;
 
 namespace PARTICLES::UPDATERS
 {
@@ -45,36 +66,227 @@ namespace
   return scaledVales;
 }
 
+// Moves a particle 'distance' deep in a solid out along the surface 'normal', reflects its
+// velocity into the surface, scaled by 'bounceFactor', and scales its velocity along the
+// surface by one minus 'friction'. Slow particles are put to sleep.
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+auto RespondToContact(ParticleData& particleData,
+                      const size_t i,
+                      const float distance,
+                      const glm::vec4& normal,
+                      const float bounceFactor,
+                      const float friction,
+                      const float sleepSpeedSq) noexcept -> void
+{
+  particleData.SetPosition(i, particleData.GetPosition(i) - (distance * normal));
+
+  const auto& velocity    = particleData.GetVelocity(i);
+  const auto normalFactor = glm::dot(glm::vec3{velocity}, glm::vec3{normal});
+  if (normalFactor >= 0.0F)
+  {
+    return; // already leaving
+  }
+
+  const auto normalVelocity  = normalFactor * normal;
+  const auto tangentVelocity = velocity - normalVelocity;
+  auto newVelocity = ((1.0F - friction) * tangentVelocity) - (bounceFactor * normalVelocity);
+  newVelocity.w    = velocity.w;
+
+  if (glm::dot(glm::vec3{newVelocity}, glm::vec3{newVelocity}) < sleepSpeedSq)
+  {
+    particleData.SetVelocity(i, {0.0F, 0.0F, 0.0F, velocity.w});
+    particleData.RequestSleep(i);
+    return;
+  }
+  particleData.SetVelocity(i, newVelocity);
+}
+
+// Puts two zero bits after each of the low ten bits, for interleaving three coordinates.
+[[nodiscard]] auto SpreadMortonBits(uint32_t value) noexcept -> uint32_t
+{
+  struct Step
+  {
+    uint32_t shift;
+    uint32_t mask;
+  };
+  static constexpr auto STEPS = std::array{
+      Step{.shift = 16U, .mask = 0x030000FFU},
+      Step{.shift = 8U, .mask = 0x0300F00FU},
+      Step{.shift = 4U, .mask = 0x030C30C3U},
+      Step{.shift = 2U, .mask = 0x09249249U},
+  };
+
+  for (const auto& step : STEPS)
+  {
+    value = (value | (value << step.shift)) & step.mask;
+  }
+  return value;
+}
+
 } // namespace
 
+auto IIntegratorUpdater::UpdateRange(const double dt,
+                                     ParticleData& particleData,
+                                     const IdRange& idRange) noexcept -> void
+{
+  const auto gatherStats  = particleData.IsGatheringStats();
+  const auto numParticles = idRange.end - idRange.start;
+
+  if ((nullptr == m_parallel) or (numParticles < MIN_PARALLEL_SIZE))
+  {
+    auto stats = ParticleStats{};
+    IntegrateRange(dt, particleData, idRange, gatherStats ? &stats : nullptr);
+    if (gatherStats)
+    {
+      particleData.MergeStats(stats);
+    }
+    return;
+  }
+
+  m_chunkStats.assign(m_parallel->GetNumThreads(), ParticleStats{});
+  m_parallel->ForLoop(
+      numParticles,
+      [this, dt, gatherStats, &particleData, &idRange](
+          const uint32_t chunk, const size_t begin, const size_t end)
+      {
+        IntegrateRange(dt,
+                       particleData,
+                       {.start = idRange.start + begin, .end = idRange.start + end},
+                       gatherStats ? &m_chunkStats[chunk] : nullptr);
+      });
+
+  if (gatherStats)
+  {
+    for (const auto& stats : m_chunkStats)
+    {
+      particleData.MergeStats(stats);
+    }
+  }
+}
+
 EulerUpdater::EulerUpdater(const glm::vec4& globalAcceleration) noexcept
   : m_globalAcceleration{globalAcceleration}
 {
 }
 
-auto EulerUpdater::Update(const double dt, ParticleData& particleData) noexcept -> void
+auto EulerUpdater::IntegrateRange(const double dt,
+                                  ParticleData& particleData,
+                                  const IdRange& idRange,
+                                  ParticleStats* const stats) const noexcept -> void
 {
   const auto globalAcceleration = glm::vec4{dt * static_cast<double>(m_globalAcceleration.x),
                                             dt * static_cast<double>(m_globalAcceleration.y),
                                             dt * static_cast<double>(m_globalAcceleration.z),
                                             0.0};
   const auto localDt            = static_cast<float>(dt);
-  const auto numAlive           = particleData.GetAliveCount();
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     particleData.IncAcceleration(i, globalAcceleration);
   }
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     particleData.IncVelocity(i, localDt * particleData.GetAcceleration(i));
   }
 
-  for (auto i = 0U; i < numAlive; ++i)
+  if (nullptr == stats)
+  {
+    for (auto i = idRange.start; i < idRange.end; ++i)
+    {
+      particleData.IncPosition(i, localDt * particleData.GetVelocity(i));
+    }
+    return;
+  }
+
+  // A local copy, as the compiler can't tell the particle writes don't change '*stats'.
+  auto rangeStats = *stats;
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     particleData.IncPosition(i, localDt * particleData.GetVelocity(i));
+    rangeStats.AddMotion(particleData.GetPosition(i), particleData.GetVelocity(i));
   }
+  *stats = rangeStats;
+}
+
+SemiImplicitEulerUpdater::SemiImplicitEulerUpdater(const glm::vec4& globalAcceleration) noexcept
+  : m_globalAcceleration{globalAcceleration.x, globalAcceleration.y, globalAcceleration.z, 0.0F}
+{
+}
+
+auto SemiImplicitEulerUpdater::IntegrateRange(const double dt,
+                                              ParticleData& particleData,
+                                              const IdRange& idRange,
+                                              ParticleStats* const stats) const noexcept -> void
+{
+  const auto localDt   = static_cast<float>(dt);
+  const auto integrate = [this, localDt, &particleData](const size_t i)
+  {
+    const auto acceleration = particleData.GetAcceleration(i) + m_globalAcceleration;
+
+    particleData.IncVelocity(i, localDt * acceleration);
+    particleData.IncPosition(i, localDt * particleData.GetVelocity(i));
+  };
+
+  if (nullptr == stats)
+  {
+    for (auto i = idRange.start; i < idRange.end; ++i)
+    {
+      integrate(i);
+    }
+    return;
+  }
+
+  auto rangeStats = *stats;
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    integrate(i);
+    rangeStats.AddMotion(particleData.GetPosition(i), particleData.GetVelocity(i));
+  }
+  *stats = rangeStats;
+}
+
+VelocityVerletUpdater::VelocityVerletUpdater(const glm::vec4& globalAcceleration) noexcept
+  : m_globalAcceleration{globalAcceleration.x, globalAcceleration.y, globalAcceleration.z, 0.0F}
+{
+}
+
+auto VelocityVerletUpdater::IntegrateRange(const double dt,
+                                           ParticleData& particleData,
+                                           const IdRange& idRange,
+                                           ParticleStats* const stats) const noexcept -> void
+{
+  const auto localDt            = static_cast<float>(dt);
+  const auto halfLocalDt        = 0.5F * localDt;
+  const auto readsAccelerations = ForceSource::GLOBAL_AND_UPDATERS == m_forceSource;
+  const auto integrate =
+      [this, localDt, halfLocalDt, readsAccelerations, &particleData](const size_t i)
+  {
+    const auto acceleration     = readsAccelerations
+                                      ? (particleData.GetAcceleration(i) + m_globalAcceleration)
+                                      : m_globalAcceleration;
+    const auto halfStepVelocity = particleData.GetVelocity(i) + (halfLocalDt * acceleration);
+
+    particleData.IncPosition(i, localDt * halfStepVelocity);
+    particleData.SetVelocity(i, halfStepVelocity + (halfLocalDt * acceleration));
+  };
+
+  if (nullptr == stats)
+  {
+    for (auto i = idRange.start; i < idRange.end; ++i)
+    {
+      integrate(i);
+    }
+    return;
+  }
+
+  auto rangeStats = *stats;
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    integrate(i);
+    rangeStats.AddMotion(particleData.GetPosition(i), particleData.GetVelocity(i));
+  }
+  *stats = rangeStats;
 }
 
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
@@ -83,63 +295,581 @@ FloorUpdater::FloorUpdater(const float floorY, const float bounceFactor) noexcep
 {
 }
 
-auto FloorUpdater::Update([[maybe_unused]] const double dt, ParticleData& particleData) noexcept
-    -> void
+auto FloorUpdater::UpdateRange([[maybe_unused]] const double dt,
+                               ParticleData& particleData,
+                               const IdRange& idRange) noexcept -> void
 {
-  const auto numAlive = particleData.GetAliveCount();
-
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     if (particleData.GetPosition(i).y >= m_floorY)
     {
       continue;
     }
 
-    auto force = glm::vec4{particleData.GetAcceleration(i)};
-    if (const auto normalFactor = glm::dot(force, glm::vec4(0.0F, 1.0F, 0.0F, 0.0F));
-        normalFactor < 0.0F)
-    {
-      force -= glm::vec4(0.0F, 1.0F, 0.0F, 0.0F) * normalFactor;
-    }
-
     const auto velFactor = glm::dot(particleData.GetVelocity(i), glm::vec4(0.0F, 1.0F, 0.0F, 0.0F));
     //if (velFactor < 0.0)
     particleData.DecVelocity(
         i, glm::vec4(0.0F, 1.0F, 0.0F, 0.0F) * (1.0F + m_bounceFactor) * velFactor);
 
-    particleData.SetAcceleration(i, force);
+    const auto& velocity = particleData.GetVelocity(i);
+    if (glm::dot(glm::vec3{velocity}, glm::vec3{velocity}) < m_sleepSpeedSq)
+    {
+      const auto& position = particleData.GetPosition(i);
+      particleData.SetPosition(i, {position.x, m_floorY, position.z, position.w});
+      particleData.SetVelocity(i, {0.0F, 0.0F, 0.0F, velocity.w});
+      particleData.RequestSleep(i);
+    }
+  }
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+ColliderUpdater::ColliderUpdater(std::shared_ptr<const ColliderSet> colliders,
+                                 const float bounceFactor,
+                                 const float friction) noexcept
+  : m_colliders{std::move(colliders)}, m_bounceFactor{bounceFactor}, m_friction{friction}
+{
+}
+
+auto ColliderUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                  ParticleData& particleData,
+                                  const IdRange& idRange) noexcept -> void
+{
+  const auto& colliders = *m_colliders;
+
+  // Nearly all particles are outside everything, and this pass is all they cost.
+  m_collidingIds.clear();
+  const auto positions = particleData.GetPositions();
+  colliders.FindInside(
+      positions.subspan(idRange.start, idRange.end - idRange.start), idRange.start, m_collidingIds);
+
+  for (const auto i : m_collidingIds)
+  {
+    const auto contact = colliders.GetContact(particleData.GetPosition(i));
+    RespondToContact(particleData,
+                     i,
+                     contact.distance,
+                     contact.normal,
+                     m_bounceFactor,
+                     m_friction,
+                     m_sleepSpeedSq);
+  }
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+DistanceFieldColliderUpdater::DistanceFieldColliderUpdater(
+    std::shared_ptr<const VectorGrid> distanceField,
+    const float bounceFactor,
+    const float friction) noexcept
+  : m_distanceField{std::move(distanceField)}, m_bounceFactor{bounceFactor}, m_friction{friction}
+{
+  // Interpolated distances are only negative in cells with a negative corner, so the box
+  // around those cells holds the whole solid.
+  assert((nullptr != m_distanceField) and (m_distanceField->GetResolution() >= 2U));
+  const auto& field     = *m_distanceField;
+  const auto resolution = field.GetResolution();
+  const auto spacing    = (field.GetBoundsMax() - field.GetBoundsMin()) /
+                       static_cast<float>(resolution - 1);
+
+  m_solidMin = glm::vec4{std::numeric_limits<float>::max()};
+  m_solidMax = glm::vec4{std::numeric_limits<float>::lowest()};
+  for (auto z = 0U; z < resolution; ++z)
+  {
+    for (auto y = 0U; y < resolution; ++y)
+    {
+      for (auto x = 0U; x < resolution; ++x)
+      {
+        if (field.GetValue(x, y, z).w < 0.0F)
+        {
+          const auto position = field.GetPointPosition(x, y, z);
+          m_solidMin          = glm::min(m_solidMin, position - spacing);
+          m_solidMax          = glm::max(m_solidMax, position + spacing);
+        }
+      }
+    }
+  }
+}
+
+auto DistanceFieldColliderUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                               ParticleData& particleData,
+                                               const IdRange& idRange) noexcept -> void
+{
+  const auto& field = *m_distanceField;
+
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    const auto& position = particleData.GetPosition(i);
+    if ((position.x < m_solidMin.x) or (position.x > m_solidMax.x) or
+        (position.y < m_solidMin.y) or (position.y > m_solidMax.y) or
+        (position.z < m_solidMin.z) or (position.z > m_solidMax.z))
+    {
+      continue;
+    }
+
+    const auto value = field.Sample(position);
+    if (value.w >= 0.0F)
+    {
+      continue;
+    }
+
+    // Interpolating unit gradients gives shorter ones.
+    auto normal = glm::vec4{value.x, value.y, value.z, 0.0F};
+    if (const auto length = glm::length(normal); length > 0.0F)
+    {
+      normal /= length;
+    }
+    else
+    {
+      normal = glm::vec4{0.0F, 1.0F, 0.0F, 0.0F};
+    }
+
+    RespondToContact(particleData, i, value.w, normal, m_bounceFactor, m_friction, m_sleepSpeedSq);
+  }
+}
+
+auto AttractorUpdater::UpdateOctree() noexcept -> void
+{
+  if (not m_octreeIsStale)
+  {
+    return;
+  }
+  m_octree.Build(m_attractorPositions);
+  m_octreeIsStale = false;
+}
+
+auto AttractorUpdater::GetAcceleration(const glm::vec4& position) noexcept -> glm::vec4
+{
+  if (AttractorEvaluation::EXACT == m_evaluation)
+  {
+    return AttractorOctree::GetExactAcceleration(position, m_attractorPositions);
+  }
+
+  UpdateOctree();
+  return m_octree.GetAcceleration(position, m_openingAngle);
+}
+
+auto AttractorUpdater::BakeForceField(const ForceFieldCacheSettings& settings,
+                                      const std::vector<glm::vec4>& attractorPositions,
+                                      const uint64_t fieldVersion)
+    -> std::shared_ptr<const BakedForceField>
+{
+  auto field = VectorGrid{settings.boundsMin, settings.boundsMax, settings.resolution};
+
+  const auto resolution = field.GetResolution();
+  for (auto z = 0U; z < resolution; ++z)
+  {
+    for (auto y = 0U; y < resolution; ++y)
+    {
+      for (auto x = 0U; x < resolution; ++x)
+      {
+        field.SetValue(x,
+                       y,
+                       z,
+                       AttractorOctree::GetExactAcceleration(field.GetPointPosition(x, y, z),
+                                                             attractorPositions));
+      }
+    }
+  }
+
+  // The field goes as 1/distance, so interpolation is poor close to an attractor - and
+  // undefined if one sits on a grid point. Checking each cell centre finds those cells.
+  auto exactCells = std::vector<uint8_t>(field.GetNumCells(), 0U);
+  for (auto z = 0U; z < resolution - 1; ++z)
+  {
+    for (auto y = 0U; y < resolution - 1; ++y)
+    {
+      for (auto x = 0U; x < resolution - 1; ++x)
+      {
+        const auto centre =
+            0.5F * (field.GetPointPosition(x, y, z) + field.GetPointPosition(x + 1, y + 1, z + 1));
+        const auto exact  = AttractorOctree::GetExactAcceleration(centre, attractorPositions);
+        const auto error  = glm::length(field.Sample(centre) - exact);
+        // Written so that NaNs count as too big.
+        if (not(error <= (settings.tolerance * glm::length(exact))))
+        {
+          exactCells[field.GetCellIndex(centre)] = 1U;
+        }
+      }
+    }
+  }
+  for (const auto& attractorPosition : attractorPositions)
+  {
+    if (field.IsInside(attractorPosition))
+    {
+      exactCells[field.GetCellIndex(attractorPosition)] = 1U;
+    }
+  }
+
+  auto bakedField = BakedForceField{.field        = std::move(field),
+                                    .exactCells   = std::move(exactCells),
+                                    .fieldVersion = fieldVersion};
+
+  return std::make_shared<const BakedForceField>(std::move(bakedField));
+}
+
+auto AttractorUpdater::UpdateForceFieldCache() noexcept -> void
+{
+  if (not m_cacheSettings.has_value())
+  {
+    return;
+  }
+  if (nullptr != m_bakedField)
+  {
+    if (m_bakedField->fieldVersion == m_fieldVersion)
+    {
+      return;
+    }
+    m_bakedField.reset();
+  }
+
+  if (m_pendingBake.valid())
+  {
+    if (m_pendingBake.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+    {
+      return;
+    }
+    auto bakedField = m_pendingBake.get();
+    if (bakedField->fieldVersion == m_fieldVersion)
+    {
+      m_bakedField = std::move(bakedField);
+      return;
+    }
+  }
+
+  if (not m_cacheSettings->bakeInBackground)
+  {
+    m_bakedField = BakeForceField(*m_cacheSettings, m_attractorPositions, m_fieldVersion);
+    return;
+  }
+  // The bake gets its own copy of the attractors, so they can keep changing meanwhile.
+  m_pendingBake = std::async(
+      std::launch::async, &BakeForceField, *m_cacheSettings, m_attractorPositions, m_fieldVersion);
+}
+
+auto AttractorUpdater::GetCachedAcceleration(const glm::vec4& position) noexcept -> glm::vec4
+{
+  const auto& field = m_bakedField->field;
+  if (not field.IsInside(position))
+  {
+    return GetAcceleration(position);
+  }
+
+  const auto location = field.GetLocation(position);
+  if (0U != m_bakedField->exactCells[field.GetCellIndex(location)])
+  {
+    return GetAcceleration(position);
+  }
+
+  return field.Sample(location);
+}
+
+auto AttractorUpdater::UpdateRangeWithCache(ParticleData& particleData,
+                                            const IdRange& idRange) noexcept -> void
+{
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    particleData.IncAcceleration(i, GetCachedAcceleration(particleData.GetPosition(i)));
+  }
+}
+
+auto AttractorUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                   ParticleData& particleData,
+                                   const IdRange& idRange) noexcept -> void
+{
+  UpdateForceFieldCache();
+  if (nullptr != m_bakedField)
+  {
+    UpdateRangeWithCache(particleData, idRange);
+    return;
+  }
+
+  if (AttractorEvaluation::BARNES_HUT == m_evaluation)
+  {
+    UpdateOctree();
+    for (auto i = idRange.start; i < idRange.end; ++i)
+    {
+      particleData.IncAcceleration(
+          i, m_octree.GetAcceleration(particleData.GetPosition(i), m_openingAngle));
+    }
+    return;
+  }
+
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    particleData.IncAcceleration(
+        i,
+        AttractorOctree::GetExactAcceleration(particleData.GetPosition(i), m_attractorPositions));
+  }
+}
+
+auto AttractorUpdater::MeasureApproximationError(const ParticleData& particleData,
+                                                 const size_t maxNumSamples) noexcept
+    -> AttractorErrorReport
+{
+  const auto numParticles = particleData.GetAwakeCount();
+  const auto numSamples   = std::min(numParticles, maxNumSamples);
+  if (0U == numSamples)
+  {
+    return {.numSamples = 0U, .meanRelativeError = 0.0, .maxRelativeError = 0.0};
+  }
+
+  auto sumError = 0.0;
+  auto maxError = 0.0;
+  for (auto sample = 0U; sample < numSamples; ++sample)
+  {
+    const auto& position = particleData.GetPosition((sample * numParticles) / numSamples);
+
+    const auto exact = AttractorOctree::GetExactAcceleration(position, m_attractorPositions);
+    const auto exactLength = static_cast<double>(glm::length(exact));
+    if (exactLength <= 0.0)
+    {
+      continue;
+    }
+    const auto approximate =
+        nullptr != m_bakedField ? GetCachedAcceleration(position) : GetAcceleration(position);
+    const auto error = static_cast<double>(glm::length(approximate - exact)) / exactLength;
+
+    sumError += error;
+    maxError = std::max(maxError, error);
   }
+
+  return {.numSamples        = numSamples,
+          .meanRelativeError = sumError / static_cast<double>(numSamples),
+          .maxRelativeError  = maxError};
+}
+
+FlockingUpdater::FlockingUpdater(const FlockingSettings& settings) noexcept
+  : m_settings{settings}, m_grid{settings.neighbourRadius, settings.gridSlotsLog2}
+{
 }
 
-auto AttractorUpdater::Update([[maybe_unused]] const double dt, ParticleData& particleData) noexcept
+auto FlockingUpdater::Update([[maybe_unused]] const double dt, ParticleData& particleData) noexcept
     -> void
 {
-  const auto numAlive = particleData.GetAliveCount();
+  // Sleeping particles are at rest, so they neither feel nor exert these forces.
+  const auto numParticles = particleData.GetAwakeCount();
+
+  m_grid.Build(particleData, {0U, numParticles});
+
+  if (nullptr == m_parallel)
+  {
+    UpdateParticles(particleData, 0U, numParticles);
+    return;
+  }
+  m_parallel->ForLoop(numParticles,
+                      [this, &particleData]([[maybe_unused]] const uint32_t chunk,
+                                            const size_t begin,
+                                            const size_t end)
+                      { UpdateParticles(particleData, begin, end); });
+}
+
+// 'begin' and 'end' are positions in the grid's sorted order. Each particle only writes its
+// own acceleration, so chunks can be done in parallel.
+auto FlockingUpdater::UpdateParticles(ParticleData& particleData,
+                                      const size_t begin,
+                                      const size_t end) const noexcept -> void
+{
+  const auto sortedIds       = m_grid.GetSortedIds();
+  const auto sortedPositions = m_grid.GetSortedPositions();
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto sortedIndex = begin; sortedIndex < end; ++sortedIndex)
   {
-    const auto particlePosition = particleData.GetPosition(i);
-    for (const auto& attractorPosition : m_attractorPositions)
+    const auto id = sortedIds[sortedIndex];
+
+    auto separation    = glm::vec4{0.0F};
+    auto sumVelocities = glm::vec4{0.0F};
+    auto sumOffsets    = glm::vec4{0.0F};
+    auto numNeighbours = 0U;
+
+    m_grid.ForEachInRadius(
+        sortedPositions[sortedIndex],
+        m_settings.neighbourRadius,
+        [this, id, &particleData, &separation, &sumVelocities, &sumOffsets, &numNeighbours](
+            const uint32_t otherId, const glm::vec4& offset, const float distSq)
+        {
+          if ((otherId == id) or (distSq <= 0.0F))
+          {
+            return true;
+          }
+          separation -= offset / distSq;
+          sumVelocities += particleData.GetVelocity(otherId);
+          sumOffsets += offset;
+          ++numNeighbours;
+          return numNeighbours < m_settings.maxNumNeighbours;
+        });
+
+    if (0U == numNeighbours)
     {
-      const auto offset = glm::vec4{attractorPosition.x - particlePosition.x,
-                                    attractorPosition.y - particlePosition.y,
-                                    attractorPosition.z - particlePosition.z,
-                                    0.0F};
-      const auto distSq = glm::dot(offset, offset);
-      const auto force  = attractorPosition.w / distSq;
+      continue;
+    }
+
+    const auto invNumNeighbours = 1.0F / static_cast<float>(numNeighbours);
+
+    const auto alignment = (sumVelocities * invNumNeighbours) - particleData.GetVelocity(id);
+    const auto cohesion  = sumOffsets * invNumNeighbours;
+
+    auto acceleration = (m_settings.separationStrength * separation) +
+                        (m_settings.alignmentStrength * alignment) +
+                        (m_settings.cohesionStrength * cohesion);
+    acceleration.w    = 0.0F;
+
+    particleData.IncAcceleration(id, acceleration);
+  }
+}
 
-      particleData.IncAcceleration(i, offset * force);
+SpatialReorderUpdater::SpatialReorderUpdater(const uint32_t period) noexcept
+  : m_period{std::max(1U, period)}
+{
+}
+
+auto SpatialReorderUpdater::Update([[maybe_unused]] const double dt,
+                                   ParticleData& particleData) noexcept -> void
+{
+  // Sleeping particles don't move, and stay together at the end of the alive range.
+  const auto numAwake = particleData.GetAwakeCount();
+  if (m_windowStart >= numAwake)
+  {
+    m_windowStart = 0U;
+  }
+  const auto windowSize =
+      std::max(size_t{MIN_WINDOW_SIZE}, (numAwake + m_period - 1U) / m_period);
+  const auto windowEnd = std::min(numAwake, m_windowStart + windowSize);
+  if ((windowEnd - m_windowStart) < 2U)
+  {
+    return;
+  }
+
+  // Every window of a period is keyed in the same bounds, so the windows line up along one
+  // curve rather than each filling its own.
+  if (0U == m_windowStart)
+  {
+    MakeBounds(particleData.GetPositions().first(particleData.GetAliveCount()));
+  }
+  MakeKeys(particleData.GetPositions().subspan(m_windowStart, windowEnd - m_windowStart));
+  m_radixSort.SortIndices(m_keys, m_order);
+  particleData.Permute(m_windowStart, m_order);
+
+  m_windowStart = windowEnd;
+}
+
+auto SpatialReorderUpdater::MakeBounds(const std::span<const glm::vec4> positions) noexcept
+    -> void
+{
+  auto boundsMax = positions.front();
+  m_boundsMin    = positions.front();
+  for (const auto& position : positions)
+  {
+    m_boundsMin = glm::min(m_boundsMin, position);
+    boundsMax   = glm::max(boundsMax, position);
+  }
+  m_boundsScale =
+      MAX_COORD / glm::max(boundsMax - m_boundsMin, glm::vec4{std::numeric_limits<float>::min()});
+}
+
+auto SpatialReorderUpdater::MakeKeys(const std::span<const glm::vec4> positions) noexcept -> void
+{
+  m_keys.resize(positions.size());
+  const auto makeKeys = [this, &positions]([[maybe_unused]] const uint32_t chunk,
+                                           const size_t begin,
+                                           const size_t end)
+  {
+    for (auto i = begin; i < end; ++i)
+    {
+      // Particles that have moved out of the bounds since they were made go to the edge.
+      const auto coords =
+          glm::clamp((positions[i] - m_boundsMin) * m_boundsScale, 0.0F, MAX_COORD);
+      const auto x      = SpreadMortonBits(static_cast<uint32_t>(coords.x));
+      const auto y      = SpreadMortonBits(static_cast<uint32_t>(coords.y));
+      const auto z      = SpreadMortonBits(static_cast<uint32_t>(coords.z));
+      m_keys[i]         = x | (y << 1U) | (z << 2U);
     }
+  };
+
+  if (nullptr == m_parallel)
+  {
+    makeKeys(0U, 0U, positions.size());
+    return;
+  }
+  m_parallel->ForLoop(positions.size(), makeKeys);
+}
+
+auto SpatialReorderUpdater::MeasureLocality(const ParticleData& particleData) noexcept -> double
+{
+  const auto positions = particleData.GetPositions().first(particleData.GetAwakeCount());
+  if (positions.size() < 2U)
+  {
+    return 0.0;
+  }
+
+  auto sumDistances = 0.0;
+  for (auto i = size_t{1U}; i < positions.size(); ++i)
+  {
+    sumDistances += static_cast<double>(
+        glm::distance(glm::vec3{positions[i]}, glm::vec3{positions[i - 1]}));
   }
+  return sumDistances / static_cast<double>(positions.size() - 1U);
 }
 
-auto BasicColorUpdater::Update([[maybe_unused]] const double dt,
-                               ParticleData& particleData) noexcept -> void
+VectorFieldUpdater::VectorFieldUpdater(std::shared_ptr<const VectorGrid> field,
+                                       const VectorFieldMode mode,
+                                       const float strength) noexcept
+  : m_field{std::move(field)}, m_mode{mode}, m_strength{strength}
+{
+}
+
+auto VectorFieldUpdater::SetBlendField(std::shared_ptr<const VectorGrid> blendField,
+                                       const double period) noexcept -> void
+{
+  assert((nullptr == blendField) or
+         ((blendField->GetResolution() == m_field->GetResolution()) and
+          (blendField->GetBoundsMin() == m_field->GetBoundsMin()) and
+          (blendField->GetBoundsMax() == m_field->GetBoundsMax())));
+  assert(period > 0.0);
+
+  m_blendField  = std::move(blendField);
+  m_blendPeriod = period;
+}
+
+auto VectorFieldUpdater::SetTime(const double time) noexcept -> void
+{
+  // Eases in and out of each grid rather than sweeping between them at a constant rate.
+  m_blendAmount =
+      static_cast<float>(0.5 - (0.5 * std::cos(2.0 * std::numbers::pi * time / m_blendPeriod)));
+}
+
+auto VectorFieldUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                     ParticleData& particleData,
+                                     const IdRange& idRange) noexcept -> void
+{
+  const auto& field      = *m_field;
+  const auto* blendField = m_blendField.get();
+
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    // Both grids have the same layout, so one location does for both.
+    const auto location = field.GetLocation(particleData.GetPosition(i));
+    auto value          = field.Sample(location);
+    if (nullptr != blendField)
+    {
+      value = glm::mix(value, blendField->Sample(location), m_blendAmount);
+    }
+
+    if (VectorFieldMode::FLOW == m_mode)
+    {
+      value -= particleData.GetVelocity(i);
+      value.w = 0.0F;
+    }
+
+    particleData.IncAcceleration(i, m_strength * value);
+  }
+}
+
+auto BasicColorUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                    ParticleData& particleData,
+                                    const IdRange& idRange) noexcept -> void
 {
   const auto& mixedTintColor = GetMixedTintColor();
-  const auto numAlive        = particleData.GetAliveCount();
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     const auto basicColor = glm::mix(
         particleData.GetStartColor(i), particleData.GetEndColor(i), particleData.GetTime(i).z);
@@ -159,13 +889,13 @@ PositionColorUpdater::PositionColorUpdater(const glm::vec4& minPosition,
 {
 }
 
-auto PositionColorUpdater::Update([[maybe_unused]] const double dt,
-                                  ParticleData& particleData) noexcept -> void
+auto PositionColorUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                       ParticleData& particleData,
+                                       const IdRange& idRange) noexcept -> void
 {
   const auto& mixedTintColor = GetMixedTintColor();
-  const auto numAlive        = particleData.GetAliveCount();
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     const auto scaledPosition =
         GetScaledValues(particleData.GetPosition(i), m_minPosition, m_diffMinMaxPosition);
@@ -185,13 +915,13 @@ VelocityColorUpdater::VelocityColorUpdater(const glm::vec4& minVelocity,
 {
 }
 
-auto VelocityColorUpdater::Update([[maybe_unused]] const double dt,
-                                  ParticleData& particleData) noexcept -> void
+auto VelocityColorUpdater::UpdateRange([[maybe_unused]] const double dt,
+                                       ParticleData& particleData,
+                                       const IdRange& idRange) noexcept -> void
 {
   const auto& mixedTintColor = GetMixedTintColor();
-  const auto numAlive        = particleData.GetAliveCount();
 
-  for (auto i = 0U; i < numAlive; ++i)
+  for (auto i = idRange.start; i < idRange.end; ++i)
   {
     const auto scaledVelocity =
         GetScaledValues(particleData.GetVelocity(i), m_minVelocity, m_diffMinMaxVelocity);
@@ -213,9 +943,11 @@ auto BasicTimeUpdater::Update(const double dt, ParticleData& particleData) noexc
     return;
   }
 
-  const auto localDt = static_cast<float>(dt);
+  const auto localDt     = static_cast<float>(dt);
+  const auto gatherStats = particleData.IsGatheringStats();
 
-  auto i = 0U;
+  auto stats = ParticleStats{};
+  auto i     = 0U;
   while (i < numAlive)
   {
     const auto newXTime = particleData.GetTime(i).x - localDt;
@@ -229,16 +961,69 @@ auto BasicTimeUpdater::Update(const double dt, ParticleData& particleData) noexc
 
     if (newXTime < 0.0F)
     {
+      // A particle not yet updated is moved into 'i', so update 'i' again.
       particleData.Kill(i);
       numAlive = particleData.GetAliveCount() < particleData.GetCount()
                      ? particleData.GetAliveCount()
                      : particleData.GetCount();
+      continue;
+    }
+    if (gatherStats)
+    {
+      stats.AddAge((1.0F / particleData.GetTime(i).w) - newXTime);
     }
 
     ++i;
   }
+
+  if (gatherStats)
+  {
+    particleData.MergeStats(stats);
+  }
 }
 
 // NOLINTEND(cppcoreguidelines-pro-type-union-access)
 
+StaggeredUpdater::StaggeredUpdater(const std::shared_ptr<IParticleUpdater>& updater,
+                                   const StaggerSchedule& schedule) noexcept
+  : m_updater{updater},
+    m_rangeUpdater{std::dynamic_pointer_cast<IRangeParticleUpdater>(updater)},
+    m_schedule{schedule},
+    m_windowDts(std::max(1U, schedule.period), 0.0)
+{
+  m_schedule.period = std::max(1U, m_schedule.period);
+  if (nullptr == m_rangeUpdater)
+  {
+    m_schedule.mode = StaggerMode::EVERY_NTH_FRAME;
+  }
+}
+
+auto StaggeredUpdater::Update(const double dt, ParticleData& particleData) noexcept -> void
+{
+  const auto window = m_frame % m_schedule.period;
+  ++m_frame;
+
+  if (StaggerMode::EVERY_NTH_FRAME == m_schedule.mode)
+  {
+    m_elapsedSinceUpdate += dt;
+    if (window != 0U)
+    {
+      return;
+    }
+    m_updater->Update(m_elapsedSinceUpdate, particleData);
+    m_elapsedSinceUpdate = 0.0;
+    return;
+  }
+
+  // Each window was last visited 'period' frames ago.
+  m_windowDts[window]    = dt;
+  const auto windowDt    = std::accumulate(cbegin(m_windowDts), cend(m_windowDts), 0.0);
+  const auto numToUpdate = m_rangeUpdater->GetNumParticlesToUpdate(particleData);
+  const auto chunkSize   = (numToUpdate + m_schedule.period - 1) / m_schedule.period;
+  const auto start       = std::min(numToUpdate, window * chunkSize);
+  const auto end         = std::min(numToUpdate, start + chunkSize);
+
+  m_rangeUpdater->UpdateRange(windowDt, particleData, {.start = start, .end = end});
+}
+
 } // namespace PARTICLES::UPDATERS
@@ -1,11 +1,26 @@
 module;
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
 
 module Particles.Particles;
 
+import Particles.Frustum;
+
 namespace PARTICLES
 {
 
@@ -18,6 +33,8 @@ ParticleData::ParticleData(const size_t count) noexcept
     m_startColor(count, glm::vec4{0.0F}),
     m_endColor(count, glm::vec4{0.0F}),
     m_time(count, glm::vec4{0.0F}),
+    m_id(count, 0U),
+    m_lodTier(count, 0U),
     m_alive(count, false)
 {
 }
@@ -27,7 +44,21 @@ auto ParticleData::Kill(const size_t id) noexcept -> void
   //if (m_countAlive > 0) // maybe this if can be removed?
   {
     m_alive[id] = false;
-    SwapData(id, m_countAlive - 1);
+    if (id < m_countAwake)
+    {
+      // Keep the awake particles together. The last awake particle fills the hole and the
+      // last sleeping particle fills its place.
+      SwapData(id, m_countAwake - 1);
+      if (m_countAwake < m_countAlive)
+      {
+        SwapData(m_countAwake - 1, m_countAlive - 1);
+      }
+      --m_countAwake;
+    }
+    else
+    {
+      SwapData(id, m_countAlive - 1);
+    }
     --m_countAlive;
   }
 }
@@ -36,12 +67,40 @@ auto ParticleData::Wake(const size_t id) noexcept -> void
 {
   //if (m_countAlive < m_count) // maybe this 'if' can be removed?
   {
-    m_alive[id] = true;
+    m_alive[id]   = true;
+    m_id[id]      = m_nextId++;
+    m_lodTier[id] = 0U;
     //swapData(id, m_countAlive);
+    if (m_countAwake < m_countAlive)
+    {
+      // New particles go in front of any sleeping ones.
+      SwapParticles(m_countAwake, id);
+    }
+    ++m_countAwake;
     ++m_countAlive;
   }
 }
 
+auto ParticleData::ApplySleepRequests() noexcept -> void
+{
+  // Highest first, so a swap never moves a particle that is still waiting to sleep.
+  std::ranges::sort(m_sleepRequests, std::greater{});
+  const auto duplicates = std::ranges::unique(m_sleepRequests);
+  m_sleepRequests.erase(begin(duplicates), end(duplicates));
+
+  for (const auto i : m_sleepRequests)
+  {
+    if (i >= m_countAwake)
+    {
+      continue;
+    }
+    --m_countAwake;
+    SwapParticles(i, m_countAwake);
+  }
+
+  m_sleepRequests.clear();
+}
+
 auto ParticleData::SwapData(const size_t a, const size_t b) noexcept -> void
 {
   /*std::swap(m_pos[a], m_pos[b]);
@@ -59,15 +118,119 @@ auto ParticleData::SwapData(const size_t a, const size_t b) noexcept -> void
   m_velocity[a]     = m_velocity[b];
   m_acceleration[a] = m_acceleration[b];
   m_time[a]         = m_time[b];
+  m_id[a]           = m_id[b];
+  m_lodTier[a]      = m_lodTier[b];
   //m_alive[a] = m_alive[b];*/
 }
 
+auto ParticleData::SwapParticles(const size_t a, const size_t b) noexcept -> void
+{
+  std::swap(m_position[a], m_position[b]);
+  std::swap(m_color[a], m_color[b]);
+  std::swap(m_startColor[a], m_startColor[b]);
+  std::swap(m_endColor[a], m_endColor[b]);
+  std::swap(m_velocity[a], m_velocity[b]);
+  std::swap(m_acceleration[a], m_acceleration[b]);
+  std::swap(m_time[a], m_time[b]);
+  std::swap(m_id[a], m_id[b]);
+  std::swap(m_lodTier[a], m_lodTier[b]);
+  // NOTE: 'm_alive' is the same for both - only alive particles are swapped.
+}
+
+auto ParticleData::Permute(const size_t start, const std::span<const uint32_t> order) noexcept
+    -> void
+{
+  assert((start + order.size()) <= m_countAlive);
+
+  m_permuteScratch.resize(order.size());
+  for (auto* const stream : {&m_position,
+                             &m_velocity,
+                             &m_acceleration,
+                             &m_color,
+                             &m_startColor,
+                             &m_endColor,
+                             &m_time})
+  {
+    for (auto i = size_t{0U}; i < order.size(); ++i)
+    {
+      m_permuteScratch[i] = (*stream)[start + order[i]];
+    }
+    std::ranges::copy(m_permuteScratch, stream->begin() + static_cast<std::ptrdiff_t>(start));
+  }
+
+  m_permuteIdScratch.resize(order.size());
+  for (auto i = size_t{0U}; i < order.size(); ++i)
+  {
+    m_permuteIdScratch[i] = m_id[start + order[i]];
+  }
+  std::ranges::copy(m_permuteIdScratch, m_id.begin() + static_cast<std::ptrdiff_t>(start));
+
+  m_permuteLodTierScratch.resize(order.size());
+  for (auto i = size_t{0U}; i < order.size(); ++i)
+  {
+    m_permuteLodTierScratch[i] = m_lodTier[start + order[i]];
+  }
+  std::ranges::copy(m_permuteLodTierScratch,
+                    m_lodTier.begin() + static_cast<std::ptrdiff_t>(start));
+}
+
+auto ParticleData::GetAliveStreams() const noexcept -> Streams
+{
+  const auto alive = [this](const std::vector<glm::vec4>& stream)
+  { return std::span{stream}.first(m_countAlive); };
+
+  return {alive(m_position),
+          alive(m_velocity),
+          alive(m_acceleration),
+          alive(m_color),
+          alive(m_startColor),
+          alive(m_endColor),
+          alive(m_time)};
+}
+
+auto ParticleData::Restore(const Streams& streams, const size_t awakeCount) noexcept -> void
+{
+  const auto aliveCount = streams[0].size();
+  assert(aliveCount <= m_count);
+  assert(awakeCount <= aliveCount);
+
+  auto stream = streams.cbegin();
+  for (auto* const destination : {&m_position,
+                                  &m_velocity,
+                                  &m_acceleration,
+                                  &m_color,
+                                  &m_startColor,
+                                  &m_endColor,
+                                  &m_time})
+  {
+    assert(stream->size() == aliveCount);
+    std::ranges::copy(*stream++, destination->begin());
+  }
+
+  for (auto i = size_t{0U}; i < aliveCount; ++i)
+  {
+    m_id[i] = m_nextId++;
+  }
+  std::fill_n(m_lodTier.begin(), aliveCount, uint8_t{0U});
+  std::fill_n(m_alive.begin(), aliveCount, true);
+  std::fill(m_alive.begin() + static_cast<std::ptrdiff_t>(aliveCount), m_alive.end(), false);
+  m_countAlive = aliveCount;
+  m_countAwake = awakeCount;
+  m_sleepRequests.clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // ParticleEmitter class
 
 auto ParticleEmitter::Emit(const double dt, ParticleData& particleData) noexcept -> void
 {
-  const auto maxNewParticles = GetMaxAllowedNewParticles(dt, particleData);
+  // The part of a particle left over is carried to the next call, so that many short steps,
+  // like fixed time steps, still emit at the rate.
+  const auto numToEmit             = (dt * static_cast<double>(m_emitRate)) + m_emitRemainder;
+  const auto requestedNewParticles = static_cast<size_t>(numToEmit);
+  m_emitRemainder                  = numToEmit - static_cast<double>(requestedNewParticles);
+
+  const auto maxNewParticles = GetMaxAllowedNewParticles(requestedNewParticles, particleData);
   const auto startId         = particleData.GetAliveCount();
   const auto endId           = std::min(startId + maxNewParticles, particleData.GetCount() - 1);
 
@@ -82,11 +245,10 @@ auto ParticleEmitter::Emit(const double dt, ParticleData& particleData) noexcept
   }
 }
 
-auto ParticleEmitter::GetMaxAllowedNewParticles(const double dt,
+auto ParticleEmitter::GetMaxAllowedNewParticles(const size_t requestedNewParticles,
                                                 const ParticleData& particleData) const noexcept
     -> size_t
 {
-  const auto requestedNewParticles  = static_cast<size_t>(dt * static_cast<double>(m_emitRate));
   const auto newTotalAliveParticles = requestedNewParticles + particleData.GetAliveCount();
   if (newTotalAliveParticles <= m_maxNumAliveParticles)
   {
@@ -96,6 +258,19 @@ auto ParticleEmitter::GetMaxAllowedNewParticles(const double dt,
   return requestedNewParticles - (newTotalAliveParticles - m_maxNumAliveParticles);
 }
 
+auto ParticleEmitter::GetMaxLifetime() const noexcept -> std::optional<float>
+{
+  auto maxLifetime = std::optional<float>{};
+  for (const auto& gen : m_generators)
+  {
+    if (const auto lifetime = gen->GetMaxLifetime(); lifetime.has_value())
+    {
+      maxLifetime = std::max(maxLifetime.value_or(0.0F), *lifetime);
+    }
+  }
+  return maxLifetime;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // ParticleSystem class
 
@@ -104,21 +279,619 @@ ParticleSystem::ParticleSystem(const size_t maxCount) : m_count{maxCount}, m_par
 {
 }
 
+auto ParticleSystem::SetFixedTimeStep(const double stepDt, const uint32_t maxNumSteps) noexcept
+    -> void
+{
+  assert(stepDt > 0.0);
+
+  m_fixedTimeStepEnabled = true;
+  m_fixedTimeStep        = stepDt;
+  m_maxNumTimeSteps      = std::max(1U, maxNumSteps);
+  m_accumulatedTime      = 0.0;
+}
+
 auto ParticleSystem::Update(const double dt) noexcept -> void
+{
+  if (IsIdle())
+  {
+    m_simulationTime += dt;
+    m_particles.ResetStats();
+    return;
+  }
+
+  if (m_culled)
+  {
+    UpdateCulled(dt);
+    return;
+  }
+  if (m_catchUpPending)
+  {
+    CatchUp();
+  }
+
+  if (not m_fixedTimeStepEnabled)
+  {
+    Step(dt);
+    return;
+  }
+
+  m_accumulatedTime += dt;
+
+  auto numSteps = 0U;
+  while ((m_accumulatedTime >= m_fixedTimeStep) and (numSteps < m_maxNumTimeSteps))
+  {
+    Step(m_fixedTimeStep);
+    m_accumulatedTime -= m_fixedTimeStep;
+    ++numSteps;
+  }
+
+  m_accumulatedTime = std::fmod(m_accumulatedTime, m_fixedTimeStep);
+}
+
+auto ParticleSystem::Step(const double dt) noexcept -> void
+{
+  m_simulationTime += dt;
+  Emit(dt);
+  RunUpdaters(dt);
+}
+
+auto ParticleSystem::Emit(const double dt) noexcept -> void
 {
   for (auto& em : m_emitters)
   {
     em->Emit(dt, m_particles);
   }
+}
 
-  for (auto i = 0U; i < m_count; ++i)
+auto ParticleSystem::RunUpdaters(const double dt) noexcept -> void
+{
+  if (NeedsAccelerations())
+  {
+    ClearAccelerations();
+  }
+
+  if (m_particles.IsGatheringStats())
+  {
+    m_particles.ResetStats();
+  }
+
+  if (m_lodEnabled)
+  {
+    UpdateWithLod(dt);
+  }
+  else
+  {
+    for (auto& up : m_updaters)
+    {
+      up->Update(dt, m_particles);
+      ApplySleepRequests();
+    }
+  }
+
+  if (m_particles.IsGatheringStats())
+  {
+    CompleteStats();
+  }
+}
+
+auto ParticleSystem::Prewarm(const double seconds) noexcept -> void
+{
+  Prewarm(seconds, DEFAULT_PREWARM_STEP_DT);
+}
+
+auto ParticleSystem::Prewarm(const double seconds, const double stepDt) noexcept -> void
+{
+  assert(stepDt > 0.0);
+
+  // Particles emitted more than the longest lifetime before the end are dead by it.
+  const auto maxLifetime = GetMaxLifetime();
+  const auto emitTime    = maxLifetime.has_value()
+                               ? std::min(seconds, static_cast<double>(*maxLifetime))
+                               : seconds;
+  m_simulationTime += seconds - emitTime;
+
+  // Equal steps that add up to the emitting time.
+  const auto numSteps = static_cast<uint32_t>(std::max(1.0, std::ceil(emitTime / stepDt)));
+  const auto dt       = emitTime / static_cast<double>(numSteps);
+
+  for (auto step = 1U; step <= numSteps; ++step)
+  {
+    m_simulationTime += dt;
+
+    // New particles go after the awake ones, in front of any sleeping ones.
+    const auto firstEmitted = m_particles.GetAwakeCount();
+    Emit(dt);
+    // Without lifetimes the times say nothing about when the particles die.
+    if (maxLifetime.has_value())
+    {
+      SpreadPrewarmBirths({.start = firstEmitted, .end = m_particles.GetAwakeCount()},
+                          dt,
+                          static_cast<double>(numSteps - step) * dt);
+    }
+
+    RunUpdaters(dt);
+  }
+}
+
+auto ParticleSystem::GetMaxLifetime() const noexcept -> std::optional<float>
+{
+  // Unknown if any emitter's particles have no lifetime.
+  auto maxLifetime = std::optional<float>{0.0F};
+  for (const auto& emitter : m_emitters)
+  {
+    const auto lifetime = emitter->GetMaxLifetime();
+    if (not lifetime.has_value())
+    {
+      return std::nullopt;
+    }
+    maxLifetime = std::max(*maxLifetime, *lifetime);
+  }
+  return maxLifetime;
+}
+
+auto ParticleSystem::SpreadPrewarmBirths(const IdRange& emitted,
+                                         const double dt,
+                                         const double remainingTime) noexcept -> void
+{
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+  const auto numEmitted = emitted.end - emitted.start;
+  if (0U == numEmitted)
+  {
+    return;
+  }
+
+  // The i-th particle of the step is taken as born 'birthAge' before the end of the step, in
+  // the middle of its share of it. It is due to die before the end of the pre-warm if its
+  // lifetime is less than its age by then. The others are moved back along their velocity and
+  // given the time this step's update will take off, so that it leaves them as old, and
+  // about as far along, as their birth says.
+  m_diesInPrewarm.resize(numEmitted);
+  const auto spreadRange =
+      [this, &emitted, numEmitted, dt, remainingTime](
+          [[maybe_unused]] const uint32_t chunk, const size_t begin, const size_t end)
+  {
+    for (auto i = begin; i < end; ++i)
+    {
+      const auto id       = emitted.start + i;
+      const auto birthAge = ((static_cast<double>(i) + 0.5) / static_cast<double>(numEmitted)) * dt;
+      auto time           = m_particles.GetTime(id);
+
+      m_diesInPrewarm[i] = (static_cast<double>(time.x) <= (birthAge + remainingTime)) ? 1U : 0U;
+      if (0U == m_diesInPrewarm[i])
+      {
+        const auto rewind = static_cast<float>(dt - birthAge);
+        time.x += rewind;
+        m_particles.SetTime(id, time);
+        m_particles.SetPosition(
+            id, m_particles.GetPosition(id) - (rewind * m_particles.GetVelocity(id)));
+      }
+    }
+  };
+
+  if ((nullptr == m_parallel) or (numEmitted < MIN_PARALLEL_EMITTED))
+  {
+    spreadRange(0U, 0U, numEmitted);
+  }
+  else
+  {
+    m_parallel->ForLoop(numEmitted, spreadRange);
+  }
+
+  // From the back, so that the particle a kill moves into a place has already been seen.
+  for (auto i = numEmitted; i > 0U; --i)
+  {
+    if (0U != m_diesInPrewarm[i - 1])
+    {
+      m_particles.Kill(emitted.start + i - 1);
+    }
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+}
+
+auto ParticleSystem::NeedsAccelerations() const noexcept -> bool
+{
+  return std::ranges::any_of(m_updaters,
+                             [](const auto& updater) { return updater->NeedsAccelerations(); });
+}
+
+auto ParticleSystem::ClearAccelerations() noexcept -> void
+{
+  // Dead and sleeping particles don't use their acceleration.
+  const auto numAwake = m_particles.GetAwakeCount();
+  for (auto i = 0U; i < numAwake; ++i)
   {
     m_particles.SetAcceleration(i, glm::vec4{0.0F});
   }
+}
+
+auto ParticleSystem::SetCulled(const bool culled) noexcept -> void
+{
+  if (culled == m_culled)
+  {
+    return;
+  }
+  m_culled = culled;
+
+  if (not culled)
+  {
+    m_catchUpPending = true;
+    return;
+  }
+  // Culled again before the catch-up ran - keep adding to the missed time.
+  if (not m_catchUpPending)
+  {
+    m_culledFrame      = 0U;
+    m_culledUpdatersDt = 0.0;
+    m_catchUpDt        = 0.0;
+  }
+  m_catchUpPending = false;
+}
+
+auto ParticleSystem::UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool
+{
+  if (not m_particles.IsGatheringStats())
+  {
+    EnableStats();
+    SetCulled(false);
+    return true;
+  }
+
+  const auto& stats = m_particles.GetStats();
+  SetCulled(stats.HasBounds() and viewFrustum.IsBoxOutside(stats.boundsMin, stats.boundsMax));
+
+  return not m_culled;
+}
+
+// Particles don't move while culled, so the bounds only need the new ones.
+auto ParticleSystem::UpdateCulled(const double dt) noexcept -> void
+{
+  m_simulationTime += dt;
+  m_culledUpdatersDt += dt;
+  m_catchUpDt += dt;
+
+  const auto firstNewId = m_particles.GetAwakeCount();
+  for (auto& em : m_emitters)
+  {
+    em->Emit(dt, m_particles);
+  }
+  if (m_particles.IsGatheringStats())
+  {
+    GatherMotionStats({.start = firstNewId, .end = m_particles.GetAwakeCount()});
+  }
+
+  ++m_culledFrame;
+  if (0U == (m_culledFrame % m_cullSettings.updatePeriod))
+  {
+    RunCulledUpdaters();
+  }
+}
 
+auto ParticleSystem::RunCulledUpdaters() noexcept -> void
+{
   for (auto& up : m_updaters)
   {
-    up->Update(dt, m_particles);
+    if (up->RunsWhenCulled())
+    {
+      up->Update(m_culledUpdatersDt, m_particles);
+      ApplySleepRequests();
+    }
+  }
+  m_culledUpdatersDt = 0.0;
+}
+
+// Brings the ages up to date, then gives the other updaters the time they missed, as one step.
+auto ParticleSystem::CatchUp() noexcept -> void
+{
+  m_catchUpPending = false;
+  RunCulledUpdaters();
+
+  const auto catchUpDt = std::min(m_catchUpDt, m_cullSettings.maxCatchUpDt);
+  m_catchUpDt          = 0.0;
+  if (catchUpDt <= 0.0)
+  {
+    return;
+  }
+
+  if (NeedsAccelerations())
+  {
+    ClearAccelerations();
+  }
+  for (auto& up : m_updaters)
+  {
+    if (not up->RunsWhenCulled())
+    {
+      up->Update(catchUpDt, m_particles);
+      ApplySleepRequests();
+    }
+  }
+}
+
+// The updaters gathered stats for the particles they saw - this adds the rest.
+auto ParticleSystem::CompleteStats() noexcept -> void
+{
+  const auto numAwake = m_particles.GetAwakeCount();
+  const auto numAlive = m_particles.GetAliveCount();
+  const auto& stats   = m_particles.GetStats();
+
+  const auto hasAges = stats.numAged > 0U;
+  GatherMotionStats({.start = stats.HasBounds() ? numAwake : 0U, .end = numAlive});
+  if (not hasAges)
+  {
+    GatherAgeStats();
+  }
+}
+
+auto ParticleSystem::GatherMotionStats(const IdRange& idRange) noexcept -> void
+{
+  auto stats = ParticleStats{};
+  for (auto i = idRange.start; i < idRange.end; ++i)
+  {
+    stats.AddMotion(m_particles.GetPosition(i), m_particles.GetVelocity(i));
+  }
+  m_particles.MergeStats(stats);
+}
+
+auto ParticleSystem::GatherAgeStats() noexcept -> void
+{
+  const auto numAlive = m_particles.GetAliveCount();
+
+  auto stats = ParticleStats{};
+  for (auto i = 0U; i < numAlive; ++i)
+  {
+    const auto& time = m_particles.GetTime(i);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+    stats.AddAge((1.0F / time.w) - time.x); // .x is the time left, .w is 1.0/max lifetime
+  }
+  m_particles.MergeStats(stats);
+}
+
+auto ParticleSystem::IsIdle() const noexcept -> bool
+{
+  return (0U == m_particles.GetAliveCount()) and
+         std::ranges::all_of(m_emitters, [](const auto& emitter) { return emitter->IsIdle(); });
+}
+
+auto ParticleSystem::ApplySleepRequests() noexcept -> void
+{
+  if (m_particles.HasSleepRequests())
+  {
+    m_particles.ApplySleepRequests();
+  }
+}
+
+auto ParticleSystem::WriteExtrapolatedPositions(const double renderTime,
+                                                std::span<glm::vec4> positions) const noexcept
+    -> size_t
+{
+  const auto numAlive   = std::min(m_particles.GetAliveCount(), positions.size());
+  const auto simulated  = m_particles.GetPositions();
+  const auto velocities = m_particles.GetVelocities();
+
+  // With LOD, the tiers that weren't due in the last update are behind by their pending time.
+  auto tierXyzDts = std::array<glm::vec4, LodSettings::NUM_TIERS>{};
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS; ++tier)
+  {
+    const auto pendingDt = m_lodEnabled ? m_lodElapsedTimes[tier] : 0.0;
+    const auto dt        = static_cast<float>(renderTime - m_simulationTime + pendingDt);
+    tierXyzDts[tier]     = glm::vec4{dt, dt, dt, 0.0F};
+  }
+
+  if (not m_lodEnabled)
+  {
+    for (auto i = 0U; i < numAlive; ++i)
+    {
+      positions[i] = simulated[i] + (tierXyzDts[0] * velocities[i]);
+    }
+    return numAlive;
+  }
+
+  for (auto i = 0U; i < numAlive; ++i)
+  {
+    positions[i] = simulated[i] + (tierXyzDts[m_particles.GetLodTier(i)] * velocities[i]);
+  }
+
+  return numAlive;
+}
+
+auto ParticleSystem::SetLodSettings(const LodSettings& lodSettings) noexcept -> void
+{
+  m_lodEnabled  = true;
+  m_lodSettings = lodSettings;
+
+  for (auto& updatePeriod : m_lodSettings.updatePeriods)
+  {
+    updatePeriod = std::max(1U, updatePeriod);
+  }
+  m_lodSettings.updatePeriods[0] = 1U;
+  std::ranges::transform(m_lodSettings.tierDistances,
+                         begin(m_lodTierDistancesSq),
+                         [](const float distance) { return distance * distance; });
+
+  m_lodFrame = 0U;
+  m_lodElapsedTimes.fill(0.0);
+}
+
+auto ParticleSystem::SetLodView(const glm::vec4& viewPosition,
+                                const std::optional<Frustum>& viewFrustum) noexcept -> void
+{
+  m_viewPosition = viewPosition;
+  m_viewFrustum  = viewFrustum;
+}
+
+auto ParticleSystem::SetUpdaterMaxLodTier(const std::shared_ptr<IParticleUpdater>& updater,
+                                          const uint32_t maxLodTier) noexcept -> void
+{
+  const auto updaterIter = std::ranges::find(m_updaters, updater);
+  if (updaterIter == cend(m_updaters))
+  {
+    return;
+  }
+
+  m_updaterMaxLodTiers.at(static_cast<size_t>(std::distance(begin(m_updaters), updaterIter))) =
+      std::min(maxLodTier, LodSettings::NUM_TIERS - 1);
+}
+
+auto ParticleSystem::UpdateWithLod(const double dt) noexcept -> void
+{
+  AssignLodTiers();
+  PartitionLodTiers();
+
+  auto dueTiers = std::array<bool, LodSettings::NUM_TIERS>{};
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS; ++tier)
+  {
+    m_lodElapsedTimes[tier] += dt;
+    dueTiers[tier] = 0U == (m_lodFrame % m_lodSettings.updatePeriods[tier]);
+  }
+  ++m_lodFrame;
+
+  for (auto i = 0U; i < m_updaters.size(); ++i)
+  {
+    const auto numAwake = m_particles.GetAwakeCount();
+
+    auto* const rangeUpdater = dynamic_cast<IRangeParticleUpdater*>(m_updaters[i].get());
+    if (nullptr == rangeUpdater)
+    {
+      m_updaters[i]->Update(dt, m_particles);
+    }
+    else
+    {
+      for (auto tier = 0U; tier <= m_updaterMaxLodTiers[i]; ++tier)
+      {
+        if (dueTiers[tier])
+        {
+          rangeUpdater->UpdateRange(m_lodElapsedTimes[tier], m_particles, m_lodTierRanges[tier]);
+        }
+      }
+      if (not rangeUpdater->SkipsSleepingParticles())
+      {
+        rangeUpdater->UpdateRange(
+            dt,
+            m_particles,
+            {.start = m_particles.GetAwakeCount(), .end = m_particles.GetAliveCount()});
+      }
+    }
+
+    // Kills and sleeps move particles about, but they keep their tiers, so the tier ranges
+    // only need putting back together.
+    ApplySleepRequests();
+    if (m_particles.GetAwakeCount() != numAwake)
+    {
+      PartitionLodTiers();
+    }
+  }
+
+  // The integrator only saw the tiers that were due.
+  const auto integratorGatheredStats =
+      m_particles.IsGatheringStats() and m_particles.GetStats().HasBounds();
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS; ++tier)
+  {
+    if (dueTiers[tier])
+    {
+      m_lodElapsedTimes[tier] = 0.0;
+    }
+    else if (integratorGatheredStats)
+    {
+      GatherMotionStats(m_lodTierRanges[tier]);
+    }
+  }
+}
+
+// A tier's time is given to all its particles at once, so a particle can only change tier
+// when neither tier has time pending. Otherwise it would get the time of both tiers, or of
+// neither. It stays in its old tier until then.
+auto ParticleSystem::AssignLodTiers() noexcept -> void
+{
+  auto upToDateTiers = std::array<bool, LodSettings::NUM_TIERS>{};
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS; ++tier)
+  {
+    upToDateTiers[tier] = IsLodTierUpToDate(tier);
+  }
+
+  const auto numAwake = m_particles.GetAwakeCount();
+  for (auto i = 0U; i < numAwake; ++i)
+  {
+    const auto tier    = m_particles.GetLodTier(i);
+    const auto newTier = GetLodTier(m_particles.GetPosition(i));
+    if ((newTier != tier) and upToDateTiers[tier] and upToDateTiers[newTier])
+    {
+      m_particles.SetLodTier(i, static_cast<uint8_t>(newTier));
+    }
+  }
+}
+
+auto ParticleSystem::IsLodTierUpToDate(const uint32_t tier) const noexcept -> bool
+{
+  return m_lodElapsedTimes[tier] <= 0.0;
+}
+
+// Most particles stay in the same tier from frame to frame, so only swap the misplaced ones.
+auto ParticleSystem::PartitionLodTiers() noexcept -> void
+{
+  const auto numAwake = m_particles.GetAwakeCount();
+
+  auto tierStart = size_t{0U};
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS - 1; ++tier)
+  {
+    const auto tierEnd    = PartitionLodTier(tier, {.start = tierStart, .end = numAwake});
+    m_lodTierRanges[tier] = {.start = tierStart, .end = tierEnd};
+    tierStart             = tierEnd;
+  }
+  m_lodTierRanges[LodSettings::NUM_TIERS - 1] = {.start = tierStart, .end = numAwake};
+}
+
+// Hoare partition - particles in 'tier' (or nearer) to the front, returns the end of 'tier'.
+auto ParticleSystem::PartitionLodTier(const uint32_t tier, const IdRange& idRange) noexcept
+    -> size_t
+{
+  auto first = idRange.start;
+  auto last  = idRange.end;
+
+  while (true)
+  {
+    while ((first < last) and (m_particles.GetLodTier(first) <= tier))
+    {
+      ++first;
+    }
+    while ((first < last) and (m_particles.GetLodTier(last - 1) > tier))
+    {
+      --last;
+    }
+    if (first >= last)
+    {
+      return first;
+    }
+
+    --last;
+    m_particles.SwapParticles(first, last);
+    ++first;
+  }
+}
+
+auto ParticleSystem::GetLodTier(const glm::vec4& position) const noexcept -> uint32_t
+{
+  if (m_viewFrustum.has_value() and (not m_viewFrustum->IsInside(position)))
+  {
+    return LodSettings::NUM_TIERS - 1;
+  }
+
+  const auto offset     = glm::vec3{position} - glm::vec3{m_viewPosition};
+  const auto distanceSq = glm::dot(offset, offset);
+
+  auto tier = 0U;
+  while ((tier < m_lodTierDistancesSq.size()) and (distanceSq > m_lodTierDistancesSq[tier]))
+  {
+    ++tier;
+  }
+
+  return tier;
+}
+
+auto ParticleSystem::SetRandomSeed(const uint64_t seed) noexcept -> void
+{
+  m_randomSeed = seed;
+  for (auto i = size_t{0U}; i < m_emitters.size(); ++i)
+  {
+    m_emitters[i]->SetRandomSeed(seed, i);
   }
 }
 
@@ -127,6 +900,15 @@ auto ParticleSystem::Reset() noexcept -> void
   m_particles.Reset();
 }
 
+auto ParticleSystem::Restore(const ParticleData::Streams& streams,
+                             const size_t awakeCount,
+                             const double simulationTime) noexcept -> void
+{
+  m_particles.Restore(streams, awakeCount);
+  m_simulationTime  = simulationTime;
+  m_accumulatedTime = 0.0;
+}
+
 auto ParticleSystem::ComputeMemoryUsage(const ParticleSystem& particleSystem) noexcept -> size_t
 {
   return 2 * ParticleData::ComputeMemoryUsage(particleSystem.m_particles);
@@ -0,0 +1,109 @@
+module;
+
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+module Particles.RadixSort;
+
+import Particles.Parallel;
+
+namespace PARTICLES
+{
+
+auto RadixSort::SortIndices(const std::span<const uint32_t> keys,
+                            std::vector<uint32_t>& order) noexcept -> void
+{
+  order.resize(keys.size());
+  std::iota(order.begin(), order.end(), 0U);
+
+  SortValues(keys, order);
+}
+
+auto RadixSort::SortValues(const std::span<const uint32_t> keys,
+                           std::vector<uint32_t>& values) noexcept -> void
+{
+  const auto numKeys = keys.size();
+
+  m_keys.assign(keys.begin(), keys.end());
+  m_scratchKeys.resize(numKeys);
+  m_scratchOrder.resize(numKeys);
+
+  const auto numChunks = ((nullptr == m_parallel) or (numKeys < MIN_PARALLEL_SIZE))
+                             ? 1U
+                             : m_parallel->GetNumThreads();
+
+  for (auto pass = 0U; pass < NUM_PASSES; ++pass)
+  {
+    SortPass(pass * DIGIT_BITS, numChunks, values);
+  }
+}
+
+auto RadixSort::SortPass(const uint32_t shift,
+                         const uint32_t numChunks,
+                         std::vector<uint32_t>& order) noexcept -> void
+{
+  const auto numKeys = m_keys.size();
+
+  // The chunks are the same as 'Parallel::ForLoop' makes, so the counts made in one loop
+  // match the keys scattered in the next.
+  const auto forEachChunk = [this, numChunks, numKeys](const Parallel::LoopFunc& loopFunc)
+  {
+    if (1U == numChunks)
+    {
+      loopFunc(0U, 0U, numKeys);
+      return;
+    }
+    m_parallel->ForLoop(numKeys, loopFunc);
+  };
+  const auto getChunkCounts = [this](const uint32_t chunk)
+  { return std::span{m_chunkDigitCounts}.subspan(chunk * NUM_DIGITS, NUM_DIGITS); };
+
+  m_chunkDigitCounts.assign(static_cast<size_t>(numChunks) * NUM_DIGITS, 0U);
+  forEachChunk(
+      [this, shift, &getChunkCounts](const uint32_t chunk, const size_t begin, const size_t end)
+      {
+        const auto chunkCounts = getChunkCounts(chunk);
+        for (auto i = begin; i < end; ++i)
+        {
+          ++chunkCounts[(m_keys[i] >> shift) & DIGIT_MASK];
+        }
+      });
+
+  // Where each chunk's keys with each digit go, digits in order and then chunks in order, so
+  // equal digits stay in index order.
+  auto offset = 0U;
+  for (auto digit = 0U; digit < NUM_DIGITS; ++digit)
+  {
+    const auto digitStart = offset;
+    for (auto chunk = 0U; chunk < numChunks; ++chunk)
+    {
+      auto& count = getChunkCounts(chunk)[digit];
+      offset += std::exchange(count, offset);
+    }
+    if ((offset - digitStart) == numKeys)
+    {
+      return; // every key has this digit, so the pass changes nothing
+    }
+  }
+
+  forEachChunk(
+      [this, shift, &order, &getChunkCounts](
+          const uint32_t chunk, const size_t begin, const size_t end)
+      {
+        const auto chunkOffsets = getChunkCounts(chunk);
+        for (auto i = begin; i < end; ++i)
+        {
+          const auto slot      = chunkOffsets[(m_keys[i] >> shift) & DIGIT_MASK]++;
+          m_scratchKeys[slot]  = m_keys[i];
+          m_scratchOrder[slot] = order[i];
+        }
+      });
+
+  std::swap(m_keys, m_scratchKeys);
+  std::swap(order, m_scratchOrder);
+}
+
+} // namespace PARTICLES
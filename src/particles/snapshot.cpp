@@ -0,0 +1,353 @@
+module;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glm/vec4.hpp>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+module Particles.Snapshot;
+
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+namespace
+{
+
+constexpr auto SNAPSHOT_MAGIC   = std::array{'P', 'S', 'N', 'P'};
+constexpr auto SNAPSHOT_VERSION = 1U;
+// Reads back as something else on a machine with the other byte order.
+constexpr auto BYTE_ORDER_MARK = 0x01020304U;
+// Each stream starts on a cache line, so the mapped streams are as aligned as the vectors.
+constexpr auto STREAM_ALIGNMENT = uint64_t{64U};
+
+struct SnapshotHeader
+{
+  std::array<char, SNAPSHOT_MAGIC.size()> magic;
+  uint32_t version;
+  uint32_t byteOrderMark;
+  uint32_t elementSize; // of one particle in one stream
+  uint64_t aliveCount;
+  uint64_t awakeCount;
+  double simulationTime;
+  std::array<uint64_t, ParticleData::NUM_STREAMS> streamOffsets; // from the start of the file
+};
+
+[[nodiscard]] constexpr auto AlignStream(const uint64_t offset) noexcept -> uint64_t
+{
+  return ((offset + STREAM_ALIGNMENT) - 1U) & ~(STREAM_ALIGNMENT - 1U);
+}
+
+template<typename T>
+auto WriteValue(std::ofstream& file, const T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+auto WriteStream(std::ofstream& file, const std::span<const glm::vec4> stream) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(stream.data()),
+             static_cast<std::streamsize>(stream.size_bytes()));
+}
+
+auto WritePadding(std::ofstream& file, const uint64_t size) -> void
+{
+  static constexpr auto ZEROS = std::array<char, STREAM_ALIGNMENT>{};
+  file.write(ZEROS.data(), static_cast<std::streamsize>(size));
+}
+
+// A whole file mapped read only. The pages are read in as the streams are copied out, without
+// going through a buffer of our own.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path& filename);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&)      = delete;
+  ~MappedFile() noexcept;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+  auto operator=(MappedFile&&) -> MappedFile&      = delete;
+
+  [[nodiscard]] auto GetBytes() const noexcept -> std::span<const std::byte>;
+
+private:
+  std::span<const std::byte> m_bytes;
+};
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& filename)
+{
+  const auto fail = [&filename]()
+  { throw std::runtime_error("Could not map snapshot file '" + filename.string() + "'."); };
+
+  auto* const file = ::CreateFileW(filename.c_str(),
+                                   GENERIC_READ,
+                                   FILE_SHARE_READ,
+                                   nullptr,
+                                   OPEN_EXISTING,
+                                   FILE_FLAG_SEQUENTIAL_SCAN,
+                                   nullptr);
+  if (INVALID_HANDLE_VALUE == file)
+  {
+    fail();
+  }
+  auto size = LARGE_INTEGER{};
+  if (0 == ::GetFileSizeEx(file, &size))
+  {
+    ::CloseHandle(file);
+    fail();
+  }
+  if (0 == size.QuadPart)
+  {
+    ::CloseHandle(file);
+    return; // nothing to map, and too short to be a snapshot
+  }
+
+  // The view keeps the mapping, and the mapping the file, open after the handles are closed.
+  auto* const mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  ::CloseHandle(file);
+  if (nullptr == mapping)
+  {
+    fail();
+  }
+  const auto* const data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  ::CloseHandle(mapping);
+  if (nullptr == data)
+  {
+    fail();
+  }
+
+  m_bytes = {static_cast<const std::byte*>(data), static_cast<size_t>(size.QuadPart)};
+}
+
+MappedFile::~MappedFile() noexcept
+{
+  if (not m_bytes.empty())
+  {
+    ::UnmapViewOfFile(m_bytes.data());
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& filename)
+{
+  const auto file = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0)
+  {
+    throw std::runtime_error("Could not open snapshot file '" + filename.string() + "'.");
+  }
+  struct stat status{};
+  if (0 != ::fstat(file, &status))
+  {
+    ::close(file);
+    throw std::runtime_error("Could not read snapshot file '" + filename.string() + "'.");
+  }
+  if (0 == status.st_size)
+  {
+    ::close(file);
+    return; // nothing to map, and too short to be a snapshot
+  }
+
+  // The mapping keeps the file open after it is closed.
+  const auto size = static_cast<size_t>(status.st_size);
+  auto* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (MAP_FAILED == data)
+  {
+    throw std::runtime_error("Could not map snapshot file '" + filename.string() + "'.");
+  }
+  // Only a hint, for reading ahead, so failing is fine.
+  static_cast<void>(::madvise(data, size, MADV_SEQUENTIAL));
+
+  m_bytes = {static_cast<const std::byte*>(data), size};
+}
+
+MappedFile::~MappedFile() noexcept
+{
+  if (not m_bytes.empty())
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<std::byte*>(m_bytes.data()), m_bytes.size());
+  }
+}
+
+#endif
+
+auto MappedFile::GetBytes() const noexcept -> std::span<const std::byte>
+{
+  return m_bytes;
+}
+
+} // namespace
+
+auto SaveSnapshot(const ParticleSystem& particleSystem, const std::filesystem::path& filename)
+    -> void
+{
+  const auto& particleData = particleSystem.GetFinalData();
+  const auto streams       = particleData.GetAliveStreams();
+  const auto streamSize    = uint64_t{streams[0].size_bytes()};
+
+  auto header = SnapshotHeader{
+      .magic          = SNAPSHOT_MAGIC,
+      .version        = SNAPSHOT_VERSION,
+      .byteOrderMark  = BYTE_ORDER_MARK,
+      .elementSize    = sizeof(glm::vec4),
+      .aliveCount     = particleData.GetAliveCount(),
+      .awakeCount     = particleData.GetAwakeCount(),
+      .simulationTime = particleSystem.GetSimulationTime(),
+      .streamOffsets  = {},
+  };
+  auto offset = AlignStream(sizeof(SnapshotHeader));
+  for (auto& streamOffset : header.streamOffsets)
+  {
+    streamOffset = offset;
+    offset       = AlignStream(offset + streamSize);
+  }
+
+  auto file = std::ofstream{filename, std::ios::binary};
+  WriteValue(file, header);
+  auto end = uint64_t{sizeof(SnapshotHeader)};
+  for (auto i = 0U; i < ParticleData::NUM_STREAMS; ++i)
+  {
+    WritePadding(file, header.streamOffsets.at(i) - end);
+    WriteStream(file, streams.at(i));
+    end = header.streamOffsets.at(i) + streamSize;
+  }
+
+  // Flushes the last of it, which can fail too.
+  file.close();
+  if (not file)
+  {
+    throw std::runtime_error("Could not write snapshot file '" + filename.string() + "'.");
+  }
+}
+
+auto LoadSnapshot(ParticleSystem& particleSystem, const std::filesystem::path& filename) -> void
+{
+  const auto file  = MappedFile{filename};
+  const auto bytes = file.GetBytes();
+
+  auto header = SnapshotHeader{};
+  if (bytes.size() >= sizeof(SnapshotHeader))
+  {
+    std::memcpy(&header, bytes.data(), sizeof(SnapshotHeader));
+  }
+  if ((header.magic != SNAPSHOT_MAGIC) or (header.byteOrderMark != BYTE_ORDER_MARK) or
+      (header.elementSize != sizeof(glm::vec4)))
+  {
+    throw std::runtime_error("Not a particle snapshot file '" + filename.string() + "'.");
+  }
+  if (header.version != SNAPSHOT_VERSION)
+  {
+    throw std::runtime_error("Particle snapshot file '" + filename.string() + "' is version " +
+                             std::to_string(header.version) + ", not " +
+                             std::to_string(SNAPSHOT_VERSION) + ".");
+  }
+  if ((header.aliveCount > particleSystem.GetNumAllParticles()) or
+      (header.awakeCount > header.aliveCount))
+  {
+    throw std::runtime_error("Particle snapshot file '" + filename.string() +
+                             "' has more particles than the system.");
+  }
+
+  const auto aliveCount = header.aliveCount;
+  const auto streamSize = aliveCount * sizeof(glm::vec4);
+  auto streams          = ParticleData::Streams{};
+  for (auto i = 0U; i < ParticleData::NUM_STREAMS; ++i)
+  {
+    const auto offset = header.streamOffsets.at(i);
+    if ((0U != (offset % STREAM_ALIGNMENT)) or (offset > bytes.size()) or
+        (streamSize > (bytes.size() - offset)))
+    {
+      throw std::runtime_error("Particle snapshot file '" + filename.string() +
+                               "' is truncated.");
+    }
+    // The mapping is page aligned and the offset a multiple of the stream alignment.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* const stream = reinterpret_cast<const glm::vec4*>(bytes.subspan(offset).data());
+    streams.at(i)            = std::span{stream, aliveCount};
+  }
+
+  particleSystem.Restore(streams, header.awakeCount, header.simulationTime);
+}
+
+SnapshotCache::SnapshotCache(std::filesystem::path directory) noexcept
+  : m_directory{std::move(directory)}
+{
+}
+
+auto SnapshotCache::GetPath(const std::string_view name, const size_t numParticles) const
+    -> std::filesystem::path
+{
+  return m_directory / (std::string{name} + "-" + std::to_string(numParticles) + ".psnap");
+}
+
+auto SnapshotCache::Restore(ParticleSystem& particleSystem, const std::string_view name) const
+    -> bool
+{
+  const auto path = GetPath(name, particleSystem.GetNumAllParticles());
+  auto error      = std::error_code{};
+  if (not std::filesystem::exists(path, error))
+  {
+    return false;
+  }
+
+  try
+  {
+    LoadSnapshot(particleSystem, path);
+  }
+  catch (const std::runtime_error&)
+  {
+    return false;
+  }
+  return true;
+}
+
+auto SnapshotCache::Store(const ParticleSystem& particleSystem, const std::string_view name) const
+    -> bool
+{
+  const auto path = GetPath(name, particleSystem.GetNumAllParticles());
+  auto temporary  = path;
+  temporary += ".tmp";
+
+  try
+  {
+    std::filesystem::create_directories(m_directory);
+    SaveSnapshot(particleSystem, temporary);
+    std::filesystem::rename(temporary, path);
+  }
+  catch (const std::runtime_error&) // 'std::filesystem::filesystem_error' is one too
+  {
+    auto error = std::error_code{};
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+} // namespace PARTICLES
@@ -0,0 +1,87 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+module Particles.SpatialGrid;
+
+import Particles.Parallel;
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+auto SpatialHashGrid::GetChunkSlotCounts(const uint32_t chunk) noexcept -> std::span<uint32_t>
+{
+  return std::span{m_chunkSlotCounts}.subspan(static_cast<size_t>(chunk) * m_numSlots, m_numSlots);
+}
+
+// A counting sort in three passes. The particles are split into chunks, one per thread, and
+// each chunk counts its own slots. A prefix sum over the counts, slot by slot and chunk by
+// chunk within a slot, then gives every chunk its own write position in each slot, so the
+// scatter needs no atomics and the sorted order is the same whatever the number of threads.
+auto SpatialHashGrid::Build(const ParticleData& particleData, const IdRange& idRange) noexcept
+    -> void
+{
+  const auto numParticles = idRange.end - idRange.start;
+  const auto numChunks    = nullptr == m_parallel ? 1U : m_parallel->GetNumThreads();
+  const auto positions    = particleData.GetPositions().subspan(idRange.start, numParticles);
+
+  m_particleSlots.resize(numParticles);
+  m_sortedIds.resize(numParticles);
+  m_sortedPositions.resize(numParticles);
+  m_chunkSlotCounts.assign(static_cast<size_t>(numChunks) * m_numSlots, 0U);
+
+  const auto forLoop = [this, numParticles](const Parallel::LoopFunc& loopFunc)
+  {
+    if (nullptr == m_parallel)
+    {
+      loopFunc(0U, 0U, numParticles);
+      return;
+    }
+    m_parallel->ForLoop(numParticles, loopFunc);
+  };
+
+  forLoop(
+      [this, &positions](const uint32_t chunk, const size_t begin, const size_t end)
+      {
+        const auto slotCounts = GetChunkSlotCounts(chunk);
+        for (auto i = begin; i < end; ++i)
+        {
+          const auto slot    = GetSlot(positions[i]);
+          m_particleSlots[i] = slot;
+          ++slotCounts[slot];
+        }
+      });
+
+  auto slotStart = 0U;
+  for (auto slot = 0U; slot < m_numSlots; ++slot)
+  {
+    m_slotStarts[slot] = slotStart;
+    for (auto chunk = 0U; chunk < numChunks; ++chunk)
+    {
+      auto& count           = GetChunkSlotCounts(chunk)[slot];
+      const auto chunkCount = count;
+      count                 = slotStart;
+      slotStart += chunkCount;
+    }
+  }
+  m_slotStarts[m_numSlots] = slotStart;
+
+  forLoop(
+      [this, &positions, &idRange](const uint32_t chunk, const size_t begin, const size_t end)
+      {
+        const auto slotOffsets = GetChunkSlotCounts(chunk);
+        for (auto i = begin; i < end; ++i)
+        {
+          const auto offset         = slotOffsets[m_particleSlots[i]]++;
+          m_sortedIds[offset]       = static_cast<uint32_t>(idRange.start + i);
+          m_sortedPositions[offset] = positions[i];
+        }
+      });
+}
+
+} // namespace PARTICLES
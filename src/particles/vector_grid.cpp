@@ -0,0 +1,219 @@
+module;
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <glm/gtc/noise.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+module Particles.VectorGrid;
+
+namespace PARTICLES
+{
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+
+VectorGrid::VectorGrid(const glm::vec4& boundsMin,
+                       const glm::vec4& boundsMax,
+                       const uint32_t resolution)
+  : m_boundsMin{boundsMin},
+    m_boundsMax{boundsMax},
+    m_resolution{resolution},
+    m_pointsPerUnit{static_cast<float>(resolution - 1) / (boundsMax - boundsMin)},
+    m_values(m_bricksPerAxis * m_bricksPerAxis * m_bricksPerAxis * BRICK_VOLUME, glm::vec4{0.0F})
+{
+  assert(resolution >= 2U);
+  m_pointsPerUnit.w = 0.0F;
+}
+
+auto VectorGrid::GetPointPosition(const uint32_t x,
+                                  const uint32_t y,
+                                  const uint32_t z) const noexcept -> glm::vec4
+{
+  const auto cellsPerAxis = static_cast<float>(m_resolution - 1);
+  const auto fraction     = glm::vec4{static_cast<float>(x) / cellsPerAxis,
+                                  static_cast<float>(y) / cellsPerAxis,
+                                  static_cast<float>(z) / cellsPerAxis,
+                                  0.0F};
+  auto position = m_boundsMin + (fraction * (m_boundsMax - m_boundsMin));
+  position.w    = 0.0F;
+
+  return position;
+}
+
+namespace
+{
+
+constexpr auto FILE_MAGIC = std::array{'P', 'V', 'G', '3'};
+
+struct FileHeader
+{
+  std::array<char, FILE_MAGIC.size()> magic;
+  uint32_t resolution;
+  std::array<float, 3> boundsMin;
+  std::array<float, 3> boundsMax;
+  uint64_t version;
+};
+
+template<typename T>
+auto ReadValue(std::ifstream& file, T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+// A row of points at a time, which is much quicker than one by one.
+auto ReadRow(std::ifstream& file, std::vector<glm::vec4>& row) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(row.data()),
+            static_cast<std::streamsize>(row.size() * sizeof(glm::vec4)));
+}
+
+auto WriteRow(std::ofstream& file, const std::vector<glm::vec4>& row) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(row.data()),
+             static_cast<std::streamsize>(row.size() * sizeof(glm::vec4)));
+}
+
+template<typename T>
+auto WriteValue(std::ofstream& file, const T& value) -> void
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+auto VectorGrid::LoadFromFile(const std::string& filename) -> VectorGrid
+{
+  auto file = std::ifstream{filename, std::ios::binary};
+  if (not file)
+  {
+    throw std::runtime_error("Could not open vector grid file '" + filename + "'.");
+  }
+
+  auto header = FileHeader{};
+  ReadValue(file, header);
+  if ((not file) or (header.magic != FILE_MAGIC) or (header.resolution < 2U))
+  {
+    throw std::runtime_error("Not a vector grid file '" + filename + "'.");
+  }
+
+  auto grid = VectorGrid{
+      glm::vec4{header.boundsMin[0], header.boundsMin[1], header.boundsMin[2], 0.0F},
+      glm::vec4{header.boundsMax[0], header.boundsMax[1], header.boundsMax[2], 0.0F},
+      header.resolution};
+  grid.m_version = header.version;
+
+  auto row = std::vector<glm::vec4>(grid.m_resolution);
+  for (auto z = 0U; z < grid.m_resolution; ++z)
+  {
+    for (auto y = 0U; y < grid.m_resolution; ++y)
+    {
+      ReadRow(file, row);
+      for (auto x = 0U; x < grid.m_resolution; ++x)
+      {
+        grid.SetValue(x, y, z, row[x]);
+      }
+    }
+  }
+  if (not file)
+  {
+    throw std::runtime_error("Vector grid file '" + filename + "' is truncated.");
+  }
+
+  return grid;
+}
+
+auto VectorGrid::SaveToFile(const std::string& filename) const -> void
+{
+  auto file = std::ofstream{filename, std::ios::binary};
+
+  WriteValue(file,
+             FileHeader{
+                 .magic      = FILE_MAGIC,
+                 .resolution = m_resolution,
+                 .boundsMin  = {m_boundsMin.x, m_boundsMin.y, m_boundsMin.z},
+                 .boundsMax  = {m_boundsMax.x, m_boundsMax.y, m_boundsMax.z},
+                 .version    = m_version,
+  });
+
+  auto row = std::vector<glm::vec4>(m_resolution);
+  for (auto z = 0U; z < m_resolution; ++z)
+  {
+    for (auto y = 0U; y < m_resolution; ++y)
+    {
+      for (auto x = 0U; x < m_resolution; ++x)
+      {
+        row[x] = GetValue(x, y, z);
+      }
+      WriteRow(file, row);
+    }
+  }
+
+  file.close();
+  if (not file)
+  {
+    throw std::runtime_error("Could not write vector grid file '" + filename + "'.");
+  }
+}
+
+auto MakeCurlNoiseGrid(const glm::vec4& boundsMin,
+                       const glm::vec4& boundsMax,
+                       const uint32_t resolution,
+                       const CurlNoiseSettings& settings) -> VectorGrid
+{
+  // Each potential component is the same noise, well apart.
+  static constexpr auto COMPONENT_OFFSETS = std::array{
+      glm::vec3{0.0F, 0.0F, 0.0F},
+      glm::vec3{31.416F, 47.853F, 12.679F},
+      glm::vec3{-23.172F, 19.534F, 71.237F},
+  };
+  static constexpr auto SEED_OFFSET = glm::vec3{101.3F, 67.9F, 89.1F};
+  static constexpr auto EPSILON     = 1.0e-3F;
+
+  const auto seedOffset = static_cast<float>(settings.seed) * SEED_OFFSET;
+  const auto potential  = [&](const glm::vec3& point, const size_t component)
+  { return glm::perlin(point + COMPONENT_OFFSETS.at(component) + seedOffset); };
+
+  // Partial derivative of potential component 'component' along 'axis'.
+  const auto derivative = [&](const glm::vec3& point, const size_t component, const int axis)
+  {
+    auto delta  = glm::vec3{0.0F};
+    delta[axis] = EPSILON;
+    return (potential(point + delta, component) - potential(point - delta, component)) /
+           (2.0F * EPSILON);
+  };
+
+  auto grid = VectorGrid{boundsMin, boundsMax, resolution};
+
+  for (auto z = 0U; z < resolution; ++z)
+  {
+    for (auto y = 0U; y < resolution; ++y)
+    {
+      for (auto x = 0U; x < resolution; ++x)
+      {
+        const auto point = settings.frequency * glm::vec3{grid.GetPointPosition(x, y, z)};
+
+        const auto curl = glm::vec3{derivative(point, 2, 1) - derivative(point, 1, 2),
+                                    derivative(point, 0, 2) - derivative(point, 2, 0),
+                                    derivative(point, 1, 0) - derivative(point, 0, 1)};
+
+        grid.SetValue(x, y, z, glm::vec4{settings.amplitude * curl, 0.0F});
+      }
+    }
+  }
+
+  return grid;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-union-access)
+
+} // namespace PARTICLES
@@ -0,0 +1,164 @@
+module;
+
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <span>
+
+module Particles.VertexFormats;
+
+import Particles.Particles;
+
+namespace PARTICLES
+{
+
+// The loops read the streams directly and keep to plain arithmetic on whole vectors, so the
+// compiler can vectorize them for whatever the target has. Each format writes a range and a
+// list of particles with the same loop, 'getId(i)' giving the particle for the i-th record.
+
+namespace
+{
+
+template<typename GetId>
+auto WritePositionColor(const ParticleData& particleData,
+                        const size_t numParticles,
+                        const GetId getId,
+                        const std::span<PositionColorFormat::Vertex> vertices) noexcept -> void
+{
+  const auto positions = particleData.GetPositions();
+  const auto colors    = particleData.GetColors();
+
+  for (auto i = size_t{0U}; i < numParticles; ++i)
+  {
+    const auto id = getId(i);
+    vertices[i]   = {.position = glm::vec3{positions[id]}, .color = PackColor(colors[id])};
+  }
+}
+
+template<typename GetId>
+auto WriteQuantizedPositionColor(
+    const ParticleData& particleData,
+    const QuantizedPositionColorFormat::Settings& settings,
+    const size_t numParticles,
+    const GetId getId,
+    const std::span<QuantizedPositionColorFormat::Vertex> vertices) noexcept -> void
+{
+  static constexpr auto MAX_COORDINATE = 65535.0F;
+
+  const auto positions = particleData.GetPositions();
+  const auto colors    = particleData.GetColors();
+
+  const auto extent = glm::max(settings.boundsMax - settings.boundsMin,
+                               glm::vec4{std::numeric_limits<float>::min()});
+  const auto scale  = MAX_COORDINATE / extent;
+
+  for (auto i = size_t{0U}; i < numParticles; ++i)
+  {
+    const auto id = getId(i);
+    const auto coordinates =
+        glm::clamp((positions[id] - settings.boundsMin) * scale, 0.0F, MAX_COORDINATE) + 0.5F;
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+    vertices[i] = {.position = {static_cast<uint16_t>(coordinates.x),
+                                static_cast<uint16_t>(coordinates.y),
+                                static_cast<uint16_t>(coordinates.z),
+                                0U},
+                   .color    = PackColor(colors[id])};
+    // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+  }
+}
+
+template<typename GetId>
+auto WriteQuadCorners(const ParticleData& particleData,
+                      const QuadCornerFormat::Settings& settings,
+                      const size_t numParticles,
+                      const GetId getId,
+                      const std::span<QuadCornerFormat::Vertex> vertices) noexcept -> void
+{
+  const auto positions = particleData.GetPositions();
+  const auto colors    = particleData.GetColors();
+
+  const auto right = settings.halfSize * glm::vec3{settings.cameraRight};
+  const auto up    = settings.halfSize * glm::vec3{settings.cameraUp};
+
+  auto vertex = vertices.begin();
+  for (auto i = size_t{0U}; i < numParticles; ++i)
+  {
+    const auto id     = getId(i);
+    const auto centre = glm::vec3{positions[id]};
+    const auto color  = PackColor(colors[id]);
+
+    *vertex++ = {.position = centre - right - up, .color = color};
+    *vertex++ = {.position = centre + right - up, .color = color};
+    *vertex++ = {.position = centre + right + up, .color = color};
+    *vertex++ = {.position = centre - right + up, .color = color};
+  }
+}
+
+} // namespace
+
+auto PositionColorFormat::Write(const ParticleData& particleData,
+                                [[maybe_unused]] const Settings& settings,
+                                const IdRange& idRange,
+                                const std::span<Vertex> vertices) noexcept -> void
+{
+  WritePositionColor(particleData,
+                     idRange.end - idRange.start,
+                     [start = idRange.start](const size_t i) { return start + i; },
+                     vertices);
+}
+
+auto PositionColorFormat::Write(const ParticleData& particleData,
+                                [[maybe_unused]] const Settings& settings,
+                                const std::span<const uint32_t> ids,
+                                const std::span<Vertex> vertices) noexcept -> void
+{
+  WritePositionColor(
+      particleData, ids.size(), [ids](const size_t i) { return ids[i]; }, vertices);
+}
+
+auto QuantizedPositionColorFormat::Write(const ParticleData& particleData,
+                                         const Settings& settings,
+                                         const IdRange& idRange,
+                                         const std::span<Vertex> vertices) noexcept -> void
+{
+  WriteQuantizedPositionColor(particleData,
+                              settings,
+                              idRange.end - idRange.start,
+                              [start = idRange.start](const size_t i) { return start + i; },
+                              vertices);
+}
+
+auto QuantizedPositionColorFormat::Write(const ParticleData& particleData,
+                                         const Settings& settings,
+                                         const std::span<const uint32_t> ids,
+                                         const std::span<Vertex> vertices) noexcept -> void
+{
+  WriteQuantizedPositionColor(
+      particleData, settings, ids.size(), [ids](const size_t i) { return ids[i]; }, vertices);
+}
+
+auto QuadCornerFormat::Write(const ParticleData& particleData,
+                             const Settings& settings,
+                             const IdRange& idRange,
+                             const std::span<Vertex> vertices) noexcept -> void
+{
+  WriteQuadCorners(particleData,
+                   settings,
+                   idRange.end - idRange.start,
+                   [start = idRange.start](const size_t i) { return start + i; },
+                   vertices);
+}
+
+auto QuadCornerFormat::Write(const ParticleData& particleData,
+                             const Settings& settings,
+                             const std::span<const uint32_t> ids,
+                             const std::span<Vertex> vertices) noexcept -> void
+{
+  WriteQuadCorners(
+      particleData, settings, ids.size(), [ids](const size_t i) { return ids[i]; }, vertices);
+}
+
+} // namespace PARTICLES
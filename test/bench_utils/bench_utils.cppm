@@ -0,0 +1,52 @@
+module;
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+export module BenchUtils;
+
+// What the test programs share for timing things and showing the results.
+
+export namespace BENCH_UTILS
+{
+
+// The nearest rank percentile, 'percentile' from 0 to 1, of samples sorted in increasing
+// order. There must be at least one.
+[[nodiscard]] auto GetPercentile(const std::vector<double>& sortedSamples, double percentile)
+    -> double;
+
+// Prints the column names and a separator line under them, as a markdown table.
+auto PrintTableHeader(std::ostream& out, const std::vector<std::string>& columns) -> void;
+
+} // namespace BENCH_UTILS
+
+namespace BENCH_UTILS
+{
+
+inline auto GetPercentile(const std::vector<double>& sortedSamples, const double percentile)
+    -> double
+{
+  const auto rank =
+      static_cast<size_t>(std::ceil(percentile * static_cast<double>(sortedSamples.size())));
+  return sortedSamples[std::max(rank, size_t{1U}) - 1U];
+}
+
+inline auto PrintTableHeader(std::ostream& out, const std::vector<std::string>& columns) -> void
+{
+  for (auto i = size_t{0U}; i < columns.size(); ++i)
+  {
+    out << ((0U == i) ? "" : " | ") << columns[i];
+  }
+  out << "\n";
+  for (auto i = size_t{0U}; i < columns.size(); ++i)
+  {
+    out << ((0U == i) ? "" : "|") << "-------";
+  }
+  out << "\n";
+}
+
+} // namespace BENCH_UTILS
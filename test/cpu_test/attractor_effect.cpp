@@ -19,6 +19,7 @@ using GENERATORS::SphereVelocityGenerator;
 using UPDATERS::AttractorUpdater;
 using UPDATERS::BasicTimeUpdater;
 using UPDATERS::EulerUpdater;
+using UPDATERS::StaggerSchedule;
 using UPDATERS::VelocityColorUpdater;
 
 static constexpr auto EMIT_RATE_FACTOR = 0.1F;
@@ -94,7 +95,8 @@ static constexpr auto DEFAULT_NUM_PARTICLES = 250000U;
 
 AttractorEffect::AttractorEffect(const size_t numParticles) noexcept
   : m_system{numParticles == 0 ? DEFAULT_NUM_PARTICLES : numParticles},
-    m_colorUpdater{std::make_shared<VelocityColorUpdater>(MIN_VELOCITY, MAX_VELOCITY)}
+    m_colorUpdater{std::make_shared<VelocityColorUpdater>(MIN_VELOCITY, MAX_VELOCITY)},
+    m_scheduledColorUpdater{m_colorUpdater}
 {
   AddEmitters();
   AddUpdaters();
@@ -145,16 +147,20 @@ auto AttractorEffect::AddUpdaters() noexcept -> void
   m_system.AddUpdater(eulerUpdater);
 }
 
+auto AttractorEffect::SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void
+{
+  ScheduleUpdater(m_colorUpdater, schedule, m_scheduledColorUpdater);
+}
+
 auto AttractorEffect::UpdateEffect(const double dt) noexcept -> void
 {
-  static auto s_lifetime = 0.0F;
-  s_lifetime += static_cast<float>(dt);
+  m_lifetime += static_cast<float>(dt);
 
   const auto zScale = 1.0F;
 
   for (auto i = 0U; i < NUM_EMITTERS; ++i)
   {
-    const auto angle = s_lifetime * POS_LIFETIME_FACTORS[i];
+    const auto angle = m_lifetime * POS_LIFETIME_FACTORS[i];
 
     m_positionGenerators[i]->SetPosition({UPDATE_RADIUS_X[i] * std::sin(angle),
                                           UPDATE_RADIUS_Y[i] * std::cos(angle),
@@ -8,6 +8,7 @@ module;
 export module CpuTest.Particles.AttractorEffect;
 
 import Particles.Effect;
+import Particles.Frustum;
 import Particles.ParticleGenerators;
 import Particles.ParticleUpdaters;
 import Particles.Particles;
@@ -15,6 +16,7 @@ import Particles.Particles;
 using PARTICLES::GENERATORS::BasicColorGenerator;
 using PARTICLES::GENERATORS::BoxPositionGenerator;
 using PARTICLES::UPDATERS::AttractorUpdater;
+using PARTICLES::UPDATERS::StaggerSchedule;
 using PARTICLES::UPDATERS::VelocityColorUpdater;
 
 export namespace PARTICLES::EFFECTS
@@ -32,17 +34,25 @@ public:
   auto SetTintColor(const glm::vec4& tintColor) noexcept -> void override;
   auto SetTintMixAmount(float mixAmount) noexcept -> void override;
   auto SetMaxNumAliveParticles(size_t maxNumAliveParticles) noexcept -> void override;
+  auto SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void override;
 
   auto Update(double dt) noexcept -> void override;
+  auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool override;
 
   [[nodiscard]] auto GetSystem() const noexcept -> const ParticleSystem& override;
 
+protected:
+  [[nodiscard]] auto GetMutableSystem() noexcept -> ParticleSystem& override;
+  auto SetEffectTime(double time) noexcept -> void override;
+
 private:
   ParticleSystem m_system;
 
   std::shared_ptr<VelocityColorUpdater> m_colorUpdater;
+  std::shared_ptr<IParticleUpdater> m_scheduledColorUpdater;
   std::array<std::shared_ptr<ParticleEmitter>, NUM_EMITTERS> m_particleEmitters;
   std::array<std::shared_ptr<BoxPositionGenerator>, NUM_EMITTERS> m_positionGenerators;
+  float m_lifetime = 0.0F;
 
   auto AddEmitters() noexcept -> void;
   auto AddUpdaters() noexcept -> void;
@@ -85,9 +95,24 @@ inline auto AttractorEffect::Update(const double dt) noexcept -> void
   m_system.Update(dt);
 }
 
+inline auto AttractorEffect::UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool
+{
+  return m_system.UpdateVisibility(viewFrustum);
+}
+
 inline auto AttractorEffect::GetSystem() const noexcept -> const ParticleSystem&
 {
   return m_system;
 }
 
+inline auto AttractorEffect::GetMutableSystem() noexcept -> ParticleSystem&
+{
+  return m_system;
+}
+
+inline auto AttractorEffect::SetEffectTime(const double time) noexcept -> void
+{
+  m_lifetime = static_cast<float>(time);
+}
+
 } // namespace PARTICLES::EFFECTS
@@ -1,17 +1,120 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/random.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+import Particles.Colliders;
+import Particles.DepthSorter;
+import Particles.DistanceField;
 import Particles.Effect;
+import Particles.EffectTrace;
+import Particles.Fingerprint;
+import Particles.FrameRecorder;
+import Particles.Frustum;
+import Particles.Parallel;
+import Particles.ParticleCuller;
+import Particles.ParticleGenerators;
+import Particles.ParticleUpdaters;
 import Particles.Particles;
+import Particles.Random;
+import Particles.Snapshot;
+import Particles.VectorGrid;
+import Particles.VertexFormats;
+import BenchUtils;
 import CpuTest.Particles.AttractorEffect;
 import CpuTest.Particles.FountainEffect;
 import CpuTest.Particles.TunnelEffect;
 
+using BENCH_UTILS::GetPercentile;
+using BENCH_UTILS::PrintTableHeader;
+using PARTICLES::BoxCollider;
+using PARTICLES::CapsuleCollider;
+using PARTICLES::ColliderSet;
+using PARTICLES::DepthSorter;
+using PARTICLES::DepthSortMode;
+using PARTICLES::DistanceFieldSettings;
+using PARTICLES::FrameReader;
+using PARTICLES::FrameRecorder;
+using PARTICLES::FrameRecorderSettings;
+using PARTICLES::Frustum;
+using PARTICLES::LodSettings;
+using PARTICLES::Parallel;
+using PARTICLES::ParticleCuller;
+using PARTICLES::ParticleEmitter;
+using PARTICLES::ParticleData;
+using PARTICLES::ParticleStats;
+using PARTICLES::ParticleSystem;
+using PARTICLES::PositionColorFormat;
+using PARTICLES::QuadCornerFormat;
+using PARTICLES::QuantizedPositionColorFormat;
+using PARTICLES::PlaneCollider;
+using PARTICLES::SnapshotCache;
+using PARTICLES::SphereCollider;
+using PARTICLES::VectorGrid;
 using PARTICLES::EFFECTS::AttractorEffect;
+using PARTICLES::EFFECTS::EffectTraceInfo;
+using PARTICLES::EFFECTS::EffectTracePlayer;
 using PARTICLES::EFFECTS::FountainEffect;
 using PARTICLES::EFFECTS::IEffect;
+using PARTICLES::EFFECTS::TracedEffect;
 using PARTICLES::EFFECTS::TunnelEffect;
+using PARTICLES::GENERATORS::BasicTimeGenerator;
+using PARTICLES::GENERATORS::BasicVelocityGenerator;
+using PARTICLES::GENERATORS::BoxPositionGenerator;
+using PARTICLES::UPDATERS::AttractorEvaluation;
+using PARTICLES::UPDATERS::AttractorUpdater;
+using PARTICLES::UPDATERS::BasicTimeUpdater;
+using PARTICLES::UPDATERS::ColliderUpdater;
+using PARTICLES::UPDATERS::DistanceFieldColliderUpdater;
+using PARTICLES::UPDATERS::EulerUpdater;
+using PARTICLES::UPDATERS::FloorUpdater;
+using PARTICLES::UPDATERS::FlockingSettings;
+using PARTICLES::UPDATERS::FlockingUpdater;
+using PARTICLES::UPDATERS::ForceSource;
+using PARTICLES::UPDATERS::ForceFieldCacheSettings;
+using PARTICLES::UPDATERS::IIntegratorUpdater;
+using PARTICLES::UPDATERS::SemiImplicitEulerUpdater;
+using PARTICLES::UPDATERS::SpatialReorderUpdater;
+using PARTICLES::UPDATERS::StaggerMode;
+using PARTICLES::UPDATERS::StaggerSchedule;
+using PARTICLES::UPDATERS::VectorFieldMode;
+using PARTICLES::UPDATERS::VectorFieldUpdater;
+using PARTICLES::UPDATERS::VelocityVerletUpdater;
 
 namespace
 {
@@ -44,82 +147,2898 @@ auto EffectFactory::create(const char* const name, const size_t numParticles)
   throw std::runtime_error("Effect not found.");
 }
 
-class CpuTimeQuery
+struct ColorDifference
 {
-public:
-  auto begin() -> void { m_cpuTimePointStart = std::chrono::high_resolution_clock::now(); }
+  double mean;
+  double max;
+};
+
+// How far the colors of an effect have drifted from a reference run of the same effect.
+// Both runs must have been started with the same random seed.
+[[nodiscard]] auto GetColorDifference(const ParticleData& reference, const ParticleData& other)
+    -> ColorDifference
+{
+  const auto numAlive = std::min(reference.GetAliveCount(), other.GetAliveCount());
+  if (0 == numAlive)
+  {
+    return {.mean = 0.0, .max = 0.0};
+  }
+
+  auto sumDiff = 0.0;
+  auto maxDiff = 0.0;
+  for (auto i = 0U; i < numAlive; ++i)
+  {
+    const auto diff = glm::abs(reference.GetColor(i) - other.GetColor(i));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+    const auto channelDiff = static_cast<double>(std::max({diff.r, diff.g, diff.b, diff.a}));
+
+    sumDiff += channelDiff;
+    maxDiff = std::max(maxDiff, channelDiff);
+  }
+
+  return {.mean = sumDiff / static_cast<double>(numAlive), .max = maxDiff};
+}
+
+auto CompareStaggeredColorUpdates(const std::vector<std::string>& effectNames,
+                                  const size_t numParticles,
+                                  const uint32_t frameCount,
+                                  const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED = 1U;
+  static constexpr auto SCHEDULES   = std::array{
+      StaggerSchedule{.mode = StaggerMode::EVERY_NTH_FRAME, .period = 4U},
+      StaggerSchedule{.mode = StaggerMode::ROTATING_WINDOW, .period = 4U},
+  };
+
+  const auto runEffect = [&](const std::string& name, const StaggerSchedule& schedule)
+  {
+    std::srand(RANDOM_SEED);
+    auto effect = EffectFactory::create(name.c_str(), numParticles);
+    effect->SetColorUpdateSchedule(schedule);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      effect->Update(dt);
+    }
+    const auto diff = std::chrono::steady_clock::now() - start;
+
+    return std::pair{effect, std::chrono::duration<double, std::milli>(diff).count()};
+  };
+
+  std::cout << "\nstaggered color updates, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "schedule",
+                    "every frame",
+                    "staggered",
+                    "mean color diff",
+                    "max color diff"});
+
+  for (const auto& name : effectNames)
+  {
+    const auto [referenceEffect, referenceTime] = runEffect(name, StaggerSchedule{});
+
+    for (const auto& schedule : SCHEDULES)
+    {
+      const auto [effect, time] = runEffect(name, schedule);
+      const auto colorDiff      = GetColorDifference(referenceEffect->GetSystem().GetFinalData(),
+                                                effect->GetSystem().GetFinalData());
+
+      std::cout << name << " | "
+                << (StaggerMode::EVERY_NTH_FRAME == schedule.mode ? "every " : "window 1/")
+                << schedule.period << " | " << referenceTime << " | " << time << " | "
+                << colorDiff.mean << " | " << colorDiff.max << "\n";
+    }
+  }
+}
+
+// Each effect in view, then out of view, where it only emits and ages its particles, and the
+// frame that brings it back up to date.
+auto CompareCulledEffects(const std::vector<std::string>& effectNames,
+                          const size_t numParticles,
+                          const uint32_t frameCount,
+                          const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED   = 1U;
+  static constexpr auto FIELD_OF_VIEW = glm::radians(60.0F);
+  static constexpr auto NEAR_PLANE    = 0.1F;
+  static constexpr auto FAR_PLANE     = 100.0F;
+  static constexpr auto EYE           = glm::vec3{0.0F, 0.0F, 5.0F};
+
+  const auto projection = glm::perspective(FIELD_OF_VIEW, 1.0F, NEAR_PLANE, FAR_PLANE);
+  const auto facingView = Frustum::FromViewProjection(
+      projection * glm::lookAt(EYE, glm::vec3{0.0F}, glm::vec3{0.0F, 1.0F, 0.0F}));
+  const auto turnedAway = Frustum::FromViewProjection(
+      projection * glm::lookAt(EYE, 2.0F * EYE, glm::vec3{0.0F, 1.0F, 0.0F}));
+
+  const auto runFrames = [frameCount, dt](IEffect& effect, const Frustum& view)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      effect.UpdateVisibility(view);
+      effect.Update(dt);
+    }
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count() / frameCount;
+  };
+
+  std::cout << "\nwhole effect culling, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "in view",
+                    "culled",
+                    "catch-up frame",
+                    "alive in view",
+                    "alive culled"});
+
+  for (const auto& name : effectNames)
+  {
+    std::srand(RANDOM_SEED);
+    const auto visibleEffect = EffectFactory::create(name.c_str(), numParticles);
+    std::srand(RANDOM_SEED);
+    const auto culledEffect = EffectFactory::create(name.c_str(), numParticles);
+
+    // Both start in view, so there are bounds to cull by.
+    runFrames(*visibleEffect, facingView);
+    runFrames(*culledEffect, facingView);
+
+    const auto visibleTime = runFrames(*visibleEffect, facingView);
+    const auto culledTime  = runFrames(*culledEffect, turnedAway);
+
+    const auto start = std::chrono::steady_clock::now();
+    culledEffect->UpdateVisibility(facingView);
+    culledEffect->Update(dt);
+    const auto diff = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << " | " << visibleTime << " | " << culledTime << " | "
+              << std::chrono::duration<double, std::milli>(diff).count() << " | "
+              << visibleEffect->GetNumAliveParticles() << " | "
+              << culledEffect->GetNumAliveParticles() << "\n";
+  }
+}
+
+// The tunnel with every particle updated every frame, and with the particles further down the
+// tunnel updated less often.
+auto CompareTunnelLod(const size_t numParticles, const uint32_t frameCount, const double dt)
+    -> void
+{
+  static constexpr auto RANDOM_SEED = 1U;
+
+  const auto runEffect = [&](const bool enableLod)
+  {
+    std::srand(RANDOM_SEED);
+    auto effect = TunnelEffect{numParticles};
+    if (enableLod)
+    {
+      effect.EnableLod();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      effect.Update(dt);
+    }
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count() / frameCount;
+  };
+
+  std::cout << "\ntunnel level of detail, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout, {"every frame", "by tier"});
+
+  const auto everyFrameTime = runEffect(false);
+  const auto byTierTime     = runEffect(true);
+  std::cout << everyFrameTime << " | " << byTierTime << "\n";
+}
+
+// The flocking updater on one thread, with no pool, and shared out between more and more
+// threads. Each particle only writes its own acceleration, so every thread count must give the
+// serial result.
+auto CompareFlockingScaling(const size_t numParticles) -> void
+{
+  static constexpr auto NUMS_THREADS = std::array{1U, 2U, 4U, 8U};
+  static constexpr auto NUM_UPDATES  = 10U;
+  static constexpr auto DT           = 1.0 / 60.0;
+  static constexpr auto MAX_VELOCITY = glm::vec4{0.5F, 0.5F, 0.5F, 0.0F};
+
+  auto random         = PARTICLES::Random{};
+  auto startParticles = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    startParticles.Wake(i);
+    startParticles.SetPosition(i, random.Uniform(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+    startParticles.SetVelocity(i, random.Uniform(-MAX_VELOCITY, MAX_VELOCITY));
+  }
+
+  const auto runFlocking = [&](const std::shared_ptr<Parallel>& parallel)
+  {
+    auto particleData = startParticles;
+    auto updater      = FlockingUpdater{FlockingSettings{}};
+    updater.SetParallel(parallel);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto update = 0U; update < NUM_UPDATES; ++update)
+    {
+      updater.Update(DT, particleData);
+    }
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::pair{particleData, std::chrono::duration<double, std::milli>(diff).count() /
+                                       NUM_UPDATES};
+  };
+
+  std::cout << "\nflocking thread scaling, " << numParticles << " particles, "
+            << std::thread::hardware_concurrency() << " hardware threads\n";
+  PrintTableHeader(std::cout,
+                   {"threads", "time per update", "speed-up", "max difference from serial"});
+
+  const auto [serialParticles, serialTime] = runFlocking(nullptr);
+  std::cout << "serial | " << serialTime << " | " << 1.0 << " | " << 0.0 << "\n";
+
+  for (const auto numThreads : NUMS_THREADS)
+  {
+    const auto [particleData, time] = runFlocking(std::make_shared<Parallel>(numThreads));
+    const auto comparison = PARTICLES::CompareParticles(serialParticles, particleData, 0.0F);
+    std::cout << numThreads << " | " << time << " | " << (serialTime / time) << " | "
+              << comparison.maxDifference << (comparison.IsWithinTolerance() ? "" : " (differs)")
+              << "\n";
+  }
+}
+
+// Many attractors, like an audio driven scene, with exact and Barnes-Hut evaluation, and a
+// baked field for when they don't move.
+auto CompareAttractorEvaluations(const size_t numParticles) -> void
+{
+  static constexpr auto RANDOM_SEED         = 1U;
+  static constexpr auto NUMS_ATTRACTORS     = std::array{4U, 16U, 64U, 256U, 1024U};
+  static constexpr auto OPENING_ANGLES      = std::array{0.3F, 0.5F, 0.8F};
+  static constexpr auto NUM_ERROR_SAMPLES   = 10000U;
+  static constexpr auto MIN_ATTRACTOR_FORCE = 0.05F;
+  static constexpr auto MAX_ATTRACTOR_FORCE = 0.5F;
+  static constexpr auto CACHE_SETTINGS      = ForceFieldCacheSettings{
+      .boundsMin        = glm::vec4{-1.0F, -1.0F, -1.0F, 0.0F},
+      .boundsMax        = glm::vec4{+1.0F, +1.0F, +1.0F, 0.0F},
+      .resolution       = 48U,
+      .tolerance        = 0.02F,
+      .bakeInBackground = false,
+  };
+
+  std::srand(RANDOM_SEED);
+  auto particleData = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    particleData.Wake(i);
+    particleData.SetPosition(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+  }
+
+  const auto timeUpdate = [&particleData](AttractorUpdater& attractorUpdater)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    attractorUpdater.Update(0.0, particleData);
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+
+  std::cout << "\nattractor evaluation, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout,
+                   {"attractors",
+                    "opening angle",
+                    "exact",
+                    "approximate",
+                    "mean error",
+                    "max error"});
 
-  auto end() -> void
+  for (const auto numAttractors : NUMS_ATTRACTORS)
   {
-    const auto diff  = std::chrono::high_resolution_clock::now() - m_cpuTimePointStart;
-    const auto milli = std::chrono::duration_cast<std::chrono::milliseconds>(diff).count();
-    m_time           = 0.5 * (m_time + static_cast<double>(milli));
+    auto attractorUpdater = AttractorUpdater{};
+    for (auto i = 0U; i < numAttractors; ++i)
+    {
+      auto attractorPosition = glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F});
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+      attractorPosition.w = glm::linearRand(MIN_ATTRACTOR_FORCE, MAX_ATTRACTOR_FORCE);
+      attractorUpdater.AddAttractorPosition(attractorPosition);
+    }
+
+    attractorUpdater.SetEvaluation(AttractorEvaluation::EXACT);
+    const auto exactTime = timeUpdate(attractorUpdater);
+
+    for (const auto openingAngle : OPENING_ANGLES)
+    {
+      attractorUpdater.SetEvaluation(AttractorEvaluation::BARNES_HUT, openingAngle);
+      const auto time  = timeUpdate(attractorUpdater);
+      const auto error =
+          attractorUpdater.MeasureApproximationError(particleData, NUM_ERROR_SAMPLES);
+
+      std::cout << numAttractors << " | " << openingAngle << " | " << exactTime << " | " << time
+                << " | " << error.meanRelativeError << " | " << error.maxRelativeError << "\n";
+    }
+
+    attractorUpdater.SetEvaluation(AttractorEvaluation::EXACT);
+    attractorUpdater.EnableForceFieldCache(CACHE_SETTINGS);
+    const auto bakeTime  = timeUpdate(attractorUpdater);
+    const auto cacheTime = timeUpdate(attractorUpdater);
+    const auto error =
+        attractorUpdater.MeasureApproximationError(particleData, NUM_ERROR_SAMPLES);
+
+    std::cout << numAttractors << " | baked (" << bakeTime << " first frame) | " << exactTime
+              << " | " << cacheTime << " | " << error.meanRelativeError << " | "
+              << error.maxRelativeError << "\n";
   }
+}
 
-  [[nodiscard]] auto GetTimeInMilliseconds() const -> double { return m_time; }
+constexpr auto COLLIDER_FLOOR_Y = -1.0F;
+constexpr auto NUMS_COLLIDERS   = std::array{1U, 4U, 16U, 64U};
 
-private:
-  double m_time{};
-  std::chrono::time_point<std::chrono::high_resolution_clock> m_cpuTimePointStart;
+// The shapes given to a 'ColliderSet', kept to check it against.
+struct ColliderShapes
+{
+  std::vector<PlaneCollider> planes;
+  std::vector<SphereCollider> spheres;
+  std::vector<BoxCollider> boxes;
+  std::vector<CapsuleCollider> capsules;
 };
 
-} // namespace
+// A floor and then a mix of small shapes, from 'std::rand'.
+[[nodiscard]] auto MakeColliderShapes(const uint32_t numColliders) -> ColliderShapes
+{
+  static constexpr auto MIN_SHAPE_SIZE  = 0.02F;
+  static constexpr auto MAX_SHAPE_SIZE  = 0.1F;
+  static constexpr auto NUM_SHAPE_TYPES = 3U;
+
+  auto shapes = ColliderShapes{};
+  shapes.planes.push_back({.point  = glm::vec4{0.0F, COLLIDER_FLOOR_Y, 0.0F, 0.0F},
+                           .normal = glm::vec4{0.0F, 1.0F, 0.0F, 0.0F}});
+  for (auto i = 1U; i < numColliders; ++i)
+  {
+    const auto centre = glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F});
+    const auto size   = glm::linearRand(MIN_SHAPE_SIZE, MAX_SHAPE_SIZE);
+    switch (i % NUM_SHAPE_TYPES)
+    {
+      case 0U:
+        shapes.spheres.push_back({.centre = centre, .radius = size});
+        break;
+      case 1U:
+        shapes.boxes.push_back({.centre      = centre,
+                                .halfExtents = glm::vec4{size},
+                                .orientation = glm::mat3{1.0F}});
+        break;
+      default:
+        shapes.capsules.push_back(
+            {.start = centre, .end = centre + glm::vec4{size}, .radius = 0.5F * size});
+        break;
+    }
+  }
 
-int main()
+  return shapes;
+}
+
+[[nodiscard]] auto MakeColliderSet(const ColliderShapes& shapes) -> std::shared_ptr<ColliderSet>
 {
-  static const std::vector<std::string> s_EFFECTS_NAME{"tunnel", "attractors", "fountain"};
+  auto colliders = std::make_shared<ColliderSet>();
+  std::ranges::for_each(shapes.planes, [&](const auto& plane) { colliders->AddPlane(plane); });
+  std::ranges::for_each(shapes.spheres, [&](const auto& sphere) { colliders->AddSphere(sphere); });
+  std::ranges::for_each(shapes.boxes, [&](const auto& box) { colliders->AddBox(box); });
+  std::ranges::for_each(shapes.capsules,
+                        [&](const auto& capsule) { colliders->AddCapsule(capsule); });
+  return colliders;
+}
+
+// The signed distance to the nearest shape, worked out shape by shape from the definitions,
+// without the tables or the grid.
+[[nodiscard]] auto GetColliderDistance(const ColliderShapes& shapes, const glm::vec4& position)
+    -> float
+{
+  const auto point = glm::vec3{position};
+  auto distance    = std::numeric_limits<float>::max();
+
+  for (const auto& plane : shapes.planes)
+  {
+    distance = std::min(distance,
+                        glm::dot(point - glm::vec3{plane.point},
+                                 glm::normalize(glm::vec3{plane.normal})));
+  }
+  for (const auto& sphere : shapes.spheres)
+  {
+    distance = std::min(distance, glm::distance(point, glm::vec3{sphere.centre}) - sphere.radius);
+  }
+  for (const auto& box : shapes.boxes)
+  {
+    const auto offset  = point - glm::vec3{box.centre};
+    const auto local   = glm::vec3{glm::dot(offset, glm::normalize(box.orientation[0])),
+                                 glm::dot(offset, glm::normalize(box.orientation[1])),
+                                 glm::dot(offset, glm::normalize(box.orientation[2]))};
+    const auto outside = glm::abs(local) - glm::vec3{box.halfExtents};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+    const auto maxOutside  = std::max({outside.x, outside.y, outside.z});
+    const auto boxDistance = glm::length(glm::max(outside, 0.0F)) + std::min(maxOutside, 0.0F);
+    distance               = std::min(distance, boxDistance);
+  }
+  for (const auto& capsule : shapes.capsules)
+  {
+    const auto start = glm::vec3{capsule.start};
+    const auto axis  = glm::vec3{capsule.end} - start;
+    const auto along =
+        glm::clamp(glm::dot(point - start, axis) / glm::dot(axis, axis), 0.0F, 1.0F);
+    distance = std::min(distance, glm::distance(point, start + (along * axis)) - capsule.radius);
+  }
+
+  return distance;
+}
+
+// The first update pushes the particles out, so the timed ones are the usual case of nearly
+// every particle clear of every collider.
+auto CompareColliderCounts(const size_t numParticles) -> void
+{
+  static constexpr auto RANDOM_SEED   = 1U;
+  static constexpr auto NUM_REPEATS   = 5U;
+  static constexpr auto BOUNCE_FACTOR = 0.5F;
+  static constexpr auto FRICTION      = 0.1F;
+
+  std::srand(RANDOM_SEED);
+  auto particleData = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    particleData.Wake(i);
+    particleData.SetPosition(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+    particleData.SetVelocity(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+  }
 
-  static constexpr auto START_NUM_PARTICLES = 1000U;
-  static constexpr auto END_NUM_PARTICLES   = 301000U;
-  static constexpr auto PARTICLES_NUM_STEPS = 30U;
-  static constexpr auto NUM_PARTICLES_STEP =
-      (END_NUM_PARTICLES - START_NUM_PARTICLES) / PARTICLES_NUM_STEPS;
+  const auto timeUpdate = [&particleData](PARTICLES::IParticleUpdater& updater)
+  {
+    updater.Update(0.0, particleData);
+    auto bestTime = std::numeric_limits<double>::max();
+    for (auto repeat = 0U; repeat < NUM_REPEATS; ++repeat)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      updater.Update(0.0, particleData);
+      const auto diff = std::chrono::steady_clock::now() - start;
+      bestTime = std::min(bestTime, std::chrono::duration<double, std::milli>(diff).count());
+    }
+    return bestTime;
+  };
 
-  static constexpr auto DELTA_TIME  = 1.0 / 60.0; // 60 fps
-  static constexpr auto FRAME_COUNT = 200U;
+  std::cout << "\ncolliders, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout, {"colliders", "time"});
 
-  CpuTimeQuery timer;
+  auto floorUpdater = FloorUpdater{COLLIDER_FLOOR_Y, BOUNCE_FACTOR};
+  std::cout << "floor updater | " << timeUpdate(floorUpdater) << "\n";
 
-  std::cout << "count | ";
-  for (const auto& n : s_EFFECTS_NAME)
+  for (const auto numColliders : NUMS_COLLIDERS)
   {
-    std::cout << n.c_str() << " | ";
+    auto colliderUpdater =
+        ColliderUpdater{MakeColliderSet(MakeColliderShapes(numColliders)), BOUNCE_FACTOR, FRICTION};
+    std::cout << numColliders << " | " << timeUpdate(colliderUpdater) << "\n";
   }
-  std::cout << "\n";
-  std::cout << "-------|----------\n";
 
-  std::cout.setf(std::ios::fixed, std::ios::floatfield);
-  std::cout.precision(3);
-  std::wcout << std::fixed;
+  // A torus, which the analytic shapes can't make. The second bake comes from the cache file.
+  // A fatter tube is a new shape version, so it is baked again rather than loaded.
+  static constexpr auto TORUS_RADIUS    = 0.5F;
+  static constexpr auto TUBE_RADIUS     = 0.2F;
+  static constexpr auto FAT_TUBE_RADIUS = 0.3F;
+  auto tubeRadius          = TUBE_RADIUS;
+  const auto torusDistance = [&tubeRadius](const glm::vec4& position)
+  {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+    const auto ringOffset = glm::vec2{glm::length(glm::vec2{position.x, position.z}) - TORUS_RADIUS,
+                                      position.y};
+    // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+    return glm::length(ringOffset) - tubeRadius;
+  };
+
+  const auto cacheFilename = std::filesystem::temp_directory_path() / "cpu_test_torus.pvg";
+  std::filesystem::remove(cacheFilename);
+  auto settings = DistanceFieldSettings{
+      .boundsMin     = glm::vec4{-1.0F},
+      .boundsMax     = glm::vec4{+1.0F},
+      .resolution    = 64U,
+      .cacheFilename = cacheFilename.string(),
+      .shapeVersion  = 1U,
+  };
+  const auto parallel = std::make_shared<Parallel>(0U);
+
+  auto distanceField = std::shared_ptr<const VectorGrid>{};
+  const auto timeBake = [&]()
+  {
+    const auto start = std::chrono::steady_clock::now();
+    distanceField    = std::make_shared<const VectorGrid>(
+        PARTICLES::MakeDistanceField(settings, torusDistance, parallel));
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+  const auto bakeTime   = timeBake();
+  const auto cachedTime = timeBake();
+
+  auto distanceFieldUpdater =
+      DistanceFieldColliderUpdater{distanceField, BOUNCE_FACTOR, FRICTION};
+  const auto updateTime = timeUpdate(distanceFieldUpdater);
+
+  tubeRadius = FAT_TUBE_RADIUS;
+  ++settings.shapeVersion;
+  const auto newShapeTime = timeBake();
+  std::cout << "distance field (" << bakeTime << " bake, " << cachedTime << " cached, "
+            << newShapeTime << " new shape) | " << updateTime << "\n";
+}
+
+// Sampling a vector field bigger than the cache, with the particles in random order, then
+// after a full round of windowed reordering, then after sorting them all at once.
+auto CompareSpatialReordering(const size_t numParticles) -> void
+{
+  static constexpr auto RANDOM_SEED       = 1U;
+  static constexpr auto FIELD_RESOLUTION  = 128U;
+  static constexpr auto FIELD_FREQUENCY   = 2.0F;
+  static constexpr auto REORDER_PERIOD    = 16U;
+  static constexpr auto NUM_FIELD_REPEATS = 5U;
 
-  for (auto step = 0U; step < PARTICLES_NUM_STEPS; ++step)
+  std::srand(RANDOM_SEED);
+  auto particleData = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
   {
-    const auto numParticles = START_NUM_PARTICLES + (step * NUM_PARTICLES_STEP);
+    particleData.Wake(i);
+    particleData.SetPosition(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+  }
 
-    if ((numParticles < 150000) or (numParticles > 200000))
+  const auto field = std::make_shared<const VectorGrid>(
+      PARTICLES::MakeCurlNoiseGrid(glm::vec4{-1.0F},
+                                   glm::vec4{+1.0F},
+                                   FIELD_RESOLUTION,
+                                   {.frequency = FIELD_FREQUENCY}));
+  auto fieldUpdater = VectorFieldUpdater{field, VectorFieldMode::FORCE, 1.0F};
+
+  const auto timeUpdate = [&particleData](PARTICLES::IParticleUpdater& updater)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    updater.Update(0.0, particleData);
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+  const auto printRow = [&](const std::string& order, const double reorderTime)
+  {
+    auto fieldTime = std::numeric_limits<double>::max();
+    for (auto repeat = 0U; repeat < NUM_FIELD_REPEATS; ++repeat)
     {
-      continue;
+      fieldTime = std::min(fieldTime, timeUpdate(fieldUpdater));
     }
+    std::cout << order << " | " << SpatialReorderUpdater::MeasureLocality(particleData) << " | "
+              << reorderTime << " | " << fieldTime << "\n";
+  };
+
+  std::cout << "\nspatial reordering, " << numParticles << " particles, " << FIELD_RESOLUTION
+            << "^3 field\n";
+  PrintTableHeader(std::cout, {"order", "locality", "slowest reorder frame", "field sampling"});
+
+  printRow("random", 0.0);
 
-    std::cout << numParticles << " | ";
+  auto windowedReorder = SpatialReorderUpdater{REORDER_PERIOD};
+  auto slowestFrame    = 0.0;
+  for (auto frame = 0U; frame < REORDER_PERIOD; ++frame)
+  {
+    slowestFrame = std::max(slowestFrame, timeUpdate(windowedReorder));
+  }
+  printRow("windowed, period " + std::to_string(REORDER_PERIOD), slowestFrame);
+
+  auto fullReorder = SpatialReorderUpdater{1U};
+  printRow("all at once", timeUpdate(fullReorder));
+}
+
+// Bounds, speeds and mean age gathered by the Euler and time updaters as they go, against a
+// separate pass over the particles after them.
+auto CompareStatsGathering(const size_t numParticles) -> void
+{
+  static constexpr auto RANDOM_SEED  = 1U;
+  static constexpr auto NUM_REPEATS  = 20U;
+  static constexpr auto DELTA_TIME   = 1.0 / 60.0;
+  static constexpr auto MAX_LIFETIME = 1000.0F;
+  static constexpr auto GRAVITY      = glm::vec4{0.0F, -1.0F, 0.0F, 0.0F};
+
+  std::srand(RANDOM_SEED);
+  auto startData = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    startData.Wake(i);
+    startData.SetPosition(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+    startData.SetVelocity(i, glm::linearRand(glm::vec4{-1.0F}, glm::vec4{1.0F}));
+    const auto lifetime = glm::linearRand(MAX_LIFETIME / 2.0F, MAX_LIFETIME);
+    startData.SetTime(i, {lifetime, 0.0F, 0.0F, 1.0F / MAX_LIFETIME});
+  }
+
+  auto timeUpdater  = BasicTimeUpdater{};
+  auto eulerUpdater = EulerUpdater{GRAVITY};
 
-    for (const auto& n : s_EFFECTS_NAME)
+  // Each repeat starts from the same particles, so every row should show the same stats.
+  const auto timeUpdates = [&](const bool gatherStats, const bool separatePass)
+  {
+    auto bestTime = std::numeric_limits<double>::max();
+    auto stats    = ParticleStats{};
+    for (auto repeat = 0U; repeat < NUM_REPEATS; ++repeat)
     {
-      const auto effect = EffectFactory::create(n.c_str(), numParticles);
+      auto particleData = startData;
+      particleData.SetGatherStats(gatherStats);
+
+      const auto start = std::chrono::steady_clock::now();
 
-      timer.begin();
-      for (auto frame = 0U; frame < FRAME_COUNT; ++frame)
+      timeUpdater.Update(DELTA_TIME, particleData);
+      eulerUpdater.Update(DELTA_TIME, particleData);
+      stats = particleData.GetStats();
+      if (separatePass)
       {
-        effect->Update(DELTA_TIME);
+        for (auto i = 0U; i < particleData.GetAliveCount(); ++i)
+        {
+          const auto& time = particleData.GetTime(i);
+          stats.AddMotion(particleData.GetPosition(i), particleData.GetVelocity(i));
+          stats.AddAge((1.0F / time.w) - time.x);
+        }
       }
-      timer.end();
 
-      std::cout << timer.GetTimeInMilliseconds() << " | ";
+      const auto diff = std::chrono::steady_clock::now() - start;
+      bestTime        = std::min(bestTime, std::chrono::duration<double, std::milli>(diff).count());
+    }
+    return std::pair{bestTime, stats};
+  };
+
+  const auto printRow = [](const std::string& name, const std::pair<double, ParticleStats>& row)
+  {
+    const auto& [time, stats] = row;
+    std::cout << name << " | " << time;
+    if (stats.HasBounds())
+    {
+      std::cout << " | " << stats.boundsMin.y << ".." << stats.boundsMax.y << " | "
+                << stats.GetMaxSpeed() << " | " << stats.GetMeanAge();
     }
     std::cout << "\n";
+  };
+
+  std::cout << "\nstats gathering, " << numParticles << " particles, time and Euler updaters\n";
+  PrintTableHeader(std::cout, {"stats", "update time", "y bounds", "max speed", "mean age"});
+
+  printRow("none", timeUpdates(false, false));
+  printRow("separate pass", timeUpdates(false, true));
+  printRow("gathered by updaters", timeUpdates(true, false));
+}
+
+// Velocity Verlet for effects whose only force is gravity.
+auto MakeGravityOnlyVerlet(const glm::vec4& gravity) -> std::shared_ptr<VelocityVerletUpdater>
+{
+  auto integrator = std::make_shared<VelocityVerletUpdater>(gravity);
+  integrator->SetForceSource(ForceSource::GLOBAL_ONLY);
+  return integrator;
+}
+
+// A fountain - gravity, a floor and nothing else - with each integrator. Verlet taking gravity
+// as the only force needs no accelerations, so the system skips clearing them as well. The
+// error is how far the particles are, after a second of flight, from where the closed form
+// puts them.
+auto CompareGravityOnlyFountain(const size_t numParticles,
+                                const uint32_t frameCount,
+                                const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED        = 1U;
+  static constexpr auto GRAVITY            = glm::vec4{0.0F, -9.81F, 0.0F, 0.0F};
+  static constexpr auto FLOOR_Y            = -1.0F;
+  static constexpr auto BOUNCE_FACTOR      = 0.5F;
+  static constexpr auto MIN_LIFETIME       = 3.0F;
+  static constexpr auto MAX_LIFETIME       = 4.0F;
+  static constexpr auto MIN_START_VELOCITY = glm::vec4{-0.5F, 4.0F, -0.5F, 0.0F};
+  static constexpr auto MAX_START_VELOCITY = glm::vec4{+0.5F, 6.0F, +0.5F, 0.0F};
+  static constexpr auto FLIGHT_TIME        = 1.0F;
+
+  const auto runFountain = [&](const std::shared_ptr<IIntegratorUpdater>& integrator)
+  {
+    std::srand(RANDOM_SEED);
+    auto system  = ParticleSystem{numParticles};
+    auto emitter = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(static_cast<float>(numParticles) / MAX_LIFETIME);
+    emitter->AddGenerator(std::make_shared<BoxPositionGenerator>(
+        glm::vec4{0.0F, FLOOR_Y, 0.0F, 0.0F}, glm::vec4{0.0F}));
+    emitter->AddGenerator(
+        std::make_shared<BasicVelocityGenerator>(MIN_START_VELOCITY, MAX_START_VELOCITY));
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(MIN_LIFETIME, MAX_LIFETIME));
+    system.AddEmitter(emitter);
+    system.AddUpdater(std::make_shared<BasicTimeUpdater>());
+    system.AddUpdater(integrator);
+    system.AddUpdater(std::make_shared<FloorUpdater>(FLOOR_Y, BOUNCE_FACTOR));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      system.Update(dt);
+    }
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count() / frameCount;
+  };
+
+  const auto measureError = [&](IIntegratorUpdater& integrator)
+  {
+    std::srand(RANDOM_SEED);
+    auto particleData = ParticleData{numParticles};
+    for (auto i = 0U; i < numParticles; ++i)
+    {
+      particleData.Wake(i);
+      particleData.SetVelocity(i, glm::linearRand(MIN_START_VELOCITY, MAX_START_VELOCITY));
+    }
+
+    const auto numSteps = static_cast<uint32_t>(FLIGHT_TIME / static_cast<float>(dt));
+    for (auto step = 0U; step < numSteps; ++step)
+    {
+      for (auto i = 0U; i < numParticles; ++i)
+      {
+        particleData.SetAcceleration(i, glm::vec4{0.0F});
+      }
+      integrator.Update(dt, particleData);
+    }
+
+    std::srand(RANDOM_SEED);
+    const auto time = static_cast<float>(numSteps) * static_cast<float>(dt);
+    auto maxError   = 0.0F;
+    for (auto i = 0U; i < numParticles; ++i)
+    {
+      const auto velocity = glm::linearRand(MIN_START_VELOCITY, MAX_START_VELOCITY);
+      const auto exact    = (time * velocity) + (0.5F * time * time * GRAVITY);
+      maxError = std::max(maxError, glm::distance(exact, particleData.GetPosition(i)));
+    }
+    return maxError;
+  };
+
+  std::cout << "\ngravity only fountain, " << numParticles << " particles, error after "
+            << FLIGHT_TIME << " s\n";
+  PrintTableHeader(std::cout, {"integrator", "time per frame", "error"});
+
+  const auto printRow = [&](const std::string& name,
+                            const std::shared_ptr<IIntegratorUpdater>& integrator)
+  {
+    std::cout << name << " | " << runFountain(integrator) << " | " << measureError(*integrator)
+              << "\n";
+  };
+  printRow("semi-implicit Euler", std::make_shared<SemiImplicitEulerUpdater>(GRAVITY));
+  printRow("velocity Verlet", std::make_shared<VelocityVerletUpdater>(GRAVITY));
+  printRow("velocity Verlet, gravity only", MakeGravityOnlyVerlet(GRAVITY));
+}
+
+// Filling a vertex buffer the way a renderer does it by hand - a particle at a time through
+// 'GetPosition' and 'GetColor' into its own array, then copied to the buffer - against writing
+// each vertex format straight into the buffer.
+auto CompareVertexWriting(const std::vector<std::string>& effectNames,
+                          const size_t numParticles,
+                          const uint32_t frameCount,
+                          const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED      = 1U;
+  static constexpr auto NUM_REPEATS      = 20U;
+  static constexpr auto QUAD_HALF_SIZE   = 0.01F;
+  static constexpr auto NUM_QUAD_CORNERS = QuadCornerFormat::VERTICES_PER_PARTICLE;
+
+  // These stand in for mapped buffers.
+  auto mappedBuffer    = std::vector<PositionColorFormat::Vertex>(NUM_QUAD_CORNERS * numParticles);
+  auto quantizedBuffer = std::vector<QuantizedPositionColorFormat::Vertex>(numParticles);
+  auto stagingBuffer   = std::vector<PositionColorFormat::Vertex>(numParticles);
+
+  const auto bestTime = [](const auto& write)
+  {
+    auto best = std::numeric_limits<double>::max();
+    for (auto repeat = 0U; repeat < NUM_REPEATS; ++repeat)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      write();
+      const auto diff = std::chrono::steady_clock::now() - start;
+      best            = std::min(best, std::chrono::duration<double, std::milli>(diff).count());
+    }
+    return best;
+  };
+
+  std::cout << "\nvertex writing, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "by hand and copied",
+                    "position + color",
+                    "quantized",
+                    "quad corners"});
+
+  for (const auto& name : effectNames)
+  {
+    std::srand(RANDOM_SEED);
+    const auto effect = EffectFactory::create(name.c_str(), numParticles);
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      effect->Update(dt);
+    }
+    const auto& system       = effect->GetSystem();
+    const auto& particleData = system.GetFinalData();
+    const auto numAlive      = particleData.GetAliveCount();
+
+    const auto byHandTime = bestTime(
+        [&]
+        {
+          for (auto i = 0U; i < numAlive; ++i)
+          {
+            stagingBuffer[i] = {.position = glm::vec3{particleData.GetPosition(i)},
+                                .color    = PARTICLES::PackColor(particleData.GetColor(i))};
+          }
+          std::memcpy(
+              mappedBuffer.data(), stagingBuffer.data(), numAlive * sizeof(stagingBuffer[0]));
+        });
+
+    const auto directTime = bestTime(
+        [&] { system.WriteVertices<PositionColorFormat>({}, std::span{mappedBuffer}); });
+
+    const auto quantizedTime = bestTime(
+        [&]
+        {
+          system.WriteVertices<QuantizedPositionColorFormat>(
+              {.boundsMin = glm::vec4{-1.0F}, .boundsMax = glm::vec4{1.0F}},
+              std::span{quantizedBuffer});
+        });
+
+    const auto quadTime = bestTime(
+        [&]
+        {
+          system.WriteVertices<QuadCornerFormat>({.cameraRight = {1.0F, 0.0F, 0.0F, 0.0F},
+                                                  .cameraUp    = {0.0F, 1.0F, 0.0F, 0.0F},
+                                                  .halfSize    = QUAD_HALF_SIZE},
+                                                 std::span{mappedBuffer});
+        });
+
+    std::cout << name << " | " << byHandTime << " | " << directTime << " | " << quantizedTime
+              << " | " << quadTime << "\n";
+  }
+}
+
+// Back to front order of the alive particles of each effect, from a view orbiting the effect
+// and from a still one: std::sort from scratch, a radix sort from scratch and the adaptive sort
+// starting from last frame's order. The times are the mean per frame. While the view moves the
+// particles overtake each other by too many places for the adaptive sort, which then falls
+// back to the radix sort.
+auto CompareDepthSorting(const std::vector<std::string>& effectNames,
+                         const size_t numParticles,
+                         const uint32_t frameCount,
+                         const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED     = 1U;
+  static constexpr auto NUM_SORT_FRAMES = 60U;
+  static constexpr auto VIEW_DISTANCE   = 3.0F;
+  static constexpr auto ORBIT_SPEED     = 0.6F; // radians per second
+  struct View
+  {
+    const char* name;
+    float angularSpeed;
+    bool isPaused; // the effect is not updated, as when the game is paused
+  };
+  static constexpr auto VIEWS = std::array{
+      View{.name = "orbiting", .angularSpeed = ORBIT_SPEED, .isPaused = false},
+      View{.name = "still", .angularSpeed = 0.0F, .isPaused = false},
+      View{.name = "still, paused", .angularSpeed = 0.0F, .isPaused = true}};
+
+  const auto parallel = std::make_shared<Parallel>(0U);
+
+  const auto timeMs = [](const auto& sort)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    sort();
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+
+  std::cout << "\ndepth sorting, " << numParticles << " particles, mean per frame\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "view",
+                    "std::sort",
+                    "radix",
+                    "adaptive",
+                    "adaptive re-sorted"});
+
+  for (const auto& name : effectNames)
+  {
+    for (const auto& view : VIEWS)
+    {
+      std::srand(RANDOM_SEED);
+      const auto effect = EffectFactory::create(name.c_str(), numParticles);
+      for (auto frame = 0U; frame < frameCount; ++frame)
+      {
+        effect->Update(dt);
+      }
+
+      auto fullSorter     = DepthSorter{};
+      auto adaptiveSorter = DepthSorter{};
+      fullSorter.SetParallel(parallel);
+      fullSorter.SetMode(DepthSortMode::FULL);
+      adaptiveSorter.SetParallel(parallel);
+      auto stdOrder = std::vector<uint32_t>{};
+      auto depths   = std::vector<float>{};
+
+      auto stdTime      = 0.0;
+      auto radixTime    = 0.0;
+      auto adaptiveTime = 0.0;
+      auto numResorted  = size_t{0U};
+      auto allSorted    = true;
+
+      for (auto frame = 0U; frame < NUM_SORT_FRAMES; ++frame)
+      {
+        if (not view.isPaused)
+        {
+          effect->Update(dt);
+        }
+        const auto& particleData = effect->GetSystem().GetFinalData();
+        const auto numAlive      = particleData.GetAliveCount();
+
+        const auto angle =
+            view.angularSpeed * static_cast<float>(dt) * static_cast<float>(frame);
+        const auto viewPosition  = glm::vec4{VIEW_DISTANCE * std::sin(angle),
+                                             0.0F,
+                                             VIEW_DISTANCE * std::cos(angle),
+                                             1.0F};
+        const auto viewDirection = glm::vec4{-glm::normalize(glm::vec3{viewPosition}), 0.0F};
+        const auto isBackToFront = [&depths](const uint32_t lhs, const uint32_t rhs)
+        { return depths[lhs] > depths[rhs]; };
+
+        stdTime += timeMs(
+            [&]
+            {
+              depths.resize(numAlive);
+              for (auto i = 0U; i < numAlive; ++i)
+              {
+                depths[i] = glm::dot(particleData.GetPosition(i) - viewPosition, viewDirection);
+              }
+              stdOrder.resize(numAlive);
+              std::iota(stdOrder.begin(), stdOrder.end(), 0U);
+              std::ranges::sort(stdOrder, isBackToFront);
+            });
+        radixTime +=
+            timeMs([&] { fullSorter.Sort(particleData, viewPosition, viewDirection); });
+        adaptiveTime +=
+            timeMs([&] { adaptiveSorter.Sort(particleData, viewPosition, viewDirection); });
+        numResorted += adaptiveSorter.GetNumSortedLast();
+
+        const auto order = adaptiveSorter.GetOrder();
+        allSorted = allSorted and (order.size() == numAlive) and
+                    std::ranges::is_sorted(order, isBackToFront);
+      }
+
+      std::cout << name << " | " << view.name << " | " << (stdTime / NUM_SORT_FRAMES) << " | "
+                << (radixTime / NUM_SORT_FRAMES) << " | " << (adaptiveTime / NUM_SORT_FRAMES)
+                << " | " << (numResorted / NUM_SORT_FRAMES)
+                << (allSorted ? "" : " (NOT SORTED)") << "\n";
+    }
+  }
+}
+
+// The tunnel seen from inside, looking back at the emitter ring: particles stream past the view
+// long before they die. Writing the vertices, and depth sorting and writing them, for every
+// alive particle and for just the ones a per particle cull finds on screen. The times are the
+// mean per frame and include the cull.
+auto CompareParticleCulling(const size_t numParticles, const uint32_t frameCount, const double dt)
+    -> void
+{
+  static constexpr auto RANDOM_SEED      = 1U;
+  static constexpr auto NUM_TIMED_FRAMES = 30U;
+  static constexpr auto FIELD_OF_VIEW    = glm::radians(60.0F);
+  static constexpr auto NEAR_PLANE       = 0.01F;
+  static constexpr auto FAR_PLANE        = 10.0F;
+  static constexpr auto EYE              = glm::vec3{0.0F, 0.0F, 0.6F};
+  static constexpr auto SPRITE_RADIUS    = 0.005F;
+
+  const auto viewFrustum = Frustum::FromViewProjection(
+      glm::perspective(FIELD_OF_VIEW, 1.0F, NEAR_PLANE, FAR_PLANE) *
+      glm::lookAt(EYE, glm::vec3{0.0F}, glm::vec3{0.0F, 1.0F, 0.0F}));
+  const auto viewPosition  = glm::vec4{EYE, 1.0F};
+  const auto viewDirection = glm::vec4{0.0F, 0.0F, -1.0F, 0.0F};
+
+  const auto parallel = std::make_shared<Parallel>(0U);
+  auto culler         = ParticleCuller{};
+  auto sorter         = DepthSorter{};
+  culler.SetParallel(parallel);
+  culler.SetRadius(SPRITE_RADIUS);
+  sorter.SetParallel(parallel);
+  sorter.SetMode(DepthSortMode::FULL);
+  auto vertices = std::vector<PositionColorFormat::Vertex>(numParticles);
+
+  std::srand(RANDOM_SEED);
+  auto effect = TunnelEffect{numParticles};
+  for (auto frame = 0U; frame < frameCount; ++frame)
+  {
+    effect.Update(dt);
+  }
+
+  const auto timeMs = [](const auto& write)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    write();
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+
+  auto writeAllTime     = 0.0;
+  auto writeVisibleTime = 0.0;
+  auto sortAllTime      = 0.0;
+  auto sortVisibleTime  = 0.0;
+  auto numAlive         = size_t{0U};
+  auto numVisible       = size_t{0U};
+  auto numMiscounted    = size_t{0U};
+  for (auto frame = 0U; frame < NUM_TIMED_FRAMES; ++frame)
+  {
+    effect.Update(dt);
+    const auto& system       = effect.GetSystem();
+    const auto& particleData = system.GetFinalData();
+
+    writeAllTime +=
+        timeMs([&] { system.WriteVertices<PositionColorFormat>({}, std::span{vertices}); });
+    writeVisibleTime += timeMs(
+        [&]
+        {
+          const auto visible = culler.Cull(particleData, viewFrustum);
+          system.WriteVertices<PositionColorFormat>({}, visible, std::span{vertices});
+        });
+    sortAllTime += timeMs(
+        [&]
+        {
+          const auto order = sorter.Sort(particleData, viewPosition, viewDirection);
+          system.WriteVertices<PositionColorFormat>({}, order, std::span{vertices});
+        });
+    sortVisibleTime += timeMs(
+        [&]
+        {
+          const auto visible = culler.Cull(particleData, viewFrustum);
+          const auto order   = sorter.Sort(particleData, visible, viewPosition, viewDirection);
+          system.WriteVertices<PositionColorFormat>({}, order, std::span{vertices});
+        });
+
+    // A plain test of each particle against the frustum, pushed out by the radius, agrees.
+    auto planes = viewFrustum.GetPlanes();
+    for (auto& plane : planes)
+    {
+      plane.w += SPRITE_RADIUS;
+    }
+    const auto paddedFrustum = Frustum{planes};
+    auto numInside           = size_t{0U};
+    for (auto i = 0U; i < particleData.GetAliveCount(); ++i)
+    {
+      numInside += paddedFrustum.IsInside(particleData.GetPosition(i)) ? 1U : 0U;
+    }
+    numMiscounted += (numInside != culler.GetVisible().size()) ? 1U : 0U;
+
+    numAlive += particleData.GetAliveCount();
+    numVisible += culler.GetVisible().size();
   }
 
-  std::cout << "time in milliseconds\n";
+  std::cout << "\nper particle culling, tunnel seen from inside, " << numParticles
+            << " particles, mean per frame\n";
+  PrintTableHeader(std::cout,
+                   {"alive",
+                    "visible",
+                    "write all",
+                    "cull + write visible",
+                    "sort + write all",
+                    "cull + sort + write visible"});
+  std::cout << (numAlive / NUM_TIMED_FRAMES) << " | " << (numVisible / NUM_TIMED_FRAMES) << " | "
+            << (writeAllTime / NUM_TIMED_FRAMES) << " | " << (writeVisibleTime / NUM_TIMED_FRAMES)
+            << " | " << (sortAllTime / NUM_TIMED_FRAMES) << " | "
+            << (sortVisibleTime / NUM_TIMED_FRAMES)
+            << ((0U == numMiscounted) ? "" : " (VISIBLE COUNT DIFFERS)") << "\n";
+}
+
+// Each effect pre-warmed by running it, which stores a snapshot, then by restoring that in a new
+// effect, as a later run of the program would.
+auto CompareSnapshotPrewarm(const std::vector<std::string>& effectNames,
+                            const size_t numParticles,
+                            const double warmUpTime,
+                            const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED  = 1U;
+  static constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+
+  const auto cacheDirectory = std::filesystem::temp_directory_path() / "cpu_test_snapshots";
+  std::filesystem::remove_all(cacheDirectory);
+  const auto cache = SnapshotCache{cacheDirectory};
+
+  const auto timePrewarm = [&](IEffect& effect, const std::string& name)
+  {
+    const auto start    = std::chrono::steady_clock::now();
+    const auto restored = effect.Prewarm(cache, name, warmUpTime, dt);
+    const auto diff     = std::chrono::steady_clock::now() - start;
+    return std::pair{restored, std::chrono::duration<double, std::milli>(diff).count()};
+  };
+
+  std::cout << "\nsnapshot pre-warm, " << numParticles << " particles, " << warmUpTime << " s\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "warm up",
+                    "restore",
+                    "snapshot MB",
+                    "alive",
+                    "same particles"});
+
+  for (const auto& name : effectNames)
+  {
+    std::srand(RANDOM_SEED);
+    const auto warmedEffect = EffectFactory::create(name.c_str(), numParticles);
+    const auto [wasWarmedRestored, runTime] = timePrewarm(*warmedEffect, name);
+
+    const auto restoredEffect             = EffectFactory::create(name.c_str(), numParticles);
+    const auto [wasRestored, restoreTime] = timePrewarm(*restoredEffect, name);
+
+    const auto& warmed   = warmedEffect->GetSystem().GetFinalData();
+    const auto& restored = restoredEffect->GetSystem().GetFinalData();
+    const auto numAlive  = warmed.GetAliveCount();
+    const auto isSame    = (not wasWarmedRestored) and wasRestored and
+                        (numAlive == restored.GetAliveCount()) and
+                        std::ranges::equal(warmed.GetPositions().first(numAlive),
+                                           restored.GetPositions().first(numAlive));
+
+    const auto snapshotSize = std::filesystem::file_size(cache.GetPath(name, numParticles));
+    std::cout << name << " | " << runTime << " | " << restoreTime << " | "
+              << (static_cast<double>(snapshotSize) / BYTES_PER_MB) << " | " << numAlive << " | "
+              << (isSame ? "yes" : "no") << "\n";
+  }
+
+  std::filesystem::remove_all(cacheDirectory);
+}
+
+auto CompareFrameRecording(const std::vector<std::string>& effectNames,
+                           const size_t numParticles,
+                           const uint32_t frameCount,
+                           const double dt) -> void
+{
+  static constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+  static constexpr auto BOUNDS       = 8.0F;
+  // Steps through some of the frames out of order, a prime apart.
+  static constexpr auto RANDOM_STRIDE    = 7919U;
+  static constexpr auto NUM_RANDOM_READS = 20U;
+
+  using Vertex = QuantizedPositionColorFormat::Vertex;
+
+  const auto filename = std::filesystem::temp_directory_path() / "cpu_test_recording.pfr";
+  const auto settings = FrameRecorderSettings{
+      .boundsMin         = glm::vec4{-BOUNDS},
+      .boundsMax         = glm::vec4{+BOUNDS},
+      .keyFrameInterval  = FrameRecorderSettings{}.keyFrameInterval,
+      .numBufferedFrames = FrameRecorderSettings{}.numBufferedFrames,
+  };
+
+  const auto timeMs = [](const auto& function)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+
+  std::cout << "\nframe recording, " << numParticles << " particles, " << frameCount
+            << " frames\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "capture per frame",
+                    "dropped",
+                    "raw MB",
+                    "recorded MB",
+                    "read per frame in order",
+                    "out of order",
+                    "same particles"});
+
+  for (const auto& name : effectNames)
+  {
+    const auto effect        = EffectFactory::create(name.c_str(), numParticles);
+    const auto& particleData = effect->GetSystem().GetFinalData();
+
+    auto recorder    = std::make_unique<FrameRecorder>(filename, settings);
+    auto captureTime = 0.0;
+    auto rawBytes    = size_t{0U};
+    auto numAlive    = std::vector<size_t>{}; // of the frames kept
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      effect->Update(dt);
+      auto isCaptured = false;
+      captureTime += timeMs([&]()
+                            { isCaptured = recorder->Capture(particleData, frame * dt); });
+      if (isCaptured)
+      {
+        numAlive.push_back(particleData.GetAliveCount());
+        rawBytes += particleData.GetAliveCount() * ParticleData::NUM_STREAMS * sizeof(glm::vec4);
+      }
+    }
+    recorder->Close();
+    const auto numDropped    = recorder->GetNumDroppedFrames();
+    const auto recordedBytes = recorder->GetNumWrittenBytes();
+    recorder.reset();
+
+    // The last frame kept is the final state if it wasn't dropped.
+    auto expectedVertices = std::vector<Vertex>(particleData.GetAliveCount());
+    QuantizedPositionColorFormat::Write(
+        particleData,
+        {.boundsMin = settings.boundsMin, .boundsMax = settings.boundsMax},
+        {.start = 0U, .end = particleData.GetAliveCount()},
+        expectedVertices);
+    auto order = std::vector<uint32_t>(particleData.GetAliveCount());
+    std::iota(order.begin(), order.end(), 0U);
+    const auto ids = particleData.GetIds();
+    std::ranges::sort(order, {}, [&ids](const uint32_t i) { return ids[i]; });
+
+    auto reader        = FrameReader{filename};
+    auto isSame        = (reader.GetNumFrames() == numAlive.size());
+    const auto inOrder = timeMs(
+        [&]()
+        {
+          for (auto frame = size_t{0U}; frame < reader.GetNumFrames(); ++frame)
+          {
+            isSame = isSame and (reader.ReadFrame(frame).ids.size() == numAlive[frame]);
+          }
+        });
+    const auto outOfOrder = timeMs(
+        [&]()
+        {
+          for (auto i = size_t{0U}; i < NUM_RANDOM_READS; ++i)
+          {
+            const auto frame = (i * RANDOM_STRIDE) % reader.GetNumFrames();
+            isSame = isSame and (reader.ReadFrame(frame).ids.size() == numAlive[frame]);
+          }
+        });
+
+    if (0U == numDropped)
+    {
+      const auto& last = reader.ReadFrame(reader.GetNumFrames() - 1U);
+      for (auto i = size_t{0U}; isSame and (i < order.size()); ++i)
+      {
+        const auto& expected = expectedVertices[order[i]];
+        isSame = (last.ids[i] == ids[order[i]]) and
+                 (last.vertices[i].position[0] == expected.position[0]) and
+                 (last.vertices[i].position[1] == expected.position[1]) and
+                 (last.vertices[i].position[2] == expected.position[2]) and
+                 (last.vertices[i].color == expected.color);
+      }
+    }
+
+    std::cout << name << " | " << (captureTime / static_cast<double>(frameCount)) << " | "
+              << numDropped << " | " << (static_cast<double>(rawBytes) / BYTES_PER_MB) << " | "
+              << (static_cast<double>(recordedBytes) / BYTES_PER_MB) << " | "
+              << (inOrder / static_cast<double>(reader.GetNumFrames())) << " | "
+              << (outOfOrder / NUM_RANDOM_READS) << " | " << (isSame ? "yes" : "no") << "\n";
+  }
+
+  std::filesystem::remove(filename);
+}
+
+// Plays a trace frame by frame, timing each frame.
+auto PlayTimedFrames(EffectTracePlayer& player, IEffect& effect) -> std::vector<double>
+{
+  auto frameTimes = std::vector<double>{};
+  frameTimes.reserve(player.GetNumFrames());
+  while (true)
+  {
+    const auto start     = std::chrono::steady_clock::now();
+    const auto isPlaying = player.PlayFrame(effect);
+    const auto diff      = std::chrono::steady_clock::now() - start;
+    if (not isPlaying)
+    {
+      return frameTimes;
+    }
+    frameTimes.push_back(std::chrono::duration<double, std::milli>(diff).count());
+  }
+}
+
+// Each effect traced through a run with changing settings, views, thread pools and frame times,
+// then played back on a new effect, which should end up with exactly the same particles.
+auto CompareTraceReplay(const std::vector<std::string>& effectNames,
+                        const size_t numParticles,
+                        const uint32_t frameCount,
+                        const double dt) -> void
+{
+  static constexpr auto RANDOM_SEED     = 1U;
+  static constexpr auto FIELD_OF_VIEW   = glm::radians(60.0F);
+  static constexpr auto NEAR_PLANE      = 0.1F;
+  static constexpr auto FAR_PLANE       = 100.0F;
+  static constexpr auto EYE             = glm::vec3{0.0F, 0.0F, 5.0F};
+  static constexpr auto VIEW_PERIOD     = 50U;
+  static constexpr auto DT_JITTER       = 0.25;
+  static constexpr auto TINT_COLOR      = glm::vec4{1.0F, 0.5F, 0.25F, 1.0F};
+  static constexpr auto TINT_MIX_AMOUNT = 0.5F;
+  static constexpr auto SCHEDULE =
+      StaggerSchedule{.mode = StaggerMode::ROTATING_WINDOW, .period = 4U};
+  static constexpr auto NUM_THREADS = 2U;
+
+  const auto parallel   = std::make_shared<Parallel>(NUM_THREADS);
+  const auto filename   = std::filesystem::temp_directory_path() / "cpu_test_trace.ptrc";
+  const auto projection = glm::perspective(FIELD_OF_VIEW, 1.0F, NEAR_PLANE, FAR_PLANE);
+  const auto views      = std::array{
+      Frustum::FromViewProjection(
+          projection * glm::lookAt(EYE, glm::vec3{0.0F}, glm::vec3{0.0F, 1.0F, 0.0F})),
+      Frustum::FromViewProjection(
+          projection * glm::lookAt(EYE, 2.0F * EYE, glm::vec3{0.0F, 1.0F, 0.0F})),
+  };
+
+  std::cout << "\ntrace replay, " << numParticles << " particles, " << frameCount << " frames\n";
+  PrintTableHeader(std::cout,
+                   {"effect",
+                    "calls",
+                    "trace bytes",
+                    "traced run",
+                    "replay",
+                    "slowest frame",
+                    "at frame",
+                    "same particles"});
+
+  for (const auto& name : effectNames)
+  {
+    const auto info = EffectTraceInfo{
+        .effectName = name, .numParticles = numParticles, .randomSeed = RANDOM_SEED};
+    auto traced = TracedEffect{EffectFactory::create(name.c_str(), numParticles), info, filename};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      if (frame == (frameCount / 4U))
+      {
+        traced.SetTintColor(TINT_COLOR);
+        traced.SetTintMixAmount(TINT_MIX_AMOUNT);
+        traced.SetParallel(parallel);
+      }
+      if (frame == (frameCount / 2U))
+      {
+        traced.SetColorUpdateSchedule(SCHEDULE);
+        traced.SetMaxNumAliveParticles(numParticles / 2U);
+        traced.SetRandomSeed(RANDOM_SEED + 1U);
+      }
+      if (frame == ((3U * frameCount) / 4U))
+      {
+        traced.SetParallel(nullptr);
+      }
+      traced.UpdateVisibility(views.at((frame / VIEW_PERIOD) % views.size()));
+      traced.Update(dt * (1.0 + (DT_JITTER * std::sin(static_cast<double>(frame)))));
+    }
+    const auto runTime = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    traced.Close();
+
+    auto player            = EffectTracePlayer{filename};
+    const auto replayed    = EffectFactory::create(name.c_str(), numParticles);
+    const auto frameTimes  = PlayTimedFrames(player, *replayed);
+    const auto slowest     = std::ranges::max_element(frameTimes);
+    const auto& original   = traced.GetSystem().GetFinalData();
+    const auto& replayData = replayed->GetSystem().GetFinalData();
+    const auto numAlive    = original.GetAliveCount();
+    const auto isSame      = (numAlive == replayData.GetAliveCount()) and
+                        std::ranges::equal(original.GetPositions().first(numAlive),
+                                           replayData.GetPositions().first(numAlive)) and
+                        std::ranges::equal(original.GetColors().first(numAlive),
+                                           replayData.GetColors().first(numAlive));
+
+    std::cout << name << " | " << player.GetNumCalls() << " | "
+              << std::filesystem::file_size(filename) << " | " << runTime << " | "
+              << std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) << " | " << *slowest
+              << " | " << (slowest - frameTimes.begin()) << " | " << (isSame ? "yes" : "no")
+              << "\n";
+  }
+
+  std::filesystem::remove(filename);
+}
+
+// Runs a system and a faster version of it, from the same seed, side by side and reports the
+// first frame their particles aren't exactly the same, and the first they are further apart
+// than 'tolerance', see 'CompareParticles'.
+auto VerifyBackend(const std::string& name,
+                   ParticleSystem& reference,
+                   ParticleSystem& optimized,
+                   const uint32_t frameCount,
+                   const double dt,
+                   const float tolerance) -> bool
+{
+  auto firstChangedFrame = std::optional<uint32_t>{};
+  auto maxDifference     = 0.0F;
+  for (auto frame = 0U; frame < frameCount; ++frame)
+  {
+    reference.Update(dt);
+    optimized.Update(dt);
+
+    const auto referenceFingerprint = PARTICLES::TakeFingerprint(reference.GetFinalData());
+    const auto optimizedFingerprint = PARTICLES::TakeFingerprint(optimized.GetFinalData());
+    if ((referenceFingerprint.numAlive == optimizedFingerprint.numAlive) and
+        (referenceFingerprint.checksum == optimizedFingerprint.checksum))
+    {
+      continue;
+    }
+    if (not firstChangedFrame.has_value())
+    {
+      firstChangedFrame = frame;
+    }
+
+    const auto comparison = PARTICLES::CompareParticles(
+        reference.GetFinalData(), optimized.GetFinalData(), tolerance);
+    maxDifference = std::max(maxDifference, comparison.maxDifference);
+    if (not comparison.IsWithinTolerance())
+    {
+      std::cout << name << " | " << *firstChangedFrame << " | " << frame << " | "
+                << comparison.numOutside << " + " << comparison.numMissing << " missing of "
+                << comparison.numCompared << " | " << comparison.maxDifference << " (id "
+                << comparison.maxDifferentId << ")\n";
+      return false;
+    }
+  }
+
+  std::cout << name << " | " << (firstChangedFrame ? std::to_string(*firstChangedFrame) : "none")
+            << " | none | 0 | " << maxDifference << "\n";
+  return true;
+}
+
+// The faster versions of parts of the simulation checked against the plain ones: the
+// integrators shared out between threads, particles kept in spatial order, and approximated
+// attractor forces. Returns whether they all stay within their tolerances.
+auto VerifyBackends(const size_t numParticles, const uint32_t frameCount, const double dt)
+    -> bool
+{
+  static constexpr auto NUM_THREADS        = 4U;
+  static constexpr auto GRAVITY            = glm::vec4{0.0F, -1.0F, 0.0F, 0.0F};
+  static constexpr auto FLOOR_Y            = -1.0F;
+  static constexpr auto BOUNCE_FACTOR      = 0.5F;
+  static constexpr auto MIN_LIFETIME       = 1.0F;
+  static constexpr auto MAX_LIFETIME       = 2.0F;
+  static constexpr auto MIN_START_VELOCITY = glm::vec4{-0.5F, 0.5F, -0.5F, 0.0F};
+  static constexpr auto MAX_START_VELOCITY = glm::vec4{+0.5F, 1.5F, +0.5F, 0.0F};
+  static constexpr auto REORDER_PERIOD     = 8U;
+  static constexpr auto NUM_ATTRACTORS     = 128U;
+  static constexpr auto ATTRACTOR_FORCE    = 0.01F;
+  // Barnes-Hut is about a percent off per step, see 'AttractorUpdater::SetEvaluation'. The
+  // errors build up, and a few particles passing close to an attractor end up anywhere, so it is
+  // only checked over the first frames.
+  static constexpr auto EXACT_TOLERANCE        = 0.0F;
+  static constexpr auto BARNES_HUT_TOLERANCE   = 0.05F;
+  static constexpr auto BARNES_HUT_FRAME_COUNT = 20U;
+
+  const auto parallel = std::make_shared<Parallel>(NUM_THREADS);
+
+  // A fountain falling on a floor, with an attractor updater if one is given.
+  const auto makeSystem = [&](const std::shared_ptr<AttractorUpdater>& attractorUpdater)
+  {
+    auto system  = std::make_unique<ParticleSystem>(numParticles);
+    auto emitter = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(static_cast<float>(numParticles) / MAX_LIFETIME);
+    emitter->AddGenerator(std::make_shared<BoxPositionGenerator>(glm::vec4{0.0F},
+                                                                 glm::vec4{0.1F}));
+    emitter->AddGenerator(
+        std::make_shared<BasicVelocityGenerator>(MIN_START_VELOCITY, MAX_START_VELOCITY));
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(MIN_LIFETIME, MAX_LIFETIME));
+    system->AddEmitter(emitter);
+    system->AddUpdater(std::make_shared<BasicTimeUpdater>());
+    if (nullptr != attractorUpdater)
+    {
+      system->AddUpdater(attractorUpdater);
+    }
+    system->AddUpdater(std::make_shared<EulerUpdater>(GRAVITY));
+    system->AddUpdater(std::make_shared<FloorUpdater>(FLOOR_Y, BOUNCE_FACTOR));
+    return system;
+  };
+  const auto makeAttractors = [](const AttractorEvaluation evaluation)
+  {
+    auto random  = PARTICLES::Random{};
+    auto updater = std::make_shared<AttractorUpdater>();
+    for (auto i = 0U; i < NUM_ATTRACTORS; ++i)
+    {
+      auto position = random.Uniform(glm::vec4{-1.0F}, glm::vec4{1.0F});
+      position.w    = ATTRACTOR_FORCE; // NOLINT(cppcoreguidelines-pro-type-union-access)
+      updater->AddAttractorPosition(position);
+    }
+    updater->SetEvaluation(evaluation, AttractorUpdater::DEFAULT_OPENING_ANGLE);
+    return updater;
+  };
+
+  std::cout << "\nverify, " << numParticles << " particles, " << frameCount << " frames\n";
+  PrintTableHeader(std::cout,
+                   {"backend",
+                    "first changed frame",
+                    "first frame past tolerance",
+                    "particles past tolerance",
+                    "max difference"});
+
+  auto isVerified = true;
+
+  const auto serial         = makeSystem(nullptr);
+  const auto parallelSystem = makeSystem(nullptr);
+  parallelSystem->SetParallel(parallel);
+  isVerified = VerifyBackend("parallel integrators", *serial, *parallelSystem, frameCount, dt,
+                             EXACT_TOLERANCE) and
+               isVerified;
+
+  const auto unordered = makeSystem(nullptr);
+  const auto reordered = makeSystem(nullptr);
+  reordered->AddUpdater(std::make_shared<SpatialReorderUpdater>(REORDER_PERIOD));
+  isVerified = VerifyBackend("spatial reordering", *unordered, *reordered, frameCount, dt,
+                             EXACT_TOLERANCE) and
+               isVerified;
+
+  const auto exact     = makeSystem(makeAttractors(AttractorEvaluation::EXACT));
+  const auto barnesHut = makeSystem(makeAttractors(AttractorEvaluation::BARNES_HUT));
+  isVerified = VerifyBackend("Barnes-Hut attractors", *exact, *barnesHut,
+                             std::min(frameCount, BARNES_HUT_FRAME_COUNT), dt,
+                             BARNES_HUT_TOLERANCE) and
+               isVerified;
+
+  return isVerified;
+}
+
+// Level of detail checked against updating every particle every frame. The particles move
+// across the tier distances both ways, and must still be given all the time that passes, once.
+// Returns whether the particles are in the tiers their distances say, and whether they agree
+// with the reference whenever every tier has caught up.
+auto VerifyLod(const size_t numParticles, const uint32_t frameCount, const double dt) -> bool
+{
+  static constexpr auto VIEW_POSITION = glm::vec4{0.0F, 0.0F, 0.0F, 1.0F};
+  static constexpr auto LOD_SETTINGS  = LodSettings{
+       .tierDistances = {0.3F, 0.6F},
+       .updatePeriods = {1U, 2U, 4U},
+  };
+  static constexpr auto CATCH_UP_PERIOD       = 4U; // frames for every tier to be due together
+  static constexpr auto START_POSITION_OFFSET = glm::vec4{0.8F, 0.8F, 0.8F, 0.0F};
+  static constexpr auto MAX_START_VELOCITY    = glm::vec4{0.5F, 0.5F, 0.5F, 0.0F};
+  static constexpr auto LIFETIME              = 100.0F;
+  static constexpr auto TOLERANCE             = 1.0e-4F;
+
+  // All the particles are emitted in the first frame, and live through the check.
+  const auto makeSystem = [&](const glm::vec4& maxStartVelocity, const bool enableLod)
+  {
+    auto system  = std::make_unique<ParticleSystem>(numParticles);
+    auto emitter = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(static_cast<float>(static_cast<double>(numParticles) / dt));
+    emitter->AddGenerator(
+        std::make_shared<BoxPositionGenerator>(VIEW_POSITION, START_POSITION_OFFSET));
+    emitter->AddGenerator(
+        std::make_shared<BasicVelocityGenerator>(-maxStartVelocity, maxStartVelocity));
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(LIFETIME, LIFETIME));
+    system->AddEmitter(emitter);
+    system->AddUpdater(std::make_shared<BasicTimeUpdater>());
+    system->AddUpdater(std::make_shared<EulerUpdater>(glm::vec4{0.0F}));
+    if (enableLod)
+    {
+      system->SetLodSettings(LOD_SETTINGS);
+      system->SetLodView(VIEW_POSITION, std::nullopt);
+    }
+    return system;
+  };
+
+  std::cout << "\nlevel of detail, " << numParticles << " particles, " << frameCount
+            << " frames\n";
+  PrintTableHeader(std::cout, {"check", "particles checked", "particles wrong", "max difference"});
+
+  // Standing still, each particle is in the tier its distance says.
+  const auto still = makeSystem(glm::vec4{0.0F}, true);
+  still->Update(dt);
+  const auto& stillData = still->GetFinalData();
+  auto numTiered        = size_t{0U};
+  auto numMisplaced     = size_t{0U};
+  for (auto tier = 0U; tier < LodSettings::NUM_TIERS; ++tier)
+  {
+    const auto minDistance = 0U == tier ? 0.0F : LOD_SETTINGS.tierDistances[tier - 1];
+    const auto maxDistance = (LodSettings::NUM_TIERS - 1) == tier
+                                 ? std::numeric_limits<float>::infinity()
+                                 : LOD_SETTINGS.tierDistances[tier];
+    const auto& tierRange  = still->GetLodTierRange(tier);
+    for (auto i = tierRange.start; i < tierRange.end; ++i)
+    {
+      const auto offset     = glm::vec3{stillData.GetPosition(i) - VIEW_POSITION};
+      const auto distanceSq = glm::dot(offset, offset);
+      const auto isNearer   = (0U != tier) and (distanceSq <= (minDistance * minDistance));
+      if (isNearer or (distanceSq > (maxDistance * maxDistance)))
+      {
+        ++numMisplaced;
+      }
+    }
+    numTiered += tierRange.end - tierRange.start;
+  }
+  numMisplaced += stillData.GetAwakeCount() - numTiered;
+  std::cout << "tier distances | " << stillData.GetAwakeCount() << " | " << numMisplaced
+            << " | 0\n";
+
+  // Moving, each particle is given the time its tiers missed when they catch up.
+  const auto reference = makeSystem(MAX_START_VELOCITY, false);
+  const auto byTier    = makeSystem(MAX_START_VELOCITY, true);
+  auto numWrong        = size_t{0U};
+  auto maxDifference   = 0.0F;
+  for (auto frame = 0U; frame < frameCount; ++frame)
+  {
+    reference->Update(dt);
+    byTier->Update(dt);
+    if (0U != (frame % CATCH_UP_PERIOD))
+    {
+      continue;
+    }
+
+    const auto comparison =
+        PARTICLES::CompareParticles(reference->GetFinalData(), byTier->GetFinalData(), TOLERANCE);
+    numWrong      = std::max(numWrong, comparison.numOutside + comparison.numMissing);
+    maxDifference = std::max(maxDifference, comparison.maxDifference);
+  }
+  std::cout << "catch-up times | " << reference->GetFinalData().GetAliveCount() << " | "
+            << numWrong << " | " << maxDifference << "\n";
+
+  return (0U == numMisplaced) and (0U == numWrong);
+}
+
+// A projectile under gravity, stepped by each integrator, against the closed form. Velocity
+// Verlet is exact for a constant acceleration, from the updaters or its own. Semi-implicit
+// Euler moves by the velocity at the end of each step, so it is off by half the acceleration
+// times the time times the step. Returns whether each is as far off as it should be.
+auto VerifyIntegrators(const double dt) -> bool
+{
+  static constexpr auto NUM_STEPS      = 60U;
+  static constexpr auto GRAVITY        = glm::vec4{0.0F, -9.81F, 0.0F, 0.0F};
+  static constexpr auto START_VELOCITY = glm::vec4{1.0F, 5.0F, 0.0F, 0.0F};
+  static constexpr auto TOLERANCE      = 1.0e-4F;
+
+  const auto time          = static_cast<float>(NUM_STEPS) * static_cast<float>(dt);
+  const auto exactPosition = (time * START_VELOCITY) + (0.5F * time * time * GRAVITY);
+  const auto exactVelocity = START_VELOCITY + (time * GRAVITY);
+
+  std::cout << "\nintegrators, projectile after " << NUM_STEPS << " steps\n";
+  PrintTableHeader(std::cout, {"integrator", "position error", "expected error", "velocity error"});
+
+  auto isVerified = true;
+  const auto verify = [&](const std::string& name,
+                          IIntegratorUpdater& integrator,
+                          const float expectedError)
+  {
+    auto particleData = ParticleData{1U};
+    particleData.Wake(0U);
+    particleData.SetPosition(0U, glm::vec4{0.0F});
+    particleData.SetVelocity(0U, START_VELOCITY);
+    for (auto step = 0U; step < NUM_STEPS; ++step)
+    {
+      particleData.SetAcceleration(0U, glm::vec4{0.0F});
+      integrator.Update(dt, particleData);
+    }
+
+    const auto positionError = glm::distance(exactPosition, particleData.GetPosition(0U));
+    const auto velocityError = glm::distance(exactVelocity, particleData.GetVelocity(0U));
+    std::cout << name << " | " << positionError << " | " << expectedError << " | "
+              << velocityError << "\n";
+    isVerified = (std::abs(positionError - expectedError) <= TOLERANCE) and
+                 (velocityError <= TOLERANCE) and isVerified;
+  };
+
+  auto semiImplicitEuler = SemiImplicitEulerUpdater{GRAVITY};
+  auto velocityVerlet    = VelocityVerletUpdater{GRAVITY};
+  auto gravityOnlyVerlet = VelocityVerletUpdater{GRAVITY};
+  gravityOnlyVerlet.SetForceSource(ForceSource::GLOBAL_ONLY);
+  verify("semi-implicit Euler",
+         semiImplicitEuler,
+         0.5F * glm::length(GRAVITY) * time * static_cast<float>(dt));
+  verify("velocity Verlet", velocityVerlet, 0.0F);
+  verify("velocity Verlet, gravity only", gravityOnlyVerlet, 0.0F);
+
+  return isVerified;
+}
+
+// The positions extrapolated to each frame's time, with the simulation run at a third of the
+// frame rate, and with LOD tiers updated every few frames. The particles move at constant
+// velocities, so the extrapolated positions must be where the particles are at that time.
+// Returns whether they all are, whether some frames had particles behind to extrapolate, and
+// whether a short buffer is filled and no more.
+auto VerifyExtrapolation(const size_t numParticles, const uint32_t frameCount, const double dt)
+    -> bool
+{
+  static constexpr auto STEP_FRAME_COUNT   = 3U;
+  static constexpr auto MAX_NUM_STEPS      = 4U;
+  static constexpr auto VIEW_POSITION      = glm::vec4{0.0F, 0.0F, 0.0F, 1.0F};
+  static constexpr auto LOD_SETTINGS       = LodSettings{
+            .tierDistances = {0.6F, 1.2F},
+            .updatePeriods = {1U, 2U, 3U},
+  };
+  static constexpr auto MAX_START_VELOCITY = glm::vec4{0.5F, 0.5F, 0.5F, 0.0F};
+  static constexpr auto LIFETIME           = 100.0F;
+  static constexpr auto TOLERANCE          = 1.0e-4F;
+
+  std::cout << "\nextrapolated positions, " << numParticles << " particles, " << frameCount
+            << " frames\n";
+  PrintTableHeader(std::cout,
+                   {"simulation",
+                    "frames behind",
+                    "particles wrong",
+                    "max error",
+                    "written to half buffer"});
+
+  auto isVerified = true;
+  const auto verify = [&](const std::string& name, const bool enableLod)
+  {
+    // All the particles are emitted in the first step, and live through the check.
+    const auto stepDt = enableLod ? dt : (static_cast<double>(STEP_FRAME_COUNT) * dt);
+    auto system       = ParticleSystem{numParticles};
+    auto emitter      = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(static_cast<float>(static_cast<double>(numParticles) / stepDt));
+    emitter->AddGenerator(
+        std::make_shared<BoxPositionGenerator>(VIEW_POSITION, glm::vec4{1.0F, 1.0F, 1.0F, 0.0F}));
+    emitter->AddGenerator(
+        std::make_shared<BasicVelocityGenerator>(-MAX_START_VELOCITY, MAX_START_VELOCITY));
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(LIFETIME, LIFETIME));
+    system.AddEmitter(emitter);
+    system.AddUpdater(std::make_shared<BasicTimeUpdater>());
+    system.AddUpdater(std::make_shared<EulerUpdater>(glm::vec4{0.0F}));
+    if (enableLod)
+    {
+      system.SetLodSettings(LOD_SETTINGS);
+      system.SetLodView(VIEW_POSITION, std::nullopt);
+    }
+    else
+    {
+      system.SetFixedTimeStep(stepDt, MAX_NUM_STEPS);
+    }
+
+    // The particles are followed by id, as LOD moves them about the streams.
+    auto startPositions  = std::vector<glm::vec4>{};
+    auto startVelocities = std::vector<glm::vec4>{};
+    auto startTime       = 0.0;
+    auto positions       = std::vector<glm::vec4>(numParticles);
+    auto renderTime      = 0.0;
+    auto numBehind       = 0U; // frames with particles behind the frame time
+    auto numWrong        = size_t{0U};
+    auto maxError        = 0.0F;
+    for (auto frame = 0U; frame < frameCount; ++frame)
+    {
+      system.Update(dt);
+      renderTime += dt;
+
+      const auto& particleData = system.GetFinalData();
+      const auto numAlive      = particleData.GetAliveCount();
+      const auto ids           = particleData.GetIds();
+      if (startPositions.empty())
+      {
+        startPositions.resize(numAlive);
+        startVelocities.resize(numAlive);
+        for (auto i = size_t{0U}; i < numAlive; ++i)
+        {
+          startPositions.at(ids[i])  = particleData.GetPosition(i);
+          startVelocities.at(ids[i]) = particleData.GetVelocity(i);
+        }
+        startTime = system.GetSimulationTime();
+      }
+
+      const auto numWritten = system.WriteExtrapolatedPositions(renderTime, std::span{positions});
+      numWrong += startPositions.size() - std::min(startPositions.size(), numWritten);
+      const auto time = static_cast<float>(renderTime - startTime);
+      auto isBehind   = false;
+      for (auto i = size_t{0U}; i < std::min(startPositions.size(), numWritten); ++i)
+      {
+        const auto exact = startPositions.at(ids[i]) + (time * startVelocities.at(ids[i]));
+        const auto error = glm::distance(exact, positions[i]);
+        numWrong += error > TOLERANCE ? 1U : 0U;
+        maxError = std::max(maxError, error);
+        isBehind = isBehind or (glm::distance(exact, particleData.GetPosition(i)) > TOLERANCE);
+      }
+      numBehind += isBehind ? 1U : 0U;
+    }
+
+    const auto halfSize   = startPositions.size() / 2U;
+    const auto numWritten = system.WriteExtrapolatedPositions(
+        renderTime, std::span{positions}.first(halfSize));
+
+    std::cout << name << " | " << numBehind << " | " << numWrong << " | " << maxError << " | "
+              << numWritten << "\n";
+    isVerified = (not startPositions.empty()) and (numBehind > 0U) and (0U == numWrong) and
+                 (halfSize == numWritten) and isVerified;
+  };
+
+  verify("a third of the frame rate", false);
+  verify("LOD tiers", true);
+
+  return isVerified;
+}
+
+// An emitter run for a second in steps too short for a whole particle each, with and without
+// fixed time steps. Returns whether each emits the rate, give or take one for rounding.
+auto VerifyEmissionRate(const double dt) -> bool
+{
+  static constexpr auto EMIT_RATE     = 114.0F; // 1.9 particles a 60th of a second
+  static constexpr auto MAX_NUM_STEPS = 8U;
+  static constexpr auto NUM_SUBSTEPS  = 4U;
+  static constexpr auto LIFETIME      = 100.0F;
+
+  std::cout << "\nemission over a second, " << EMIT_RATE << " particles a second\n";
+  PrintTableHeader(std::cout, {"steps", "step time", "emitted"});
+
+  auto isVerified = true;
+  const auto verify = [&](const std::string& name, const double stepDt, const bool fixedTimeStep)
+  {
+    auto system  = ParticleSystem{static_cast<size_t>(2.0F * EMIT_RATE)};
+    auto emitter = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(EMIT_RATE);
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(LIFETIME, LIFETIME));
+    system.AddEmitter(emitter);
+    system.AddUpdater(std::make_shared<BasicTimeUpdater>());
+    if (fixedTimeStep)
+    {
+      system.SetFixedTimeStep(stepDt, MAX_NUM_STEPS);
+    }
+
+    // With fixed time steps, the system splits the frames into the steps itself.
+    const auto updateDt   = fixedTimeStep ? dt : stepDt;
+    const auto numUpdates = std::lround(1.0 / updateDt);
+    for (auto update = 0L; update < numUpdates; ++update)
+    {
+      system.Update(updateDt);
+    }
+
+    const auto numEmitted = system.GetNumAliveParticles();
+    std::cout << name << " | " << stepDt << " | " << numEmitted << "\n";
+    isVerified = (std::abs(static_cast<float>(numEmitted) - EMIT_RATE) <= 1.0F) and isVerified;
+  };
+
+  verify("frame", dt, false);
+  verify("fixed", dt / NUM_SUBSTEPS, true);
+  verify("substep", dt / NUM_SUBSTEPS, false);
+
+  return isVerified;
+}
+
+// One time update of particles of which every third is due to die, so most kills move a
+// particle not yet updated into the dead one's place. Returns whether the due ones are all gone
+// and every one left was aged by exactly 'dt', once.
+auto VerifyTimeUpdates(const size_t numParticles, const double dt) -> bool
+{
+  static constexpr auto LIFETIME    = 1.0F;
+  static constexpr auto DYING_EVERY = 3U;
+
+  const auto localDt = static_cast<float>(dt);
+  auto particleData  = ParticleData{numParticles};
+  auto timesLeft     = std::vector<float>(numParticles); // by id
+  auto numDying      = size_t{0U};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    particleData.Wake(i);
+    const auto isDying  = 0U == (i % DYING_EVERY);
+    const auto timeLeft = isDying ? (0.5F * localDt) : LIFETIME;
+    particleData.SetTime(i, {timeLeft, 0.0F, 0.0F, 1.0F / LIFETIME});
+    timesLeft[particleData.GetIds()[i]] = timeLeft;
+    numDying += isDying ? 1U : 0U;
+  }
+
+  auto timeUpdater = BasicTimeUpdater{};
+  timeUpdater.Update(dt, particleData);
+
+  const auto numAlive = particleData.GetAliveCount();
+  const auto ids      = particleData.GetIds();
+  auto numWrong       = 0U;
+  for (auto i = size_t{0U}; i < numAlive; ++i)
+  {
+    numWrong += (particleData.GetTime(i).x != (timesLeft[ids[i]] - localDt)) ? 1U : 0U;
+  }
+
+  std::cout << "\nverify time updates, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout, {"due to die", "killed", "aged wrongly"});
+  std::cout << numDying << " | " << (numParticles - numAlive) << " | " << numWrong << "\n";
+
+  return ((numParticles - numAlive) == numDying) and (0U == numWrong);
+}
+
+// The vector field updater on fields it samples exactly: a constant field, and a linear one,
+// which trilinear interpolation reproduces. Some particles start outside the grid, where the
+// field is its value at the nearest boundary. Returns whether the accelerations match the
+// closed form in both modes.
+auto VerifyVectorField(const size_t numParticles) -> bool
+{
+  static constexpr auto BOUNDS_MIN     = glm::vec4{-1.0F, -1.0F, -1.0F, 0.0F};
+  static constexpr auto BOUNDS_MAX     = glm::vec4{+1.0F, +1.0F, +1.0F, 0.0F};
+  static constexpr auto RESOLUTION     = 9U;
+  static constexpr auto STRENGTH       = 2.0F;
+  static constexpr auto DT             = 1.0 / 60.0;
+  static constexpr auto CONSTANT_VALUE = glm::vec4{0.5F, -1.0F, 0.25F, 0.0F};
+  static constexpr auto MIN_POSITION   = glm::vec4{-1.5F, -1.5F, -1.5F, 1.0F};
+  static constexpr auto MAX_POSITION   = glm::vec4{+1.5F, +1.5F, +1.5F, 1.0F};
+  static constexpr auto MAX_VELOCITY   = glm::vec4{1.0F, 1.0F, 1.0F, 0.0F};
+  static constexpr auto TOLERANCE      = 1.0e-5F;
+
+  const auto constantField = [](const glm::vec4&) { return CONSTANT_VALUE; };
+  const auto linearField   = [](const glm::vec4& position)
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+    return glm::vec4{position.y, 2.0F * position.z, 0.5F - position.x, 0.0F};
+  };
+
+  auto random       = PARTICLES::Random{};
+  auto particleData = ParticleData{numParticles};
+  for (auto i = 0U; i < numParticles; ++i)
+  {
+    particleData.Wake(i);
+    particleData.SetPosition(i, random.Uniform(MIN_POSITION, MAX_POSITION));
+    particleData.SetVelocity(i, random.Uniform(-MAX_VELOCITY, MAX_VELOCITY));
+  }
+
+  std::cout << "\nvector field, " << numParticles << " particles\n";
+  PrintTableHeader(std::cout, {"field", "mode", "particles wrong", "max error"});
+
+  auto isVerified = true;
+  const auto verify = [&](const std::string& name,
+                          const auto& fieldFunc,
+                          const VectorFieldMode mode)
+  {
+    auto field = std::make_shared<VectorGrid>(BOUNDS_MIN, BOUNDS_MAX, RESOLUTION);
+    for (auto z = 0U; z < RESOLUTION; ++z)
+    {
+      for (auto y = 0U; y < RESOLUTION; ++y)
+      {
+        for (auto x = 0U; x < RESOLUTION; ++x)
+        {
+          field->SetValue(x, y, z, fieldFunc(field->GetPointPosition(x, y, z)));
+        }
+      }
+    }
+
+    for (auto i = 0U; i < numParticles; ++i)
+    {
+      particleData.SetAcceleration(i, glm::vec4{0.0F});
+    }
+    auto updater = VectorFieldUpdater{field, mode, STRENGTH};
+    updater.Update(DT, particleData);
+
+    auto numWrong = 0U;
+    auto maxError = 0.0F;
+    for (auto i = 0U; i < numParticles; ++i)
+    {
+      const auto clamped = glm::clamp(particleData.GetPosition(i), BOUNDS_MIN, BOUNDS_MAX);
+      auto exact         = fieldFunc(clamped);
+      if (VectorFieldMode::FLOW == mode)
+      {
+        exact -= particleData.GetVelocity(i);
+      }
+      const auto error = glm::distance(STRENGTH * exact, particleData.GetAcceleration(i));
+      numWrong += error > TOLERANCE ? 1U : 0U;
+      maxError = std::max(maxError, error);
+    }
+
+    std::cout << name << " | " << (VectorFieldMode::FORCE == mode ? "force" : "flow") << " | "
+              << numWrong << " | " << maxError << "\n";
+    isVerified = (0U == numWrong) and isVerified;
+  };
+
+  verify("constant", constantField, VectorFieldMode::FORCE);
+  verify("constant", constantField, VectorFieldMode::FLOW);
+  verify("linear", linearField, VectorFieldMode::FORCE);
+  verify("linear", linearField, VectorFieldMode::FLOW);
+
+  return isVerified;
+}
+
+// The collider set's inside tests and contact depths, with its tables and grid, against working
+// out the distance to every shape from its definition. Points within a rounding error of a
+// surface could go either way, so they are not counted. Returns whether they all agree.
+auto VerifyColliders(const size_t numPoints) -> bool
+{
+  static constexpr auto RANDOM_SEED  = 1U;
+  static constexpr auto MAX_POSITION = glm::vec4{1.2F, 1.2F, 1.2F, 1.0F};
+  static constexpr auto TOLERANCE    = 1.0e-5F;
+
+  std::cout << "\ncolliders, " << numPoints << " points\n";
+  PrintTableHeader(std::cout,
+                   {"colliders", "points inside", "inside tests wrong", "max depth error"});
+
+  std::srand(RANDOM_SEED);
+  auto isVerified = true;
+  for (const auto numColliders : NUMS_COLLIDERS)
+  {
+    const auto shapes    = MakeColliderShapes(numColliders);
+    const auto colliders = MakeColliderSet(shapes);
+
+    auto positions = std::vector<glm::vec4>(numPoints);
+    for (auto& position : positions)
+    {
+      position   = glm::linearRand(-MAX_POSITION, MAX_POSITION);
+      position.w = 1.0F; // NOLINT(cppcoreguidelines-pro-type-union-access)
+    }
+    auto insideIds = std::vector<size_t>{};
+    colliders->FindInside(positions, 0U, insideIds);
+
+    auto isInside = std::vector<bool>(numPoints, false);
+    for (const auto id : insideIds)
+    {
+      isInside[id] = true;
+    }
+
+    auto numWrong      = 0U;
+    auto maxDepthError = 0.0F;
+    for (auto id = size_t{0U}; id < numPoints; ++id)
+    {
+      const auto distance = GetColliderDistance(shapes, positions[id]);
+      if (std::abs(distance) <= TOLERANCE)
+      {
+        continue;
+      }
+      if ((distance < 0.0F) != isInside[id])
+      {
+        ++numWrong;
+        continue;
+      }
+      if (isInside[id])
+      {
+        const auto depthError = std::abs(colliders->GetContact(positions[id]).distance - distance);
+        numWrong += depthError > TOLERANCE ? 1U : 0U;
+        maxDepthError = std::max(maxDepthError, depthError);
+      }
+    }
+
+    std::cout << numColliders << " | " << insideIds.size() << " | " << numWrong << " | "
+              << maxDepthError << "\n";
+    isVerified = (0U == numWrong) and isVerified;
+  }
+
+  return isVerified;
+}
+
+// The adaptive depth sort with its work shared out between threads, on a fountain seen from a
+// still view, where it mostly keeps last frame's order. Returns whether every frame's order is
+// back to front, and whether some frames were sorted without falling back to the radix sort.
+auto VerifyDepthSorting(const size_t numParticles, const uint32_t frameCount, const double dt)
+    -> bool
+{
+  static constexpr auto RANDOM_SEED     = 1U;
+  static constexpr auto NUM_THREADS     = 4U;
+  static constexpr auto NUM_SORT_FRAMES = 30U;
+  static constexpr auto VIEW_POSITION   = glm::vec4{0.0F, 0.0F, 3.0F, 1.0F};
+  static constexpr auto VIEW_DIRECTION  = glm::vec4{0.0F, 0.0F, -1.0F, 0.0F};
+
+  std::srand(RANDOM_SEED);
+  const auto effect = EffectFactory::create("fountain", numParticles);
+  for (auto frame = 0U; frame < frameCount; ++frame)
+  {
+    effect->Update(dt);
+  }
+
+  auto sorter = DepthSorter{};
+  sorter.SetParallel(std::make_shared<Parallel>(NUM_THREADS));
+
+  auto numUnsortedFrames = 0U;
+  auto numAdaptiveFrames = 0U;
+  for (auto frame = 0U; frame < NUM_SORT_FRAMES; ++frame)
+  {
+    effect->Update(dt);
+    const auto& particleData = effect->GetSystem().GetFinalData();
+    const auto numAlive      = particleData.GetAliveCount();
+
+    const auto order         = sorter.Sort(particleData, VIEW_POSITION, VIEW_DIRECTION);
+    const auto isBackToFront = [&particleData](const uint32_t lhs, const uint32_t rhs)
+    {
+      return glm::dot(particleData.GetPosition(lhs) - VIEW_POSITION, VIEW_DIRECTION) >
+             glm::dot(particleData.GetPosition(rhs) - VIEW_POSITION, VIEW_DIRECTION);
+    };
+    if ((order.size() != numAlive) or (not std::ranges::is_sorted(order, isBackToFront)))
+    {
+      ++numUnsortedFrames;
+    }
+    if (sorter.GetNumSortedLast() < numAlive)
+    {
+      ++numAdaptiveFrames;
+    }
+  }
+
+  std::cout << "\nverify adaptive depth sorting, " << numParticles << " particles, "
+            << NUM_THREADS << " threads\n";
+  PrintTableHeader(std::cout, {"frames", "frames not sorted", "frames sorted adaptively"});
+  std::cout << NUM_SORT_FRAMES << " | " << numUnsortedFrames << " | " << numAdaptiveFrames
+            << "\n";
+
+  return (0U == numUnsortedFrames) and (numAdaptiveFrames > 0U);
+}
+
+// How far apart two samples' distributions are, as the largest gap between their cumulative
+// distributions. Sorts both.
+[[nodiscard]] auto GetKolmogorovSmirnovDistance(std::vector<float>& lhs, std::vector<float>& rhs)
+    -> double
+{
+  std::ranges::sort(lhs);
+  std::ranges::sort(rhs);
+
+  auto maxDistance = 0.0;
+  auto i           = size_t{0U};
+  auto j           = size_t{0U};
+  while ((i < lhs.size()) and (j < rhs.size()))
+  {
+    const auto value = std::min(lhs[i], rhs[j]);
+    for (; (i < lhs.size()) and (lhs[i] <= value); ++i)
+    {
+    }
+    for (; (j < rhs.size()) and (rhs[j] <= value); ++j)
+    {
+    }
+    maxDistance = std::max(maxDistance,
+                           std::abs((static_cast<double>(i) / static_cast<double>(lhs.size())) -
+                                    (static_cast<double>(j) / static_cast<double>(rhs.size()))));
+  }
+  return maxDistance;
+}
+
+// A fountain run at frame rate against fast-forwarded with 'ParticleSystem::Prewarm', in the
+// air and bouncing on a floor. Samples of the particles' ages, heights and speeds are compared
+// with the two sample Kolmogorov-Smirnov test. Returns whether every distance is below the
+// critical one, where the samples can't be told apart at the 1% level. Only the default step
+// is held to that, longer ones trade accuracy for time.
+auto VerifyPrewarm(const size_t numParticles, const double warmUpTime, const double dt) -> bool
+{
+  static constexpr auto GRAVITY            = glm::vec4{0.0F, -9.81F, 0.0F, 0.0F};
+  static constexpr auto FLOOR_Y            = -1.0F;
+  static constexpr auto BOUNCE_FACTOR      = 0.5F;
+  static constexpr auto MIN_LIFETIME       = 1.0F;
+  static constexpr auto MAX_LIFETIME       = 4.0F;
+  static constexpr auto MIN_START_VELOCITY = glm::vec4{-0.5F, 4.0F, -0.5F, 0.0F};
+  static constexpr auto MAX_START_VELOCITY = glm::vec4{+0.5F, 6.0F, +0.5F, 0.0F};
+  static constexpr auto NUM_SAMPLES        = 10000U;
+  static constexpr auto KS_COEFFICIENT     = 1.628; // for the 1% level
+
+  const auto parallel = std::make_shared<Parallel>(0U);
+
+  const auto makeFountain = [&](const bool hasFloor)
+  {
+    auto system  = std::make_unique<ParticleSystem>(numParticles);
+    auto emitter = std::make_shared<ParticleEmitter>();
+    emitter->SetEmitRate(static_cast<float>(numParticles) / MAX_LIFETIME);
+    emitter->AddGenerator(std::make_shared<BoxPositionGenerator>(
+        glm::vec4{0.0F, FLOOR_Y, 0.0F, 0.0F}, glm::vec4{0.0F}));
+    emitter->AddGenerator(
+        std::make_shared<BasicVelocityGenerator>(MIN_START_VELOCITY, MAX_START_VELOCITY));
+    emitter->AddGenerator(std::make_shared<BasicTimeGenerator>(MIN_LIFETIME, MAX_LIFETIME));
+    system->AddEmitter(emitter);
+    system->AddUpdater(std::make_shared<BasicTimeUpdater>());
+    system->AddUpdater(MakeGravityOnlyVerlet(GRAVITY));
+    if (hasFloor)
+    {
+      system->AddUpdater(std::make_shared<FloorUpdater>(FLOOR_Y, BOUNCE_FACTOR));
+    }
+    system->SetParallel(parallel);
+    return system;
+  };
+
+  struct Samples
+  {
+    std::vector<float> ages;
+    std::vector<float> heights;
+    std::vector<float> speeds;
+  };
+  const auto sample = [](const ParticleData& particleData)
+  {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+    auto samples        = Samples{};
+    const auto numAlive = particleData.GetAliveCount();
+    const auto stride   = std::max(size_t{1U}, numAlive / NUM_SAMPLES);
+    for (auto i = size_t{0U}; i < numAlive; i += stride)
+    {
+      const auto& time = particleData.GetTime(i);
+      samples.ages.push_back((1.0F / time.w) - time.x);
+      samples.heights.push_back(particleData.GetPosition(i).y);
+      samples.speeds.push_back(glm::length(glm::vec3{particleData.GetVelocity(i)}));
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+    return samples;
+  };
+
+  const auto timeMs = [](const auto& function)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto diff = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(diff).count();
+  };
+
+  std::cout << "\nverify fast-forward pre-warm, " << numParticles << " particles, " << warmUpTime
+            << " s\n";
+  PrintTableHeader(std::cout,
+                   {"fountain",
+                    "warm up",
+                    "time",
+                    "alive",
+                    "KS age",
+                    "KS height",
+                    "KS speed",
+                    "critical"});
+
+  auto isVerified = true;
+  for (const auto hasFloor : {false, true})
+  {
+    const auto* const name = hasFloor ? "on a floor" : "in the air";
+    const auto numFrames   = static_cast<uint32_t>(std::round(warmUpTime / dt));
+
+    const auto reference     = makeFountain(hasFloor);
+    const auto referenceTime = timeMs(
+        [&]()
+        {
+          for (auto frame = 0U; frame < numFrames; ++frame)
+          {
+            reference->Update(dt);
+          }
+        });
+    auto referenceSamples = sample(reference->GetFinalData());
+    std::cout << name << " | frame rate | " << referenceTime << " | "
+              << reference->GetNumAliveParticles() << " | - | - | - | -\n";
+
+    const auto prewarmed = makeFountain(hasFloor);
+    const auto time      = timeMs([&]() { prewarmed->Prewarm(warmUpTime); });
+    auto samples         = sample(prewarmed->GetFinalData());
+
+    const auto numSamples          = static_cast<double>(samples.ages.size());
+    const auto numReferenceSamples = static_cast<double>(referenceSamples.ages.size());
+    const auto critical =
+        KS_COEFFICIENT *
+        std::sqrt((numSamples + numReferenceSamples) / (numSamples * numReferenceSamples));
+
+    const auto ageDistance = GetKolmogorovSmirnovDistance(referenceSamples.ages, samples.ages);
+    const auto heightDistance =
+        GetKolmogorovSmirnovDistance(referenceSamples.heights, samples.heights);
+    const auto speedDistance =
+        GetKolmogorovSmirnovDistance(referenceSamples.speeds, samples.speeds);
+    std::cout << name << " | pre-warm | " << time << " | " << prewarmed->GetNumAliveParticles()
+              << " | " << ageDistance << " | " << heightDistance << " | " << speedDistance
+              << " | " << critical << "\n";
+    isVerified =
+        (std::max({ageDistance, heightDistance, speedDistance}) <= critical) and isVerified;
+  }
+
+  return isVerified;
+}
+
+// Plays a trace from 'TracedEffect' on a new effect, for reproducing slow frames.
+auto ReplayTrace(const char* const filename) -> int
+{
+  try
+  {
+    auto player       = EffectTracePlayer{filename};
+    const auto& info  = player.GetInfo();
+    const auto effect = EffectFactory::create(info.effectName.c_str(), info.numParticles);
+
+    const auto frameTimes = PlayTimedFrames(player, *effect);
+    const auto total      = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+    const auto slowest    = std::ranges::max_element(frameTimes);
+
+    std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    std::cout.precision(3);
+    std::cout << info.effectName << ", " << info.numParticles << " particles, seed "
+              << info.randomSeed << ", " << player.GetNumCalls() << " calls, "
+              << frameTimes.size() << " frames\n";
+    if (not frameTimes.empty())
+    {
+      std::cout << "total " << total << " ms, mean "
+                << (total / static_cast<double>(frameTimes.size())) << " ms, slowest "
+                << *slowest << " ms at frame " << (slowest - frameTimes.begin()) << "\n";
+    }
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cerr << error.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// The scene benchmark, 'cpuTest --bench': whole effects updated frame by frame, timing each
+// frame on its own, for tracking the effects' speed from build to build.
+struct SceneBenchSettings
+{
+  std::vector<std::string> effectNames;
+  std::vector<size_t> particleCounts;
+  // One is single threaded, and zero is a thread per hardware thread.
+  std::vector<uint32_t> threadCounts;
+  uint32_t frameCount;
+  // Untimed frames first, so the effects are timed once their particle counts have levelled
+  // out and the caches and allocations are warm.
+  uint32_t warmUpFrameCount;
+  double dt;
+  uint64_t randomSeed;
+  // The process, and so every thread it starts, is kept on these. None means any.
+  std::vector<uint32_t> cpus;
+};
+
+struct FrameTimeStats // milliseconds
+{
+  double mean;
+  double min;
+  double median;
+  double p95;
+  double p99;
+  double max;
+};
+
+struct SceneBenchResult
+{
+  std::string effectName;
+  size_t numParticles;
+  uint32_t numThreads;
+  size_t numAliveParticles; // after the last frame
+  FrameTimeStats frameTimes;
+};
+
+[[nodiscard]] auto GetFrameTimeStats(std::vector<double> frameTimes) -> FrameTimeStats
+{
+  static constexpr auto MEDIAN = 0.50;
+  static constexpr auto P95    = 0.95;
+  static constexpr auto P99    = 0.99;
+
+  std::ranges::sort(frameTimes);
+  const auto total = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+  return {.mean   = total / static_cast<double>(frameTimes.size()),
+          .min    = frameTimes.front(),
+          .median = GetPercentile(frameTimes, MEDIAN),
+          .p95    = GetPercentile(frameTimes, P95),
+          .p99    = GetPercentile(frameTimes, P99),
+          .max    = frameTimes.back()};
+}
+
+// Keeps the process on 'cpus', unless there are none. Threads started later inherit it.
+// Returns false if a CPU isn't there, or where it isn't supported.
+[[nodiscard]] auto PinToCpus(const std::vector<uint32_t>& cpus) -> bool
+{
+  if (cpus.empty())
+  {
+    return true;
+  }
+#ifdef __linux__
+  auto cpuSet = cpu_set_t{};
+  CPU_ZERO(&cpuSet);
+  for (const auto cpu : cpus)
+  {
+    if (cpu >= CPU_SETSIZE)
+    {
+      return false;
+    }
+    CPU_SET(cpu, &cpuSet);
+  }
+  return 0 == ::sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+#else
+  return false;
+#endif
+}
+
+[[nodiscard]] auto RunSceneBench(const SceneBenchSettings& settings)
+    -> std::vector<SceneBenchResult>
+{
+  auto results = std::vector<SceneBenchResult>{};
+  for (const auto numThreads : settings.threadCounts)
+  {
+    const auto parallel =
+        (1U == numThreads) ? std::shared_ptr<Parallel>{} : std::make_shared<Parallel>(numThreads);
+
+    for (const auto numParticles : settings.particleCounts)
+    {
+      for (const auto& name : settings.effectNames)
+      {
+        const auto effect = EffectFactory::create(name.c_str(), numParticles);
+        effect->SetRandomSeed(settings.randomSeed);
+        effect->SetParallel(parallel);
+
+        for (auto frame = 0U; frame < settings.warmUpFrameCount; ++frame)
+        {
+          effect->Update(settings.dt);
+        }
+
+        auto frameTimes = std::vector<double>(settings.frameCount);
+        for (auto& frameTime : frameTimes)
+        {
+          const auto start = std::chrono::steady_clock::now();
+          effect->Update(settings.dt);
+          const auto diff = std::chrono::steady_clock::now() - start;
+          frameTime       = std::chrono::duration<double, std::milli>(diff).count();
+        }
+
+        results.push_back({.effectName        = name,
+                           .numParticles      = numParticles,
+                           .numThreads        = (nullptr == parallel) ? 1U
+                                                                      : parallel->GetNumThreads(),
+                           .numAliveParticles = effect->GetNumAliveParticles(),
+                           .frameTimes        = GetFrameTimeStats(frameTimes)});
+      }
+    }
+  }
+  return results;
+}
+
+auto WriteSceneBenchTable(std::ostream& out, const std::vector<SceneBenchResult>& results)
+    -> void
+{
+  PrintTableHeader(
+      out,
+      {"effect", "particles", "threads", "alive", "mean", "min", "median", "p95", "p99", "max"});
+  for (const auto& result : results)
+  {
+    const auto& times = result.frameTimes;
+    out << result.effectName << " | " << result.numParticles << " | " << result.numThreads
+        << " | " << result.numAliveParticles << " | " << times.mean << " | " << times.min
+        << " | " << times.median << " | " << times.p95 << " | " << times.p99 << " | "
+        << times.max << "\n";
+  }
+  out << "frame times in milliseconds\n";
+}
+
+auto WriteSceneBenchCsv(std::ostream& out, const std::vector<SceneBenchResult>& results) -> void
+{
+  out << "effect,particles,threads,alive,mean_ms,min_ms,median_ms,p95_ms,p99_ms,max_ms\n";
+  for (const auto& result : results)
+  {
+    const auto& times = result.frameTimes;
+    out << result.effectName << "," << result.numParticles << "," << result.numThreads << ","
+        << result.numAliveParticles << "," << times.mean << "," << times.min << ","
+        << times.median << "," << times.p95 << "," << times.p99 << "," << times.max << "\n";
+  }
+}
+
+// The effect names are the factory's, so need no escaping.
+auto WriteSceneBenchJson(std::ostream& out,
+                         const SceneBenchSettings& settings,
+                         const std::vector<SceneBenchResult>& results) -> void
+{
+  out << "{\n";
+  out << "  \"frameCount\": " << settings.frameCount << ",\n";
+  out << "  \"warmUpFrameCount\": " << settings.warmUpFrameCount << ",\n";
+  out << "  \"dt\": " << settings.dt << ",\n";
+  out << "  \"randomSeed\": " << settings.randomSeed << ",\n";
+  out << "  \"cpus\": [";
+  for (auto i = size_t{0U}; i < settings.cpus.size(); ++i)
+  {
+    out << ((0U == i) ? "" : ", ") << settings.cpus[i];
+  }
+  out << "],\n";
+  out << "  \"results\": [\n";
+  for (auto i = size_t{0U}; i < results.size(); ++i)
+  {
+    const auto& result = results[i];
+    const auto& times  = result.frameTimes;
+    out << "    {\"effect\": \"" << result.effectName << "\", \"particles\": "
+        << result.numParticles << ", \"threads\": " << result.numThreads
+        << ", \"alive\": " << result.numAliveParticles << ",\n";
+    out << "     \"frameTimesMs\": {\"mean\": " << times.mean << ", \"min\": " << times.min
+        << ", \"median\": " << times.median << ", \"p95\": " << times.p95
+        << ", \"p99\": " << times.p99 << ", \"max\": " << times.max << "}}"
+        << (((i + 1U) == results.size()) ? "" : ",") << "\n";
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+enum class SceneBenchFormat : uint8_t
+{
+  TABLE,
+  CSV,
+  JSON,
+};
+
+struct SceneBenchCommand
+{
+  SceneBenchSettings settings;
+  SceneBenchFormat format = SceneBenchFormat::TABLE;
+  std::string outputFilename; // empty for the standard output
+};
+
+auto PrintSceneBenchUsage(std::ostream& out) -> void
+{
+  out << "usage: cpuTest --bench [--effects <name,...>] [--counts <particles,...>]\n"
+         "                       [--threads <threads,...>] [--frames <frames>]\n"
+         "                       [--warm-up <frames>] [--seed <seed>] [--pin <cpu,...>]\n"
+         "                       [--format table|csv|json] [--output <file>]\n"
+         "  One thread is single threaded, and zero is a thread per hardware thread.\n";
+}
+
+// A whole number no bigger than 'maxValue', and nothing else. Throws 'std::invalid_argument'.
+[[nodiscard]] auto ParseNumber(const std::string_view text, const uint64_t maxValue) -> uint64_t
+{
+  auto value        = uint64_t{0U};
+  const auto* end   = text.data() + text.size();
+  const auto result = std::from_chars(text.data(), end, value);
+  if ((result.ec != std::errc{}) or (result.ptr != end) or (value > maxValue))
+  {
+    throw std::invalid_argument{"Not a number from 0 to " + std::to_string(maxValue) + ": '" +
+                                std::string{text} + "'."};
+  }
+  return value;
+}
+
+[[nodiscard]] auto SplitList(const std::string_view list) -> std::vector<std::string>
+{
+  auto items = std::vector<std::string>{};
+  for (const auto item : std::views::split(list, ','))
+  {
+    items.emplace_back(item.begin(), item.end());
+  }
+  return items;
+}
+
+template<typename Number>
+[[nodiscard]] auto ParseNumbers(const std::string_view list) -> std::vector<Number>
+{
+  auto numbers = std::vector<Number>{};
+  for (const auto& item : SplitList(list))
+  {
+    numbers.push_back(static_cast<Number>(ParseNumber(item, std::numeric_limits<Number>::max())));
+  }
+  return numbers;
+}
+
+// The options after '--bench', over 'defaults'. Throws 'std::invalid_argument'.
+[[nodiscard]] auto ParseSceneBenchCommand(const std::span<const char* const> options,
+                                          const SceneBenchSettings& defaults)
+    -> SceneBenchCommand
+{
+  auto command   = SceneBenchCommand{
+      .settings = defaults, .format = SceneBenchFormat::TABLE, .outputFilename = ""};
+  auto& settings = command.settings;
+
+  for (auto i = size_t{0U}; i < options.size(); i += 2U)
+  {
+    const auto option = std::string_view{options[i]};
+    if ((i + 1U) == options.size())
+    {
+      throw std::invalid_argument{"No value for '" + std::string{option} + "'."};
+    }
+    const auto value = std::string_view{options[i + 1U]};
+
+    if ("--effects" == option)
+    {
+      settings.effectNames = SplitList(value);
+      for (const auto& name : settings.effectNames)
+      {
+        if (std::ranges::find(defaults.effectNames, name) == defaults.effectNames.end())
+        {
+          throw std::invalid_argument{"No effect '" + name + "'."};
+        }
+      }
+    }
+    else if ("--counts" == option)
+    {
+      settings.particleCounts = ParseNumbers<size_t>(value);
+    }
+    else if ("--threads" == option)
+    {
+      settings.threadCounts = ParseNumbers<uint32_t>(value);
+    }
+    else if ("--frames" == option)
+    {
+      settings.frameCount =
+          static_cast<uint32_t>(ParseNumber(value, std::numeric_limits<uint32_t>::max()));
+    }
+    else if ("--warm-up" == option)
+    {
+      settings.warmUpFrameCount =
+          static_cast<uint32_t>(ParseNumber(value, std::numeric_limits<uint32_t>::max()));
+    }
+    else if ("--seed" == option)
+    {
+      settings.randomSeed = ParseNumber(value, std::numeric_limits<uint64_t>::max());
+    }
+    else if ("--pin" == option)
+    {
+      settings.cpus = ParseNumbers<uint32_t>(value);
+    }
+    else if ("--format" == option)
+    {
+      if ("table" == value)
+      {
+        command.format = SceneBenchFormat::TABLE;
+      }
+      else if ("csv" == value)
+      {
+        command.format = SceneBenchFormat::CSV;
+      }
+      else if ("json" == value)
+      {
+        command.format = SceneBenchFormat::JSON;
+      }
+      else
+      {
+        throw std::invalid_argument{"No format '" + std::string{value} + "'."};
+      }
+    }
+    else if ("--output" == option)
+    {
+      command.outputFilename = value;
+    }
+    else
+    {
+      throw std::invalid_argument{"Unknown option '" + std::string{option} + "'."};
+    }
+  }
+
+  if (0U == settings.frameCount)
+  {
+    throw std::invalid_argument{"No frames to time."};
+  }
+  if (settings.effectNames.empty())
+  {
+    throw std::invalid_argument{"No effects to time."};
+  }
+  if (settings.particleCounts.empty())
+  {
+    throw std::invalid_argument{"No particle counts to time."};
+  }
+  if (std::ranges::find(settings.particleCounts, size_t{0U}) != settings.particleCounts.end())
+  {
+    throw std::invalid_argument{"No particles to time in a count of 0."};
+  }
+  if (settings.threadCounts.empty())
+  {
+    throw std::invalid_argument{"No thread counts to time."};
+  }
+  return command;
+}
+
+auto WriteSceneBench(std::ostream& out,
+                     const SceneBenchCommand& command,
+                     const std::vector<SceneBenchResult>& results) -> void
+{
+  static constexpr auto TABLE_PRECISION = 3;
+  static constexpr auto DATA_PRECISION  = 6;
+
+  out.setf(std::ios::fixed, std::ios::floatfield);
+  switch (command.format)
+  {
+    case SceneBenchFormat::TABLE:
+      out.precision(TABLE_PRECISION);
+      WriteSceneBenchTable(out, results);
+      break;
+    case SceneBenchFormat::CSV:
+      out.precision(DATA_PRECISION);
+      WriteSceneBenchCsv(out, results);
+      break;
+    case SceneBenchFormat::JSON:
+      out.precision(DATA_PRECISION);
+      WriteSceneBenchJson(out, command.settings, results);
+      break;
+  }
+}
+
+auto RunSceneBenchCommand(const std::span<const char* const> options,
+                          const SceneBenchSettings& defaults) -> int
+{
+  auto command = SceneBenchCommand{};
+  try
+  {
+    command = ParseSceneBenchCommand(options, defaults);
+  }
+  catch (const std::invalid_argument& error)
+  {
+    std::cerr << error.what() << "\n";
+    PrintSceneBenchUsage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    if (not PinToCpus(command.settings.cpus))
+    {
+      throw std::runtime_error("Could not pin to the CPUs.");
+    }
+
+    const auto results = RunSceneBench(command.settings);
+    if (command.outputFilename.empty())
+    {
+      WriteSceneBench(std::cout, command, results);
+      return EXIT_SUCCESS;
+    }
+
+    auto file = std::ofstream{command.outputFilename};
+    WriteSceneBench(file, command, results);
+    file.close();
+    if (not file)
+    {
+      throw std::runtime_error("Could not write '" + command.outputFilename + "'.");
+    }
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cerr << error.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// A comparison that main runs by its name, see 'RunComparisons'.
+struct Comparison
+{
+  std::string_view name;
+  std::function<void()> run;
+};
+
+auto PrintComparisonsUsage(std::ostream& out, const std::span<const Comparison> comparisons)
+    -> void
+{
+  out << "usage: cpuTest --compare all|<name,...>\n"
+         "  names:";
+  for (const auto& comparison : comparisons)
+  {
+    out << " " << comparison.name;
+  }
+  out << "\n";
+}
+
+// Runs the comparisons 'list' names, in its order, or all of them for "all". Every name is
+// checked before any runs.
+auto RunComparisons(const std::span<const Comparison> comparisons, const std::string_view list)
+    -> int
+{
+  auto selected = std::vector<const Comparison*>{};
+  if ("all" == list)
+  {
+    for (const auto& comparison : comparisons)
+    {
+      selected.push_back(&comparison);
+    }
+  }
+  else
+  {
+    for (const auto& name : SplitList(list))
+    {
+      const auto comparison = std::ranges::find(comparisons, name, &Comparison::name);
+      if (comparisons.end() == comparison)
+      {
+        std::cerr << "No comparison named '" << name << "'.\n";
+        PrintComparisonsUsage(std::cerr, comparisons);
+        return EXIT_FAILURE;
+      }
+      selected.push_back(&*comparison);
+    }
+  }
+
+  std::cout.setf(std::ios::fixed, std::ios::floatfield);
+  std::cout.precision(3);
+  std::wcout << std::fixed;
+  for (const auto* const comparison : selected)
+  {
+    comparison->run();
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(
+const int argc, const char* const argv[])
+{
+  static constexpr auto DELTA_TIME          = 1.0 / 60.0; // 60 fps
+  static constexpr auto FRAME_COUNT         = 200U;
+  static constexpr auto WARM_UP_FRAME_COUNT = 60U;
+  static const std::vector<std::string> s_EFFECTS_NAME{"tunnel", "attractors", "fountain"};
+
+  const auto benchSettings = SceneBenchSettings{
+      .effectNames      = s_EFFECTS_NAME,
+      .particleCounts   = {10000U, 100000U, 300000U},
+      .threadCounts     = {1U},
+      .frameCount       = FRAME_COUNT,
+      .warmUpFrameCount = WARM_UP_FRAME_COUNT,
+      .dt               = DELTA_TIME,
+      .randomSeed       = PARTICLES::Random::DEFAULT_SEED,
+      .cpus             = {},
+  };
+
+  // Plays a trace instead of the scene benchmark: cpuTest --replay <trace file>
+  const auto arguments = std::span{argv, static_cast<size_t>(argc)};
+  if ((3U == arguments.size()) and (std::string_view{arguments[1]} == "--replay"))
+  {
+    return ReplayTrace(arguments[2]);
+  }
+  // Checks the faster backends against the plain ones instead: cpuTest --verify
+  if ((2U == arguments.size()) and (std::string_view{arguments[1]} == "--verify"))
+  {
+    static constexpr auto VERIFY_NUM_PARTICLES       = 100000U;
+    static constexpr auto VERIFY_NUM_COLLIDER_POINTS = 400000U;
+    static constexpr auto VERIFY_PREWARM_TIME        = 8.0;
+    std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    std::cout.precision(6);
+    // Run in order, and all run even when one fails.
+    const auto verified = std::array{
+        VerifyBackends(VERIFY_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME),
+        VerifyLod(VERIFY_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME),
+        VerifyIntegrators(DELTA_TIME),
+        VerifyExtrapolation(VERIFY_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME),
+        VerifyEmissionRate(DELTA_TIME),
+        VerifyTimeUpdates(VERIFY_NUM_PARTICLES, DELTA_TIME),
+        VerifyVectorField(VERIFY_NUM_PARTICLES),
+        VerifyColliders(VERIFY_NUM_COLLIDER_POINTS),
+        VerifyDepthSorting(VERIFY_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME),
+        VerifyPrewarm(VERIFY_NUM_PARTICLES, VERIFY_PREWARM_TIME, DELTA_TIME),
+    };
+    return std::ranges::all_of(verified, std::identity{}) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  // Just the scene benchmark, as the options say: cpuTest --bench [options]
+  if ((arguments.size() >= 2U) and (std::string_view{arguments[1]} == "--bench"))
+  {
+    return RunSceneBenchCommand(arguments.subspan(2U), benchSettings);
+  }
+
+  // The comparisons, by name, instead: cpuTest --compare <name,...>, or cpuTest --compare all
+  static constexpr auto STAGGER_NUM_PARTICLES              = 200000U;
+  static constexpr auto CULLING_NUM_PARTICLES              = 200000U;
+  static constexpr auto LOD_NUM_PARTICLES                  = 200000U;
+  static constexpr auto FLOCKING_NUM_PARTICLES             = 250000U;
+  static constexpr auto ATTRACTOR_NUM_PARTICLES            = 100000U;
+  static constexpr auto COLLIDER_NUM_PARTICLES             = 300000U;
+  static constexpr auto REORDER_NUM_PARTICLES              = 300000U;
+  static constexpr auto STATS_NUM_PARTICLES                = 300000U;
+  static constexpr auto GRAVITY_ONLY_NUM_PARTICLES         = 300000U;
+  static constexpr auto VERTEX_NUM_PARTICLES               = 300000U;
+  static constexpr auto DEPTH_SORT_NUM_PARTICLES           = 300000U;
+  static constexpr auto CULLING_PER_PARTICLE_NUM_PARTICLES = 300000U;
+  static constexpr auto SNAPSHOT_NUM_PARTICLES             = 300000U;
+  static constexpr auto SNAPSHOT_WARM_UP_TIME              = 5.0;
+  static constexpr auto RECORDING_NUM_PARTICLES            = 300000U;
+  static constexpr auto TRACE_NUM_PARTICLES                = 300000U;
+  const auto comparisons = std::array{
+      Comparison{.name = "stagger",
+                 .run  = []()
+                 {
+                   CompareStaggeredColorUpdates(
+                       s_EFFECTS_NAME, STAGGER_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "culling",
+                 .run  = []()
+                 {
+                   CompareCulledEffects(
+                       s_EFFECTS_NAME, CULLING_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "lod",
+                 .run  = []()
+                 {
+                   CompareTunnelLod(LOD_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "flocking",
+                 .run  = []()
+                 {
+                   CompareFlockingScaling(FLOCKING_NUM_PARTICLES);
+                 }},
+      Comparison{.name = "attractors",
+                 .run  = []()
+                 {
+                   CompareAttractorEvaluations(ATTRACTOR_NUM_PARTICLES);
+                 }},
+      Comparison{.name = "colliders",
+                 .run  = []()
+                 {
+                   CompareColliderCounts(COLLIDER_NUM_PARTICLES);
+                 }},
+      Comparison{.name = "reorder",
+                 .run  = []()
+                 {
+                   CompareSpatialReordering(REORDER_NUM_PARTICLES);
+                 }},
+      Comparison{.name = "stats",
+                 .run  = []()
+                 {
+                   CompareStatsGathering(STATS_NUM_PARTICLES);
+                 }},
+      Comparison{.name = "gravity-only",
+                 .run  = []()
+                 {
+                   CompareGravityOnlyFountain(GRAVITY_ONLY_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "vertex",
+                 .run  = []()
+                 {
+                   CompareVertexWriting(
+                       s_EFFECTS_NAME, VERTEX_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "depth-sort",
+                 .run  = []()
+                 {
+                   CompareDepthSorting(
+                       s_EFFECTS_NAME, DEPTH_SORT_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "particle-culling",
+                 .run  = []()
+                 {
+                   CompareParticleCulling(
+                       CULLING_PER_PARTICLE_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "snapshot",
+                 .run  = []()
+                 {
+                   CompareSnapshotPrewarm(
+                       s_EFFECTS_NAME, SNAPSHOT_NUM_PARTICLES, SNAPSHOT_WARM_UP_TIME, DELTA_TIME);
+                 }},
+      Comparison{.name = "recording",
+                 .run  = []()
+                 {
+                   CompareFrameRecording(
+                       s_EFFECTS_NAME, RECORDING_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+      Comparison{.name = "trace",
+                 .run  = []()
+                 {
+                   CompareTraceReplay(s_EFFECTS_NAME, TRACE_NUM_PARTICLES, FRAME_COUNT, DELTA_TIME);
+                 }},
+  };
+  if ((3U == arguments.size()) and (std::string_view{arguments[1]} == "--compare"))
+  {
+    return RunComparisons(comparisons, arguments[2]);
+  }
+
+  std::cout.setf(std::ios::fixed, std::ios::floatfield);
+  std::cout.precision(3);
+  std::wcout << std::fixed;
+
+  WriteSceneBenchTable(std::cout, RunSceneBench(benchSettings));
 
   return 0;
 }
@@ -19,6 +19,7 @@ using GENERATORS::BoxPositionGenerator;
 using UPDATERS::BasicTimeUpdater;
 using UPDATERS::EulerUpdater;
 using UPDATERS::FloorUpdater;
+using UPDATERS::StaggerSchedule;
 using UPDATERS::VelocityColorUpdater;
 
 FountainEffect::FountainEffect(const size_t numParticles) noexcept
@@ -66,8 +67,9 @@ FountainEffect::FountainEffect(const size_t numParticles) noexcept
   //const auto colorUpdater = std::make_shared<BasicColorUpdater>();
   static constexpr auto MIN_VELOCITY = glm::vec4{-0.5F, -0.5F, -0.5F, 0.0F};
   static constexpr auto MAX_VELOCITY = glm::vec4{+2.0F, +2.0F, +2.0F, 2.0F};
-  const auto colorUpdater = std::make_shared<VelocityColorUpdater>(MIN_VELOCITY, MAX_VELOCITY);
-  m_system.AddUpdater(colorUpdater);
+  m_colorUpdater          = std::make_shared<VelocityColorUpdater>(MIN_VELOCITY, MAX_VELOCITY);
+  m_scheduledColorUpdater = m_colorUpdater;
+  m_system.AddUpdater(m_scheduledColorUpdater);
 
   static constexpr auto GRAVITY            = -25.0F;
   static constexpr auto EULER_ACCELERATION = glm::vec4{0.0F, GRAVITY, 0.0F, 0.0F};
@@ -76,19 +78,25 @@ FountainEffect::FountainEffect(const size_t numParticles) noexcept
 
   static constexpr auto BOUNCE_FACTOR = 0.5F;
   m_floorUpdater                      = std::make_shared<FloorUpdater>(FLOOR_Y, BOUNCE_FACTOR);
+  static constexpr auto SLEEP_SPEED   = 0.05F;
+  m_floorUpdater->SetSleepSpeed(SLEEP_SPEED);
   m_system.AddUpdater(m_floorUpdater);
 }
 
+auto FountainEffect::SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void
+{
+  ScheduleUpdater(m_colorUpdater, schedule, m_scheduledColorUpdater);
+}
+
 auto FountainEffect::UpdateEffect(const double dt) noexcept -> void
 {
-  static auto s_lifetime = 0.0F;
-  s_lifetime += static_cast<float>(dt);
+  m_lifetime += static_cast<float>(dt);
 
   static constexpr auto LIFETIME_FACTOR = 2.5F;
   static constexpr auto POS_FACTOR      = 0.1F;
-  m_positionGenerator->SetPosition({POS_FACTOR * std::sin(s_lifetime * LIFETIME_FACTOR),
+  m_positionGenerator->SetPosition({POS_FACTOR * std::sin(m_lifetime * LIFETIME_FACTOR),
                                     FLOOR_Y,
-                                    POS_FACTOR * std::cos(s_lifetime * LIFETIME_FACTOR),
+                                    POS_FACTOR * std::cos(m_lifetime * LIFETIME_FACTOR),
                                     0.0F});
 }
 
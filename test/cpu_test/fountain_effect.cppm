@@ -6,6 +6,7 @@ module;
 export module CpuTest.Particles.FountainEffect;
 
 import Particles.Effect;
+import Particles.Frustum;
 import Particles.ParticleGenerators;
 import Particles.ParticleUpdaters;
 import Particles.Particles;
@@ -14,6 +15,8 @@ using PARTICLES::GENERATORS::BasicColorGenerator;
 using PARTICLES::GENERATORS::BoxPositionGenerator;
 using PARTICLES::UPDATERS::EulerUpdater;
 using PARTICLES::UPDATERS::FloorUpdater;
+using PARTICLES::UPDATERS::StaggerSchedule;
+using PARTICLES::UPDATERS::VelocityColorUpdater;
 
 export namespace PARTICLES::EFFECTS
 {
@@ -29,18 +32,27 @@ public:
   auto SetTintMixAmount([[maybe_unused]] const float mixAmount) noexcept -> void override;
   auto SetMaxNumAliveParticles([[maybe_unused]] const size_t maxNumAliveParticles) noexcept
       -> void override;
+  auto SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void override;
 
   auto Update(double dt) noexcept -> void override;
+  auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool override;
 
   [[nodiscard]] auto GetSystem() const noexcept -> const ParticleSystem& override;
 
+protected:
+  [[nodiscard]] auto GetMutableSystem() noexcept -> ParticleSystem& override;
+  auto SetEffectTime(double time) noexcept -> void override;
+
 private:
   ParticleSystem m_system;
   std::shared_ptr<BoxPositionGenerator> m_positionGenerator;
   std::shared_ptr<BasicColorGenerator> m_colorGenerator;
+  std::shared_ptr<VelocityColorUpdater> m_colorUpdater;
+  std::shared_ptr<IParticleUpdater> m_scheduledColorUpdater;
   std::shared_ptr<EulerUpdater> m_eulerUpdater;
   std::shared_ptr<FloorUpdater> m_floorUpdater;
   static constexpr auto FLOOR_Y = -0.25F;
+  float m_lifetime = 0.0F;
 
   auto UpdateEffect(double dt) noexcept -> void;
 };
@@ -76,9 +88,24 @@ inline auto FountainEffect::Update(const double dt) noexcept -> void
   m_system.Update(dt);
 }
 
+inline auto FountainEffect::UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool
+{
+  return m_system.UpdateVisibility(viewFrustum);
+}
+
 inline auto FountainEffect::GetSystem() const noexcept -> const ParticleSystem&
 {
   return m_system;
 }
 
+inline auto FountainEffect::GetMutableSystem() noexcept -> ParticleSystem&
+{
+  return m_system;
+}
+
+inline auto FountainEffect::SetEffectTime(const double time) noexcept -> void
+{
+  m_lifetime = static_cast<float>(time);
+}
+
 } // namespace PARTICLES::EFFECTS
@@ -3,6 +3,7 @@ module;
 #include <cmath>
 #include <glm/vec4.hpp>
 #include <memory>
+#include <optional>
 
 module CpuTest.Particles.TunnelEffect;
 
@@ -19,6 +20,7 @@ using GENERATORS::RoundPositionGenerator;
 using UPDATERS::BasicTimeUpdater;
 using UPDATERS::EulerUpdater;
 using UPDATERS::PositionColorUpdater;
+using UPDATERS::StaggerSchedule;
 
 TunnelEffect::TunnelEffect(const size_t numParticles) noexcept
   : m_system{0 == numParticles ? 10000 : numParticles}
@@ -67,35 +69,53 @@ TunnelEffect::TunnelEffect(const size_t numParticles) noexcept
   //const auto colorUpdater = std::make_shared<BasicColorUpdater>();
   static constexpr auto MIN_COLOR_POSITION = glm::vec4{-0.5F, -0.5F, -0.5F, 0.0F};
   static constexpr auto MAX_COLOR_POSITION = glm::vec4{+2.0F, +3.0F, +3.0F, 2.0F};
-  const auto colorUpdater =
+  m_colorUpdater =
       std::make_shared<PositionColorUpdater>(MIN_COLOR_POSITION, MAX_COLOR_POSITION);
-  m_system.AddUpdater(colorUpdater);
+  m_scheduledColorUpdater = m_colorUpdater;
+  m_system.AddUpdater(m_scheduledColorUpdater);
 
   static constexpr auto EULER_ACCELERATION = glm::vec4{0.0F, 0.0F, 0.0F, 0.0F};
   const auto eulerUpdater                  = std::make_shared<EulerUpdater>(EULER_ACCELERATION);
   m_system.AddUpdater(eulerUpdater);
 }
 
+auto TunnelEffect::EnableLod() noexcept -> void
+{
+  // The particles stream away from the emitter ring towards the far plane, so the further
+  // along they are, the less they need updating.
+  static constexpr auto VIEW_POSITION = glm::vec4{0.0F, 0.0F, 0.0F, 1.0F};
+  static constexpr auto LOD_SETTINGS  = LodSettings{
+       .tierDistances = {0.3F, 0.6F},
+       .updatePeriods = {1U, 2U, 4U},
+  };
+  m_system.SetLodSettings(LOD_SETTINGS);
+  m_system.SetLodView(VIEW_POSITION, std::nullopt);
+}
+
+auto TunnelEffect::SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void
+{
+  ScheduleUpdater(m_colorUpdater, schedule, m_scheduledColorUpdater);
+}
+
 auto TunnelEffect::UpdateEffect(const double dt) noexcept -> void
 {
-  static auto s_lifetime = 0.0F;
-  s_lifetime += static_cast<float>(dt);
+  m_lifetime += static_cast<float>(dt);
 
   static constexpr auto LIFETIME_FACTOR = 2.5F;
   static constexpr auto CENTRE_FACTOR   = 0.1F;
-  const auto centre = glm::vec4{CENTRE_FACTOR * std::sin(s_lifetime * LIFETIME_FACTOR),
-                                CENTRE_FACTOR * std::cos(s_lifetime * LIFETIME_FACTOR),
+  const auto centre = glm::vec4{CENTRE_FACTOR * std::sin(m_lifetime * LIFETIME_FACTOR),
+                                CENTRE_FACTOR * std::cos(m_lifetime * LIFETIME_FACTOR),
                                 0.0F,
                                 0.0F};
 
   static constexpr auto MIN_RADIUS          = 0.15F;
   static constexpr auto RADIUS_FACTOR       = 0.05F;
   static constexpr auto Y_RADIUS_COS_FACTOR = 0.5F;
-  const auto xRadius                        = MIN_RADIUS + (RADIUS_FACTOR * std::sin(s_lifetime));
+  const auto xRadius                        = MIN_RADIUS + (RADIUS_FACTOR * std::sin(m_lifetime));
   //      0.15F + (0.01F * std::sin(time)),
   const auto yRadius =
       MIN_RADIUS +
-      (RADIUS_FACTOR * (std::sin(s_lifetime) * std::cos(s_lifetime * Y_RADIUS_COS_FACTOR)));
+      (RADIUS_FACTOR * (std::sin(m_lifetime) * std::cos(m_lifetime * Y_RADIUS_COS_FACTOR)));
   //      0.15F + (0.01F * std::cos(time)));
 
   m_positionGenerator->SetCentreAndRadius(centre, xRadius, yRadius);
@@ -6,12 +6,15 @@ module;
 export module CpuTest.Particles.TunnelEffect;
 
 import Particles.Effect;
+import Particles.Frustum;
 import Particles.ParticleGenerators;
 import Particles.ParticleUpdaters;
 import Particles.Particles;
 
 using PARTICLES::GENERATORS::BasicColorGenerator;
 using PARTICLES::GENERATORS::RoundPositionGenerator;
+using PARTICLES::UPDATERS::PositionColorUpdater;
+using PARTICLES::UPDATERS::StaggerSchedule;
 
 export namespace PARTICLES::EFFECTS
 {
@@ -27,15 +30,26 @@ public:
   auto SetTintMixAmount([[maybe_unused]] const float mixAmount) noexcept -> void override;
   auto SetMaxNumAliveParticles([[maybe_unused]] const size_t maxNumAliveParticles) noexcept
       -> void override;
+  auto SetColorUpdateSchedule(const StaggerSchedule& schedule) noexcept -> void override;
+  // The particles further down the tunnel are updated less often.
+  auto EnableLod() noexcept -> void;
 
   auto Update(double dt) noexcept -> void override;
+  auto UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool override;
 
   [[nodiscard]] auto GetSystem() const noexcept -> const ParticleSystem& override;
 
+protected:
+  [[nodiscard]] auto GetMutableSystem() noexcept -> ParticleSystem& override;
+  auto SetEffectTime(double time) noexcept -> void override;
+
 private:
   ParticleSystem m_system;
   std::shared_ptr<RoundPositionGenerator> m_positionGenerator;
   std::shared_ptr<BasicColorGenerator> m_colorGenerator;
+  std::shared_ptr<PositionColorUpdater> m_colorUpdater;
+  std::shared_ptr<IParticleUpdater> m_scheduledColorUpdater;
+  float m_lifetime = 0.0F;
 
   auto UpdateEffect(double dt) noexcept -> void;
 };
@@ -69,9 +83,24 @@ inline auto TunnelEffect::Update(const double dt) noexcept -> void
   m_system.Update(dt);
 }
 
+inline auto TunnelEffect::UpdateVisibility(const Frustum& viewFrustum) noexcept -> bool
+{
+  return m_system.UpdateVisibility(viewFrustum);
+}
+
 inline auto TunnelEffect::GetSystem() const noexcept -> const ParticleSystem&
 {
   return m_system;
 }
 
+inline auto TunnelEffect::GetMutableSystem() noexcept -> ParticleSystem&
+{
+  return m_system;
+}
+
+inline auto TunnelEffect::SetEffectTime(const double time) noexcept -> void
+{
+  m_lifetime = static_cast<float>(time);
+}
+
 } // namespace PARTICLES::EFFECTS
@@ -0,0 +1,449 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+import Particles.Colliders;
+import Particles.DistanceField;
+import Particles.ParticleGenerators;
+import Particles.ParticleUpdaters;
+import Particles.Particles;
+import Particles.Random;
+import Particles.VectorGrid;
+import BenchUtils;
+
+using BENCH_UTILS::GetPercentile;
+using BENCH_UTILS::PrintTableHeader;
+using PARTICLES::ColliderSet;
+using PARTICLES::DistanceFieldSettings;
+using PARTICLES::IParticleGenerator;
+using PARTICLES::IParticleUpdater;
+using PARTICLES::ParticleData;
+using PARTICLES::Random;
+using PARTICLES::VectorGrid;
+using PARTICLES::GENERATORS::BasicColorGenerator;
+using PARTICLES::GENERATORS::BasicTimeGenerator;
+using PARTICLES::GENERATORS::BasicVelocityGenerator;
+using PARTICLES::GENERATORS::BoxPositionGenerator;
+using PARTICLES::GENERATORS::RoundPositionGenerator;
+using PARTICLES::GENERATORS::SphereVelocityGenerator;
+using PARTICLES::GENERATORS::VelocityFromPositionGenerator;
+using PARTICLES::UPDATERS::AttractorEvaluation;
+using PARTICLES::UPDATERS::AttractorUpdater;
+using PARTICLES::UPDATERS::BasicColorUpdater;
+using PARTICLES::UPDATERS::BasicTimeUpdater;
+using PARTICLES::UPDATERS::ColliderUpdater;
+using PARTICLES::UPDATERS::DistanceFieldColliderUpdater;
+using PARTICLES::UPDATERS::EulerUpdater;
+using PARTICLES::UPDATERS::FloorUpdater;
+using PARTICLES::UPDATERS::FlockingSettings;
+using PARTICLES::UPDATERS::FlockingUpdater;
+using PARTICLES::UPDATERS::ForceSource;
+using PARTICLES::UPDATERS::PositionColorUpdater;
+using PARTICLES::UPDATERS::SemiImplicitEulerUpdater;
+using PARTICLES::UPDATERS::SpatialReorderUpdater;
+using PARTICLES::UPDATERS::VectorFieldMode;
+using PARTICLES::UPDATERS::VectorFieldUpdater;
+using PARTICLES::UPDATERS::VelocityColorUpdater;
+using PARTICLES::UPDATERS::VelocityVerletUpdater;
+
+// Times each generator and updater on its own, one thread, over particle counts from ones that
+// fit in the caches to ones that don't. The rest of a particle system is left out, so a change
+// to one stage shows up without the noise of the others.
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto DELTA_TIME      = 1.0 / 60.0;
+constexpr auto PARTICLE_COUNTS = std::array{1000U, 10000U, 100000U, 1000000U, 10000000U};
+
+// Each sample runs a stage over at least this many particles, so that at the small counts a
+// sample is well above the clock's resolution.
+constexpr auto MIN_PARTICLES_PER_SAMPLE = size_t{1000000U};
+constexpr auto NUM_WARM_UP_SAMPLES      = 2U;
+// After the minimum, samples are taken until the time is used up, or there are the maximum.
+constexpr auto MIN_NUM_SAMPLES   = 5U;
+constexpr auto MAX_NUM_SAMPLES   = 51U;
+constexpr auto SAMPLE_TIME       = std::chrono::milliseconds{500};
+constexpr auto MEDIAN            = 0.5;
+constexpr auto HIGH_PERCENTILE   = 0.95;
+constexpr auto STREAM_VALUE_SIZE = sizeof(glm::vec4);
+
+using RunStage = std::function<void(ParticleData& particleData)>;
+
+struct Stage
+{
+  std::string name;
+  // The particle stream values the stage reads and writes for each particle, counting each
+  // once, for the bandwidth. Anything else it touches, like a grid or its own buffers, is left
+  // out, so the bandwidth is a lower bound.
+  uint32_t numStreamAccesses;
+  RunStage run;
+};
+
+[[nodiscard]] auto MakeGeneratorStage(const std::string& name,
+                                      const uint32_t numStreamAccesses,
+                                      std::shared_ptr<IParticleGenerator> generator) -> Stage
+{
+  return {.name              = name,
+          .numStreamAccesses = numStreamAccesses,
+          .run               = [generator = std::move(generator)](ParticleData& particleData)
+          {
+            generator->Generate(
+                DELTA_TIME, particleData, {.start = 0U, .end = particleData.GetAliveCount()});
+          }};
+}
+
+[[nodiscard]] auto MakeUpdaterStage(const std::string& name,
+                                    const uint32_t numStreamAccesses,
+                                    std::shared_ptr<IParticleUpdater> updater) -> Stage
+{
+  return {.name              = name,
+          .numStreamAccesses = numStreamAccesses,
+          .run               = [updater = std::move(updater)](ParticleData& particleData)
+          { updater->Update(DELTA_TIME, particleData); }};
+}
+
+[[nodiscard]] auto MakeGeneratorStages() -> std::vector<Stage>
+{
+  static constexpr auto POSITION        = glm::vec4{0.0F};
+  static constexpr auto POSITION_OFFSET = glm::vec4{1.0F, 1.0F, 1.0F, 0.0F};
+  static constexpr auto RADIUS          = 1.0;
+  static constexpr auto MIN_COLOR       = glm::vec4{0.0F};
+  static constexpr auto MAX_COLOR       = glm::vec4{1.0F};
+  static constexpr auto MIN_VELOCITY    = glm::vec4{-0.5F, -0.5F, -0.5F, 0.0F};
+  static constexpr auto MAX_VELOCITY    = glm::vec4{+0.5F, +0.5F, +0.5F, 0.0F};
+  static constexpr auto MIN_SPEED       = 0.1F;
+  static constexpr auto MAX_SPEED       = 1.0F;
+  static constexpr auto MIN_LIFETIME    = 1.0F;
+  static constexpr auto MAX_LIFETIME    = 2.0F;
+
+  auto stages = std::vector<Stage>{};
+  stages.emplace_back(
+      MakeGeneratorStage("BoxPositionGenerator",
+                         1U,
+                         std::make_shared<BoxPositionGenerator>(POSITION, POSITION_OFFSET)));
+  stages.emplace_back(
+      MakeGeneratorStage("RoundPositionGenerator",
+                         1U,
+                         std::make_shared<RoundPositionGenerator>(POSITION, RADIUS, RADIUS)));
+  stages.emplace_back(MakeGeneratorStage(
+      "BasicColorGenerator",
+      2U,
+      std::make_shared<BasicColorGenerator>(MIN_COLOR, MAX_COLOR, MIN_COLOR, MAX_COLOR)));
+  stages.emplace_back(
+      MakeGeneratorStage("BasicVelocityGenerator",
+                         1U,
+                         std::make_shared<BasicVelocityGenerator>(MIN_VELOCITY, MAX_VELOCITY)));
+  stages.emplace_back(
+      MakeGeneratorStage("SphereVelocityGenerator",
+                         2U,
+                         std::make_shared<SphereVelocityGenerator>(MIN_SPEED, MAX_SPEED)));
+  stages.emplace_back(MakeGeneratorStage(
+      "VelocityFromPositionGenerator",
+      2U,
+      std::make_shared<VelocityFromPositionGenerator>(POSITION, MIN_SPEED, MAX_SPEED)));
+  stages.emplace_back(
+      MakeGeneratorStage("BasicTimeGenerator",
+                         1U,
+                         std::make_shared<BasicTimeGenerator>(MIN_LIFETIME, MAX_LIFETIME)));
+
+  return stages;
+}
+
+[[nodiscard]] auto MakeAttractors(const uint32_t numAttractors,
+                                  const AttractorEvaluation evaluation)
+    -> std::shared_ptr<AttractorUpdater>
+{
+  static constexpr auto ATTRACTOR_FORCE = 0.01F;
+
+  auto random     = Random{};
+  auto attractors = std::make_shared<AttractorUpdater>();
+  for (auto i = 0U; i < numAttractors; ++i)
+  {
+    auto position = random.Uniform(glm::vec4{-1.0F}, glm::vec4{1.0F});
+    position.w    = ATTRACTOR_FORCE; // NOLINT(cppcoreguidelines-pro-type-union-access)
+    attractors->AddAttractorPosition(position);
+  }
+  attractors->SetEvaluation(evaluation);
+  return attractors;
+}
+
+[[nodiscard]] auto MakeColliders() -> std::shared_ptr<const ColliderSet>
+{
+  static constexpr auto FLOOR_Y       = -1.0F;
+  static constexpr auto NUM_SPHERES   = 16U;
+  static constexpr auto SPHERE_RADIUS = 0.1F;
+
+  auto random    = Random{};
+  auto colliders = std::make_shared<ColliderSet>();
+  colliders->AddPlane({.point  = glm::vec4{0.0F, FLOOR_Y, 0.0F, 0.0F},
+                       .normal = glm::vec4{0.0F, 1.0F, 0.0F, 0.0F}});
+  for (auto i = 0U; i < NUM_SPHERES; ++i)
+  {
+    colliders->AddSphere(
+        {.centre = random.Uniform(glm::vec4{-1.0F}, glm::vec4{1.0F}), .radius = SPHERE_RADIUS});
+  }
+  return colliders;
+}
+
+[[nodiscard]] auto MakeUpdaterStages() -> std::vector<Stage>
+{
+  static constexpr auto GRAVITY              = glm::vec4{0.0F, -1.0F, 0.0F, 0.0F};
+  static constexpr auto FLOOR_Y              = -1.0F;
+  static constexpr auto BOUNCE_FACTOR        = 0.5F;
+  static constexpr auto FRICTION             = 0.1F;
+  static constexpr auto NUM_ATTRACTORS       = 4U;
+  static constexpr auto NUM_MANY_ATTRACTORS  = 128U;
+  static constexpr auto FIELD_RESOLUTION     = 64U;
+  static constexpr auto FIELD_FREQUENCY      = 2.0F;
+  static constexpr auto SPHERE_RADIUS        = 0.5F;
+  static constexpr auto MIN_COLOR_VALUE      = glm::vec4{-1.0F};
+  static constexpr auto MAX_COLOR_VALUE      = glm::vec4{+1.0F};
+  static constexpr auto NUM_PARTICLE_STREAMS = ParticleData::NUM_STREAMS;
+
+  const auto field = std::make_shared<const VectorGrid>(
+      PARTICLES::MakeCurlNoiseGrid(glm::vec4{-1.0F},
+                                   glm::vec4{+1.0F},
+                                   FIELD_RESOLUTION,
+                                   {.frequency = FIELD_FREQUENCY}));
+  const auto distanceField = std::make_shared<const VectorGrid>(PARTICLES::MakeDistanceField(
+      DistanceFieldSettings{.boundsMin     = glm::vec4{-1.0F},
+                            .boundsMax     = glm::vec4{+1.0F},
+                            .resolution    = FIELD_RESOLUTION,
+                            .cacheFilename = "",
+                            .shapeVersion  = 0U},
+      [](const glm::vec4& position) { return glm::length(glm::vec3{position}) - SPHERE_RADIUS; },
+      nullptr));
+
+  auto stages = std::vector<Stage>{};
+  // Euler makes a pass each for the accelerations, velocities and positions.
+  stages.emplace_back(
+      MakeUpdaterStage("EulerUpdater", 8U, std::make_shared<EulerUpdater>(GRAVITY)));
+  stages.emplace_back(MakeUpdaterStage(
+      "SemiImplicitEulerUpdater", 5U, std::make_shared<SemiImplicitEulerUpdater>(GRAVITY)));
+  stages.emplace_back(MakeUpdaterStage(
+      "VelocityVerletUpdater", 5U, std::make_shared<VelocityVerletUpdater>(GRAVITY)));
+  auto gravityOnlyVerlet = std::make_shared<VelocityVerletUpdater>(GRAVITY);
+  gravityOnlyVerlet->SetForceSource(ForceSource::GLOBAL_ONLY);
+  stages.emplace_back(
+      MakeUpdaterStage("VelocityVerletUpdater, gravity only", 4U, gravityOnlyVerlet));
+  stages.emplace_back(MakeUpdaterStage(
+      "FloorUpdater", 1U, std::make_shared<FloorUpdater>(FLOOR_Y, BOUNCE_FACTOR)));
+  stages.emplace_back(MakeUpdaterStage(
+      "ColliderUpdater",
+      1U,
+      std::make_shared<ColliderUpdater>(MakeColliders(), BOUNCE_FACTOR, FRICTION)));
+  stages.emplace_back(MakeUpdaterStage(
+      "DistanceFieldColliderUpdater",
+      1U,
+      std::make_shared<DistanceFieldColliderUpdater>(distanceField, BOUNCE_FACTOR, FRICTION)));
+  stages.emplace_back(MakeUpdaterStage(
+      "AttractorUpdater, " + std::to_string(NUM_ATTRACTORS) + " exact",
+      3U,
+      MakeAttractors(NUM_ATTRACTORS, AttractorEvaluation::EXACT)));
+  stages.emplace_back(MakeUpdaterStage(
+      "AttractorUpdater, " + std::to_string(NUM_MANY_ATTRACTORS) + " Barnes-Hut",
+      3U,
+      MakeAttractors(NUM_MANY_ATTRACTORS, AttractorEvaluation::BARNES_HUT)));
+  stages.emplace_back(MakeUpdaterStage(
+      "FlockingUpdater", 4U, std::make_shared<FlockingUpdater>(FlockingSettings{})));
+  // Sorts all the particles every update, moving every stream.
+  stages.emplace_back(MakeUpdaterStage("SpatialReorderUpdater",
+                                       1U + (2U * NUM_PARTICLE_STREAMS),
+                                       std::make_shared<SpatialReorderUpdater>(1U)));
+  stages.emplace_back(MakeUpdaterStage(
+      "VectorFieldUpdater",
+      3U,
+      std::make_shared<VectorFieldUpdater>(field, VectorFieldMode::FORCE, 1.0F)));
+  stages.emplace_back(
+      MakeUpdaterStage("BasicColorUpdater", 4U, std::make_shared<BasicColorUpdater>()));
+  stages.emplace_back(MakeUpdaterStage(
+      "PositionColorUpdater",
+      5U,
+      std::make_shared<PositionColorUpdater>(MIN_COLOR_VALUE, MAX_COLOR_VALUE)));
+  stages.emplace_back(MakeUpdaterStage(
+      "VelocityColorUpdater",
+      5U,
+      std::make_shared<VelocityColorUpdater>(MIN_COLOR_VALUE, MAX_COLOR_VALUE)));
+  stages.emplace_back(
+      MakeUpdaterStage("BasicTimeUpdater", 2U, std::make_shared<BasicTimeUpdater>()));
+
+  return stages;
+}
+
+// Every particle alive and awake, inside the bounds the stages are set up for and living long
+// enough that none die while being timed. Set again before each sample, so that the particles
+// a stage moves or ages don't change what the next sample, or the next stage, is timed on.
+auto SetStartState(ParticleData& particleData) noexcept -> void
+{
+  static constexpr auto LIFETIME     = 1.0e6F;
+  static constexpr auto MIN_POSITION = glm::vec4{-1.0F, -1.0F, -1.0F, 0.0F};
+  static constexpr auto MAX_POSITION = glm::vec4{+1.0F, +1.0F, +1.0F, 0.0F};
+  static constexpr auto MIN_VELOCITY = glm::vec4{-0.5F, -0.5F, -0.5F, 0.0F};
+  static constexpr auto MAX_VELOCITY = glm::vec4{+0.5F, +0.5F, +0.5F, 0.0F};
+  static constexpr auto MIN_COLOR    = glm::vec4{0.0F};
+  static constexpr auto MAX_COLOR    = glm::vec4{1.0F};
+
+  while (particleData.GetAliveCount() < particleData.GetCount())
+  {
+    particleData.Wake(particleData.GetAliveCount());
+  }
+
+  auto random = Random{};
+  for (auto i = size_t{0U}; i < particleData.GetCount(); ++i)
+  {
+    particleData.SetPosition(i, random.Uniform(MIN_POSITION, MAX_POSITION));
+    particleData.SetVelocity(i, random.Uniform(MIN_VELOCITY, MAX_VELOCITY));
+    particleData.SetAcceleration(i, glm::vec4{0.0F});
+    particleData.SetStartColor(i, random.Uniform(MIN_COLOR, MAX_COLOR));
+    particleData.SetEndColor(i, random.Uniform(MIN_COLOR, MAX_COLOR));
+    particleData.SetColor(i, particleData.GetStartColor(i));
+    particleData.SetTime(i, {LIFETIME, LIFETIME, random.Uniform(0.0F, 1.0F), 1.0F / LIFETIME});
+  }
+}
+
+struct Timings // nanoseconds per particle
+{
+  double median;
+  double highPercentile;
+  double min;
+};
+
+[[nodiscard]] auto TimeStage(const Stage& stage, ParticleData& particleData) -> Timings
+{
+  const auto numParticles     = particleData.GetCount();
+  const auto numRunsPerSample = std::max(size_t{1U}, MIN_PARTICLES_PER_SAMPLE / numParticles);
+  const auto takeSample       = [&stage, &particleData, numParticles, numRunsPerSample]()
+  {
+    SetStartState(particleData);
+    const auto start = Clock::now();
+    for (auto run = size_t{0U}; run < numRunsPerSample; ++run)
+    {
+      stage.run(particleData);
+    }
+    const auto diff = Clock::now() - start;
+    return std::chrono::duration<double, std::nano>(diff).count() /
+           static_cast<double>(numRunsPerSample * numParticles);
+  };
+
+  for (auto sample = 0U; sample < NUM_WARM_UP_SAMPLES; ++sample)
+  {
+    static_cast<void>(takeSample());
+  }
+
+  auto samples   = std::vector<double>{};
+  const auto end = Clock::now() + SAMPLE_TIME;
+  while ((samples.size() < MIN_NUM_SAMPLES) or
+         ((samples.size() < MAX_NUM_SAMPLES) and (Clock::now() < end)))
+  {
+    samples.push_back(takeSample());
+  }
+
+  std::ranges::sort(samples);
+  return {.median         = GetPercentile(samples, MEDIAN),
+          .highPercentile = GetPercentile(samples, HIGH_PERCENTILE),
+          .min            = samples.front()};
+}
+
+auto RunBenchmarks(const size_t maxNumParticles, const std::string_view stageFilter) -> void
+{
+  auto stages = MakeGeneratorStages();
+  std::ranges::move(MakeUpdaterStages(), std::back_inserter(stages));
+  std::erase_if(stages,
+                [stageFilter](const Stage& stage)
+                { return not stage.name.contains(stageFilter); });
+
+  std::cout << "stage microbenchmarks, median of " << MIN_NUM_SAMPLES << " to " << MAX_NUM_SAMPLES
+            << " samples, bandwidth of the particle streams at the median\n";
+  PrintTableHeader(std::cout,
+                   {"particles",
+                    "stage",
+                    "median ns/particle",
+                    "p95 ns/particle",
+                    "min ns/particle",
+                    "GB/s"});
+
+  for (const auto numParticles : PARTICLE_COUNTS)
+  {
+    if (numParticles > maxNumParticles)
+    {
+      break;
+    }
+
+    auto particleData = ParticleData{numParticles};
+    for (const auto& stage : stages)
+    {
+      const auto timings = TimeStage(stage, particleData);
+      // Bytes per nanosecond are gigabytes per second.
+      const auto bandwidth =
+          static_cast<double>(stage.numStreamAccesses * STREAM_VALUE_SIZE) / timings.median;
+      std::cout << numParticles << " | " << stage.name << " | " << timings.median << " | "
+                << timings.highPercentile << " | " << timings.min << " | " << bandwidth << "\n";
+    }
+  }
+}
+
+} // namespace
+
+// microBench [--max-count <particles>] [--stage <part of a stage name>]
+int main(const int argc, const char* const argv[])
+{
+  static constexpr auto PRECISION = 3;
+
+  auto maxNumParticles = size_t{PARTICLE_COUNTS.back()};
+  auto stageFilter     = std::string_view{};
+
+  const auto arguments = std::span{argv, static_cast<size_t>(argc)};
+  try
+  {
+    for (auto i = size_t{1U}; i < arguments.size(); i += 2U)
+    {
+      const auto option = std::string_view{arguments[i]};
+      if ((i + 1U) == arguments.size())
+      {
+        throw std::invalid_argument{"No value for '" + std::string{option} + "'."};
+      }
+      if ("--max-count" == option)
+      {
+        maxNumParticles = std::stoul(arguments[i + 1U]);
+      }
+      else if ("--stage" == option)
+      {
+        stageFilter = arguments[i + 1U];
+      }
+      else
+      {
+        throw std::invalid_argument{"Unknown option '" + std::string{option} + "'."};
+      }
+    }
+  }
+  catch (const std::logic_error& error)
+  {
+    std::cerr << error.what() << "\n";
+    std::cerr << "usage: microBench [--max-count <particles>] [--stage <part of a stage name>]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout.setf(std::ios::fixed, std::ios::floatfield);
+  std::cout.precision(PRECISION);
+  RunBenchmarks(maxNumParticles, stageFilter);
+
+  return EXIT_SUCCESS;
+}